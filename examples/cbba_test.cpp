@@ -17,8 +17,8 @@ int main() {
     consens::cbba::Bid bid2("agent_2", 15.2, 1.0);
     consens::cbba::Bid bid3("agent_1", 10.5, 1.0);
 
-    spdlog::info("bid1: agent={}, score={}, ts={}", bid1.agent_id, bid1.score, bid1.timestamp);
-    spdlog::info("bid2: agent={}, score={}, ts={}", bid2.agent_id, bid2.score, bid2.timestamp);
+    spdlog::info("bid1: agent={}, score={}, ts={}", bid1.agent_id.name(), bid1.score, bid1.timestamp);
+    spdlog::info("bid2: agent={}, score={}, ts={}", bid2.agent_id.name(), bid2.score, bid2.timestamp);
     spdlog::info("bid1 > bid2: {}", bid1 > bid2);
     spdlog::info("bid2 > bid1: {}", bid2 > bid1);
     spdlog::info("bid1 == bid3: {}", bid1 == bid3);
@@ -121,7 +121,7 @@ int main() {
 
     // Check winning bids
     auto row1_bid = agent.get_winning_bid("row_1");
-    spdlog::info("\nWinning bid for row_1: agent={}, score={}", row1_bid.agent_id, row1_bid.score);
+    spdlog::info("\nWinning bid for row_1: agent={}, score={}", row1_bid.agent_id.name(), row1_bid.score);
 
     auto row1_winner = agent.get_winner("row_1");
     spdlog::info("Winner for row_1: {}", row1_winner);
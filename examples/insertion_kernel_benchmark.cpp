@@ -0,0 +1,88 @@
+#include <consens/cbba/insertion_kernel.hpp>
+#include <consens/task.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace consens;
+using namespace consens::cbba;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const char *level_name(SimdLevel level) {
+        switch (level) {
+        case SimdLevel::SCALAR:
+            return "scalar";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::AVX512:
+            return "avx512";
+        }
+        return "?";
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("%v");
+
+    size_t candidates = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+    size_t path_length = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+    const int rounds = 200;
+
+    spdlog::info("=== Insertion Kernel Benchmark ({} candidates x {} slots, best: {}) ===\n", candidates,
+                 path_length + 1, level_name(detect_simd_level()));
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(-200.0, 200.0);
+
+    // Path slots: consecutive points, the last one appends
+    std::vector<InsertionEdge> edges;
+    Point prev(0.0, 0.0);
+    for (size_t j = 0; j < path_length; j++) {
+        Point next(coord(rng), coord(rng));
+        edges.push_back(InsertionEdge{prev, next, 1.0, prev.distance_to(next) / 2.0});
+        prev = next;
+    }
+    edges.push_back(InsertionEdge{prev, prev, 0.0, 0.0});
+
+    // Mix of point tasks and rows
+    InsertionBatch batch;
+    for (size_t i = 0; i < candidates; i++) {
+        Point head(coord(rng), coord(rng));
+        std::string id = "bench_" + std::to_string(i);
+        if (i % 2 == 0) {
+            batch.add(static_cast<TaskIndex>(i), Task(id, head, Point(head.x, head.y + 50.0), 30.0));
+        } else {
+            batch.add(static_cast<TaskIndex>(i), Task(id, head, 10.0));
+        }
+    }
+
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (!simd_supported(level)) {
+            spdlog::info("{:<8} not supported on this CPU", level_name(level));
+            continue;
+        }
+
+        double checksum = 0.0;
+        auto start = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            compute_insertion_costs(edges, 2.0, batch, level);
+            checksum += batch.delay[static_cast<size_t>(r) % batch.delay.size()];
+        }
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+
+        spdlog::info("{:<8} {:10.2f} us per matrix | {:6.2f} ns per cell | checksum {:.6f}", level_name(level), us,
+                     us * 1000.0 / (edges.size() * batch.size()), checksum);
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <consens/cbba/spatial_index.hpp>
+#include <consens/task.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace consens;
+using namespace consens::cbba;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsed_ms(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /**
+     * Parallel crop rows (geometric tasks), 3 m apart, 200 m long
+     */
+    std::vector<Task> make_rows(size_t count) {
+        std::vector<Task> tasks;
+        tasks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            double x = static_cast<double>(i % 500) * 3.0;
+            double y = static_cast<double>(i / 500) * 210.0;
+            tasks.emplace_back("row_" + std::to_string(i), Point(x, y), Point(x, y + 200.0), 60.0);
+        }
+        return tasks;
+    }
+
+    /**
+     * Point tasks scattered uniformly over a square field
+     */
+    std::vector<Task> make_uniform(size_t count, std::mt19937 &rng) {
+        double side = std::sqrt(static_cast<double>(count)) * 15.0;
+        std::uniform_real_distribution<double> coord(0.0, side);
+
+        std::vector<Task> tasks;
+        tasks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            tasks.emplace_back("point_" + std::to_string(i), Point(coord(rng), coord(rng)), 10.0);
+        }
+        return tasks;
+    }
+
+    /**
+     * Point tasks in a few dense clusters (e.g. fruit trees around collection points)
+     */
+    std::vector<Task> make_clustered(size_t count, std::mt19937 &rng) {
+        std::uniform_real_distribution<double> centre(0.0, 2000.0);
+        std::normal_distribution<double> spread(0.0, 25.0);
+
+        std::vector<Point> centres;
+        for (int i = 0; i < 20; i++) {
+            centres.emplace_back(centre(rng), centre(rng));
+        }
+
+        std::vector<Task> tasks;
+        tasks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            const Point &c = centres[i % centres.size()];
+            tasks.emplace_back("cluster_" + std::to_string(i), Point(c.x + spread(rng), c.y + spread(rng)), 10.0);
+        }
+        return tasks;
+    }
+
+    const char *backend_name(SpatialIndexType type) {
+        switch (type) {
+        case SpatialIndexType::QUADRATIC:
+            return "quadratic";
+        case SpatialIndexType::LINEAR:
+            return "linear";
+        case SpatialIndexType::RSTAR:
+            return "rstar";
+        case SpatialIndexType::GRID:
+            return "grid";
+        }
+        return "?";
+    }
+
+    void run(const std::string &name, const std::vector<Task> &tasks, const SpatialIndexConfig &config,
+             const std::vector<Point> &queries) {
+        // One-by-one inserts
+        auto start = Clock::now();
+        SpatialIndex incremental(config);
+        for (const auto &task : tasks) {
+            incremental.insert(task);
+        }
+        double insert_ms = elapsed_ms(start);
+
+        // Batch insert (bulk-load for R-tree backends)
+        start = Clock::now();
+        SpatialIndex bulk(config);
+        bulk.insert(std::span<const Task>(tasks));
+        double bulk_ms = elapsed_ms(start);
+
+        // Radius queries (the bundle builder's candidate search)
+        std::vector<TaskIndex> found;
+        size_t hits = 0;
+        start = Clock::now();
+        for (const auto &q : queries) {
+            bulk.query_radius(q, 100.0, found);
+            hits += found.size();
+        }
+        double radius_us = elapsed_ms(start) * 1000.0 / queries.size();
+
+        // Nearest queries
+        start = Clock::now();
+        for (const auto &q : queries) {
+            hits += bulk.query_nearest(q, 10).size();
+        }
+        double nearest_us = elapsed_ms(start) * 1000.0 / queries.size();
+
+        spdlog::info("{:<10} {:<10} insert {:8.2f} ms | bulk {:8.2f} ms | radius {:8.2f} us | knn(10) {:8.2f} us "
+                     "| hits {}",
+                     name, backend_name(config.type), insert_ms, bulk_ms, radius_us, nearest_us, hits);
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("%v");
+
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    spdlog::info("=== Spatial Backend Benchmark ({} tasks) ===\n", count);
+
+    std::mt19937 rng(42);
+    std::vector<std::pair<std::string, std::vector<Task>>> scenarios;
+    scenarios.emplace_back("rows", make_rows(count));
+    scenarios.emplace_back("uniform", make_uniform(count, rng));
+    scenarios.emplace_back("clustered", make_clustered(count, rng));
+
+    for (const auto &[name, tasks] : scenarios) {
+        // Query points drawn around the tasks themselves
+        std::vector<Point> queries;
+        std::uniform_int_distribution<size_t> pick(0, tasks.size() - 1);
+        for (int i = 0; i < 1000; i++) {
+            queries.push_back(tasks[pick(rng)].get_position());
+        }
+
+        for (SpatialIndexType type : {SpatialIndexType::QUADRATIC, SpatialIndexType::LINEAR, SpatialIndexType::RSTAR,
+                                      SpatialIndexType::GRID}) {
+            SpatialIndexConfig config;
+            config.type = type;
+            config.grid_cell_size = 25.0;
+            run(name, tasks, config, queries);
+        }
+        spdlog::info("");
+    }
+
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include "types.hpp"
 
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace consens {
@@ -32,6 +33,17 @@ namespace consens {
          */
         virtual void add_task(const Task &task) = 0;
 
+        /**
+         * Add a batch of tasks to the world
+         * Default adds them one by one; algorithms with spatial indexes should override
+         * this to build the index in one pass
+         */
+        virtual void add_tasks(std::span<const Task> tasks) {
+            for (const Task &task : tasks) {
+                add_task(task);
+            }
+        }
+
         /**
          * Remove a task (completed or canceled)
          */
@@ -65,6 +77,29 @@ namespace consens {
          */
         virtual std::optional<TaskID> get_next_task() const = 0;
 
+        /**
+         * Get current path with the direction each task is driven in
+         * Default reports every task FORWARD; algorithms that pick directions should override
+         */
+        virtual std::vector<TaskStep> get_path_steps() const {
+            std::vector<TaskStep> steps;
+            for (TaskID &task : get_path()) {
+                steps.push_back(TaskStep{std::move(task), Direction::FORWARD});
+            }
+            return steps;
+        }
+
+        /**
+         * Get next task to execute, with the direction to drive it in
+         */
+        virtual std::optional<TaskStep> get_next_step() const {
+            std::optional<TaskID> task = get_next_task();
+            if (!task) {
+                return std::nullopt;
+            }
+            return TaskStep{std::move(*task), Direction::FORWARD};
+        }
+
         /**
          * Get task details by ID
          */
@@ -1,32 +1,32 @@
 #pragma once
 
+#include "id_table.hpp"
+#include "index_map.hpp"
 #include "types.hpp"
 
-#include <map>
-
 namespace consens::cbba {
 
     /**
      * Bid structure representing an agent's bid on a task
      */
     struct Bid {
-        AgentID agent_id;
+        AgentHandle agent_id;
         Score score;
         Timestamp timestamp;
 
-        Bid() : agent_id(NO_AGENT), score(MIN_SCORE), timestamp(0.0) {}
+        Bid() : agent_id(), score(MIN_SCORE), timestamp(0.0) {}
 
-        Bid(const AgentID &id, Score s, Timestamp t) : agent_id(id), score(s), timestamp(t) {}
+        Bid(AgentHandle agent, Score s, Timestamp t) : agent_id(agent), score(s), timestamp(t) {}
 
         /**
          * Comparison for auction logic
          * Higher score wins; if scores equal, lower agent ID wins
          */
         bool operator>(const Bid &other) const {
-            if (agent_id == NO_AGENT && other.agent_id != NO_AGENT) {
+            if (!agent_id.is_valid() && other.agent_id.is_valid()) {
                 return false; // Unassigned loses to assigned
             }
-            if (agent_id != NO_AGENT && other.agent_id == NO_AGENT) {
+            if (agent_id.is_valid() && !other.agent_id.is_valid()) {
                 return true; // Assigned beats unassigned
             }
 
@@ -34,7 +34,9 @@ namespace consens::cbba {
                 return true;
             } else if (score == other.score) {
                 // Tie-breaking: lower agent ID wins
-                return agent_id < other.agent_id;
+                // Compare names, not handles: handle order is local to this process. The table
+                // orders them by a precomputed prefix, without locking or copying strings
+                return agent_ids().less(agent_id.index(), other.agent_id.index());
             }
             return false;
         }
@@ -48,7 +50,7 @@ namespace consens::cbba {
         /**
          * Check if bid is valid (assigned to an agent)
          */
-        bool is_valid() const { return agent_id != NO_AGENT && score > MIN_SCORE; }
+        bool is_valid() const { return agent_id.is_valid() && score > MIN_SCORE; }
 
         /**
          * Create an invalid/unassigned bid
@@ -58,20 +60,26 @@ namespace consens::cbba {
 
     /**
      * Winning bids for each task
-     * Maps TaskID -> Bid
+     * Maps TaskIndex -> Bid
+     */
+    using TaskBids = IndexMap<Bid, task_ids>;
+
+    /**
+     * Winners for each task (just the agent)
+     * Maps TaskIndex -> AgentHandle
      */
-    using TaskBids = std::map<TaskID, Bid>;
+    using TaskWinners = IndexMap<AgentHandle, task_ids>;
 
     /**
-     * Winners for each task (just the agent ID)
-     * Maps TaskID -> AgentID
+     * Scores for each task (local bids)
+     * Maps TaskIndex -> Score
      */
-    using TaskWinners = std::map<TaskID, AgentID>;
+    using TaskScores = IndexMap<Score, task_ids>;
 
     /**
      * Agent timestamps (for consensus protocol)
-     * Maps AgentID -> Timestamp
+     * Maps AgentIndex -> Timestamp
      */
-    using AgentTimestamps = std::map<AgentID, Timestamp>;
+    using AgentTimestamps = IndexMap<Timestamp, agent_ids>;
 
 } // namespace consens::cbba
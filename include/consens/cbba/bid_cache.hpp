@@ -0,0 +1,95 @@
+#pragma once
+
+#include "cbba_agent.hpp"
+#include "spatial_index.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Memoised best insertion (score, position, direction) per task for one agent
+     *
+     * Entries stay valid while everything the score depends on is unchanged. A change to the
+     * agent, its path (membership or the geometry of a path task), its velocity or its position
+     * (beyond pose_epsilon of where the entries were computed) drops every entry in O(1) by
+     * moving to a new generation. A change to one task's geometry only drops that task's entry:
+     * each entry records SpatialIndex::task_revision() of its task, so adding or removing other
+     * tasks keeps it. The scoring policy is fixed for the builder that owns the cache.
+     */
+    class BidCache {
+      private:
+        struct Entry {
+            Score score;
+            uint32_t position : 31;
+            uint32_t reversed : 1;
+            uint32_t generation;    // Entry is valid only if it matches generation_
+            uint64_t task_revision; // SpatialIndex::task_revision() of the task when stored
+        };
+
+        std::vector<Entry> entries_; // Indexed by TaskIndex
+        uint32_t generation_;
+        double pose_epsilon_;
+
+        // Inputs the current generation was computed against
+        AgentIndex agent_;
+        uint64_t path_version_;
+        Point position_;
+        double velocity_;
+        uint64_t path_revision_; // Latest task revision among the path tasks
+
+        size_t hits_;
+        size_t misses_;
+
+      public:
+        /**
+         * Constructor
+         * @param pose_epsilon Agent motion (meters) tolerated before entries are dropped
+         */
+        explicit BidCache(double pose_epsilon = 0.0);
+
+        /**
+         * Drop all entries if an agent or path input changed since they were computed
+         * Call once before a round of lookups.
+         *
+         * @param agent Agent being scored
+         * @param spatial_index Index holding the agent's path tasks
+         * @return True if existing entries were kept
+         */
+        bool validate(const CBBAAgent &agent, const SpatialIndex &spatial_index);
+
+        /**
+         * Look up the cached best insertion of a task
+         * @param task_revision Current SpatialIndex::task_revision() of the task
+         * @return True on hit (insertion is written)
+         */
+        bool lookup(TaskIndex task, uint64_t task_revision, Insertion &insertion);
+
+        /**
+         * Store the best insertion of a task for the current generation
+         * @param task_revision SpatialIndex::task_revision() of the task it was scored against
+         */
+        void store(TaskIndex task, uint64_t task_revision, const Insertion &insertion);
+
+        /**
+         * Drop all entries
+         */
+        void invalidate();
+
+        /**
+         * Set the motion tolerance (drops all entries)
+         */
+        void set_pose_epsilon(double epsilon);
+
+        double get_pose_epsilon() const { return pose_epsilon_; }
+
+        /**
+         * Lookup statistics (for monitoring and tests)
+         */
+        size_t hits() const { return hits_; }
+        size_t misses() const { return misses_; }
+    };
+
+} // namespace consens::cbba
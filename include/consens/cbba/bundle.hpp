@@ -1,9 +1,12 @@
 #pragma once
 
+#include "id_table.hpp"
 #include "types.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace consens::cbba {
@@ -11,12 +14,26 @@ namespace consens::cbba {
     /**
      * Bundle: unordered set of tasks that an agent claims
      * In CBBA, this is the 'b' vector
+     *
+     * Tasks are kept in insertion order alongside a position index over TaskIndex,
+     * so membership checks and removal lookups are O(1) instead of a scan.
      */
     class Bundle {
       private:
-        std::vector<TaskID> tasks_;
+        std::vector<TaskIndex> tasks_;
+        std::vector<uint32_t> positions_; // Position per TaskIndex, INVALID_INDEX if absent
         size_t capacity_;
 
+        uint32_t position_of(TaskIndex task) const {
+            return task < positions_.size() ? positions_[task] : INVALID_INDEX;
+        }
+
+        void reindex_from(size_t position) {
+            for (size_t i = position; i < tasks_.size(); ++i) {
+                positions_[tasks_[i]] = static_cast<uint32_t>(i);
+            }
+        }
+
       public:
         // Default to effectively unlimited capacity (SIZE_MAX)
         // User can set specific limits via CBBAAgent constructor
@@ -30,33 +47,49 @@ namespace consens::cbba {
         /**
          * Add a task to the bundle
          */
-        void add(const TaskID &task_id) {
-            if (!contains(task_id) && !is_full()) {
-                tasks_.push_back(task_id);
+        void add(TaskIndex task) {
+            if (task != NO_TASK && !contains(task) && !is_full()) {
+                if (task >= positions_.size()) {
+                    positions_.resize(static_cast<size_t>(task) + 1, INVALID_INDEX);
+                }
+                positions_[task] = static_cast<uint32_t>(tasks_.size());
+                tasks_.push_back(task);
             }
         }
 
+        void add(const TaskID &task_id) { add(task_ids().intern(task_id)); }
+
         /**
          * Remove a task from the bundle
          */
-        void remove(const TaskID &task_id) {
-            auto it = std::find(tasks_.begin(), tasks_.end(), task_id);
-            if (it != tasks_.end()) {
-                tasks_.erase(it);
+        void remove(TaskIndex task) {
+            uint32_t position = position_of(task);
+            if (position == INVALID_INDEX) {
+                return;
             }
+            positions_[task] = INVALID_INDEX;
+            tasks_.erase(tasks_.begin() + position);
+            reindex_from(position);
         }
 
+        void remove(const TaskID &task_id) { remove(task_ids().find(task_id)); }
+
         /**
          * Remove all tasks from the bundle
          */
-        void clear() { tasks_.clear(); }
+        void clear() {
+            for (TaskIndex task : tasks_) {
+                positions_[task] = INVALID_INDEX;
+            }
+            tasks_.clear();
+        }
 
         /**
          * Check if bundle contains a task
          */
-        bool contains(const TaskID &task_id) const {
-            return std::find(tasks_.begin(), tasks_.end(), task_id) != tasks_.end();
-        }
+        bool contains(TaskIndex task) const { return position_of(task) != INVALID_INDEX; }
+
+        bool contains(const TaskID &task_id) const { return contains(task_ids().find(task_id)); }
 
         /**
          * Check if bundle is full
@@ -74,9 +107,21 @@ namespace consens::cbba {
         size_t capacity() const { return capacity_; }
 
         /**
-         * Get all tasks
+         * Get all tasks (as IDs)
+         */
+        std::vector<TaskID> get_tasks() const {
+            std::vector<TaskID> ids;
+            ids.reserve(tasks_.size());
+            for (TaskIndex task : tasks_) {
+                ids.push_back(task_ids().name(task));
+            }
+            return ids;
+        }
+
+        /**
+         * Get all tasks (as handles)
          */
-        const std::vector<TaskID> &get_tasks() const { return tasks_; }
+        const std::vector<TaskIndex> &indices() const { return tasks_; }
 
         /**
          * Check if bundle is empty
@@ -87,67 +132,165 @@ namespace consens::cbba {
     /**
      * Path: ordered sequence of tasks for execution
      * In CBBA, this is the 'p' vector (path is bundle with execution order)
+     *
+     * A position index over TaskIndex makes membership and position lookups O(1).
+     * Each task appears at most once, with the direction it is traversed in.
      */
     class Path {
       private:
-        std::vector<TaskID> tasks_;
+        std::vector<TaskIndex> tasks_;
+        std::vector<Direction> directions_; // Parallel to tasks_
+        std::vector<uint32_t> positions_; // Position per TaskIndex, INVALID_INDEX if absent
+        uint64_t version_ = next_version();
+
+        /**
+         * Process-wide counter, so versions of distinct paths never collide
+         */
+        static uint64_t next_version() {
+            static std::atomic<uint64_t> counter{0};
+            return ++counter;
+        }
+
+        uint32_t position_of(TaskIndex task) const {
+            return task < positions_.size() ? positions_[task] : INVALID_INDEX;
+        }
+
+        void reindex_from(size_t position) {
+            for (size_t i = position; i < tasks_.size(); ++i) {
+                positions_[tasks_[i]] = static_cast<uint32_t>(i);
+            }
+        }
 
       public:
         Path() = default;
 
         /**
          * Insert a task at a specific position
+         * No-op if the task is already in the path
          */
-        void insert(const TaskID &task_id, size_t position) {
+        void insert(TaskIndex task, size_t position, Direction direction = Direction::FORWARD) {
+            if (task == NO_TASK || contains(task)) {
+                return;
+            }
             if (position > tasks_.size()) {
                 position = tasks_.size();
             }
-            tasks_.insert(tasks_.begin() + position, task_id);
+            if (task >= positions_.size()) {
+                positions_.resize(static_cast<size_t>(task) + 1, INVALID_INDEX);
+            }
+            tasks_.insert(tasks_.begin() + position, task);
+            directions_.insert(directions_.begin() + position, direction);
+            reindex_from(position);
+            version_ = next_version();
+        }
+
+        void insert(const TaskID &task_id, size_t position, Direction direction = Direction::FORWARD) {
+            insert(task_ids().intern(task_id), position, direction);
         }
 
         /**
          * Remove a task from the path
          */
-        void remove(const TaskID &task_id) {
-            auto it = std::find(tasks_.begin(), tasks_.end(), task_id);
-            if (it != tasks_.end()) {
-                tasks_.erase(it);
+        void remove(TaskIndex task) {
+            uint32_t position = position_of(task);
+            if (position == INVALID_INDEX) {
+                return;
+            }
+            positions_[task] = INVALID_INDEX;
+            tasks_.erase(tasks_.begin() + position);
+            directions_.erase(directions_.begin() + position);
+            reindex_from(position);
+            version_ = next_version();
+        }
+
+        void remove(const TaskID &task_id) { remove(task_ids().find(task_id)); }
+
+        /**
+         * Reverse the order of the tasks in [first, last), flipping their directions (2-opt move)
+         */
+        void reverse(size_t first, size_t last) {
+            last = std::min(last, tasks_.size());
+            if (first >= last) {
+                return;
+            }
+            std::reverse(tasks_.begin() + first, tasks_.begin() + last);
+            std::reverse(directions_.begin() + first, directions_.begin() + last);
+            for (size_t i = first; i < last; ++i) {
+                directions_[i] = opposite(directions_[i]);
+                positions_[tasks_[i]] = static_cast<uint32_t>(i);
+            }
+            version_ = next_version();
+        }
+
+        /**
+         * Rotate the tasks in [first, last) so that the task at `middle` comes first (Or-opt move)
+         */
+        void rotate(size_t first, size_t middle, size_t last) {
+            last = std::min(last, tasks_.size());
+            if (first >= middle || middle >= last) {
+                return;
+            }
+            std::rotate(tasks_.begin() + first, tasks_.begin() + middle, tasks_.begin() + last);
+            std::rotate(directions_.begin() + first, directions_.begin() + middle, directions_.begin() + last);
+            for (size_t i = first; i < last; ++i) {
+                positions_[tasks_[i]] = static_cast<uint32_t>(i);
             }
+            version_ = next_version();
         }
 
         /**
          * Remove all tasks
          */
-        void clear() { tasks_.clear(); }
+        void clear() { remove_from(0); }
 
         /**
          * Check if path contains a task
          */
-        bool contains(const TaskID &task_id) const {
-            return std::find(tasks_.begin(), tasks_.end(), task_id) != tasks_.end();
-        }
+        bool contains(TaskIndex task) const { return position_of(task) != INVALID_INDEX; }
+
+        bool contains(const TaskID &task_id) const { return contains(task_ids().find(task_id)); }
 
         /**
          * Find position of a task in the path
          * Returns size() if not found
          */
-        size_t find_position(const TaskID &task_id) const {
-            auto it = std::find(tasks_.begin(), tasks_.end(), task_id);
-            if (it != tasks_.end()) {
-                return std::distance(tasks_.begin(), it);
+        size_t find_position(TaskIndex task) const {
+            uint32_t position = position_of(task);
+            if (position != INVALID_INDEX) {
+                return position;
             }
             return tasks_.size();
         }
 
+        size_t find_position(const TaskID &task_id) const { return find_position(task_ids().find(task_id)); }
+
         /**
          * Get number of tasks in path
          */
         size_t size() const { return tasks_.size(); }
 
         /**
-         * Get all tasks in execution order
+         * Get all tasks in execution order (as IDs)
+         */
+        std::vector<TaskID> get_tasks() const {
+            std::vector<TaskID> ids;
+            ids.reserve(tasks_.size());
+            for (TaskIndex task : tasks_) {
+                ids.push_back(task_ids().name(task));
+            }
+            return ids;
+        }
+
+        /**
+         * Get all tasks in execution order (as handles)
+         */
+        const std::vector<TaskIndex> &indices() const { return tasks_; }
+
+        /**
+         * Version of the path contents
+         * Changes on every mutation; copies share the version of their source
          */
-        const std::vector<TaskID> &get_tasks() const { return tasks_; }
+        uint64_t version() const { return version_; }
 
         /**
          * Check if path is empty
@@ -157,12 +300,32 @@ namespace consens::cbba {
         /**
          * Get task at specific position
          */
-        const TaskID &operator[](size_t index) const { return tasks_[index]; }
+        const TaskID &operator[](size_t index) const { return task_ids().name(tasks_[index]); }
+
+        /**
+         * Get handle of task at specific position
+         */
+        TaskIndex index_at(size_t index) const { return tasks_[index]; }
+
+        /**
+         * Get direction of task at specific position
+         */
+        Direction direction_at(size_t index) const { return directions_[index]; }
+
+        /**
+         * Get direction of a task (FORWARD if not in the path)
+         */
+        Direction get_direction(TaskIndex task) const {
+            uint32_t position = position_of(task);
+            return position != INVALID_INDEX ? directions_[position] : Direction::FORWARD;
+        }
+
+        Direction get_direction(const TaskID &task_id) const { return get_direction(task_ids().find(task_id)); }
 
         /**
          * Get first task (next to execute)
          */
-        const TaskID &front() const { return tasks_.front(); }
+        const TaskID &front() const { return task_ids().name(tasks_.front()); }
 
         /**
          * Remove tasks from position onwards
@@ -170,7 +333,12 @@ namespace consens::cbba {
          */
         void remove_from(size_t position) {
             if (position < tasks_.size()) {
+                for (size_t i = position; i < tasks_.size(); ++i) {
+                    positions_[tasks_[i]] = INVALID_INDEX;
+                }
                 tasks_.erase(tasks_.begin() + position, tasks_.end());
+                directions_.erase(directions_.begin() + position, directions_.end());
+                version_ = next_version();
             }
         }
     };
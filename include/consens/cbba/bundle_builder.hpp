@@ -1,10 +1,21 @@
 #pragma once
 
+#include "bid_cache.hpp"
 #include "cbba_agent.hpp"
+#include "executor.hpp"
+#include "path_improver.hpp"
 #include "scorer.hpp"
 #include "spatial_index.hpp"
+#include "task_set.hpp"
+#include "travel_cost.hpp"
 #include "types.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace consens::cbba {
@@ -12,40 +23,132 @@ namespace consens::cbba {
     /**
      * Bundle builder implements the bundle construction phase of CBBA
      * Uses spatial filtering and greedy task selection
+     *
+     * @tparam Policy Scoring policy (see ScoringPolicy); BundleBuilder selects one by Metric
      */
-    class BundleBuilder {
+    template <ScoringPolicy Policy> class BasicBundleBuilder {
       private:
-        TaskScorer scorer_;
+        // Candidates scored per insertion kernel call; small enough to keep the early exit tight
+        static constexpr size_t SCORING_BATCH_SIZE = 32;
+
+        /**
+         * Candidate state for lazy-greedy bundle filling
+         */
+        struct LazyCandidate {
+            TaskIndex task;
+            Score key;      // Exact best gain, or an upper bound on it if !exact
+            TaskIndex slot; // Path task following the best slot (NO_TASK = append), valid if exact
+            uint32_t stamp; // Stamp of the candidate's live heap entry
+            bool exact;
+            bool taken; // In the bundle, or dropped because it is no longer available
+        };
+
+        /**
+         * Heap entry; outdated once the candidate's stamp moves on
+         */
+        struct LazyEntry {
+            Score key;
+            TaskIndex task;
+            uint32_t candidate;
+            uint32_t stamp;
+
+            // Max-heap on key, ties towards the lower handle (same order as find_best_task)
+            bool operator<(const LazyEntry &other) const {
+                return key < other.key || (key == other.key && task > other.task);
+            }
+        };
+
+        /**
+         * Progress of fill_bundle, which can pause between calls (see set_build_budget)
+         */
+        enum class FillStage : uint8_t {
+            IDLE,    // No fill in progress
+            SCORING, // Scoring candidates [fill_scored_, n) against profile_
+            FILLING  // Picking from the heap
+        };
+
+        /**
+         * Scratch for one slice of a batch scored on an executor thread
+         */
+        struct ScoringLane {
+            InsertionBatch batch;
+            std::vector<Insertion> results;
+        };
+
+        BasicTaskScorer<Policy> scorer_;
         SpatialIndex *spatial_index_;
         float query_radius_;
         BundleMode mode_;
+        TaskSet scratch_available_; // Reused by the vector overloads of build_bundle
+        PathProfile profile_;       // Current path profile, shared by all candidates of one selection
+        BidCache cache_;            // Best insertion per task, reused across ticks while inputs are unchanged
+        InsertionBatch batch_;      // Candidates waiting for the batch insertion kernel
+        std::vector<Insertion> batch_results_;
+        std::vector<TaskIndex> lazy_tasks_;      // Scratch for fill_bundle
+        std::vector<Score> lazy_gains_;          // Gains of the two slots patched by fill_bundle
+        std::vector<LazyCandidate> lazy_;        // fill_bundle candidates, parallel to batch_
+        std::vector<LazyEntry> lazy_heap_;       // fill_bundle max-heap
+        std::unique_ptr<TravelCostCache> travel_costs_; // nullptr = straight-line travel
+        Executor *executor_ = nullptr;                  // nullptr = serial scoring
+        std::vector<ScoringLane> lanes_;                // One per slice of a parallel batch
+        PathImprover improver_;                         // Reorders the path after building
+
+        // Paused fill_bundle, resumed while the agent, its path and the index are unchanged, and the
+        // agent is still near the pose the fill (and its heap keys) started from
+        std::chrono::microseconds build_budget_{0}; // fill_bundle time per call (0 = until done)
+        FillStage fill_stage_ = FillStage::IDLE;
+        size_t fill_scored_ = 0;
+        AgentIndex fill_agent_ = NO_AGENT_INDEX;
+        uint64_t fill_path_version_ = 0;
+        uint64_t fill_index_revision_ = 0;
+        Point fill_position_;       // Pose the fill started from
+        double fill_velocity_ = 0.0; // Velocity the fill started with
+        InsertionBatch fill_chunk_; // Slice of batch_ scored in one step
+        std::vector<Insertion> fill_chunk_results_;
 
       public:
         /**
          * Constructor
          * @param spatial_index Pointer to spatial index (not owned)
-         * @param metric Scoring metric (default: RPT)
+         * @param policy Scoring policy (with its parameters)
          * @param query_radius Radius for spatial queries (default: 100m)
          * @param mode Bundle building mode (default: ADD)
+         * @param pose_epsilon Agent motion (meters) tolerated before cached bids are dropped (default: 0)
          */
-        BundleBuilder(SpatialIndex *spatial_index, Metric metric = Metric::RPT, float query_radius = 100.0f,
-                      BundleMode mode = BundleMode::ADD);
+        explicit BasicBundleBuilder(SpatialIndex *spatial_index, Policy policy = Policy(),
+                                    float query_radius = 100.0f, BundleMode mode = BundleMode::ADD,
+                                    double pose_epsilon = 0.0)
+            : scorer_(std::move(policy)), spatial_index_(spatial_index), query_radius_(query_radius), mode_(mode),
+              cache_(pose_epsilon) {}
 
         /**
          * Build bundle for an agent
          *
          * In ADD mode: Adds one best task per call
-         * In FULLBUNDLE mode: Fills bundle to capacity
+         * In FULLBUNDLE mode: Fills bundle to capacity, or as far as the build budget allows
+         * (the next call resumes, see set_build_budget)
+         * Then reorders the path by local search, if a path improvement budget is set and the
+         * bundle is complete.
          *
          * @param agent Agent to build bundle for
-         * @param available_tasks List of task IDs that are unassigned or can be bid on
+         * @param available Tasks that are unassigned or can be bid on (tested in O(1) per hit)
+         */
+        void build_bundle(CBBAAgent &agent, const TaskSet &available);
+
+        /**
+         * Build bundle from a list of available tasks
+         * Convenience overloads; converts the list to a TaskSet first
          */
+        void build_bundle(CBBAAgent &agent, const std::vector<TaskIndex> &available_tasks);
         void build_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks);
 
         /**
          * Set spatial query radius
          */
-        void set_query_radius(float radius) { query_radius_ = radius; }
+        void set_query_radius(float radius) {
+            query_radius_ = radius;
+            fill_stage_ = FillStage::IDLE;
+        }
 
         /**
          * Get current query radius
@@ -55,7 +158,10 @@ namespace consens::cbba {
         /**
          * Set bundle building mode
          */
-        void set_mode(BundleMode mode) { mode_ = mode; }
+        void set_mode(BundleMode mode) {
+            mode_ = mode;
+            fill_stage_ = FillStage::IDLE;
+        }
 
         /**
          * Get current mode
@@ -63,58 +169,795 @@ namespace consens::cbba {
         BundleMode get_mode() const { return mode_; }
 
         /**
-         * Set scoring metric
+         * Get the scorer (and through it the scoring policy)
          */
-        void set_metric(Metric metric) { scorer_.set_metric(metric); }
+        const BasicTaskScorer<Policy> &get_scorer() const { return scorer_; }
 
         /**
-         * Get current metric
+         * Get the spatial index the builder queries
          */
-        Metric get_metric() const { return scorer_.get_metric(); }
+        SpatialIndex *get_spatial_index() const { return spatial_index_; }
+
+        /**
+         * Get the bid cache (hit statistics, manual invalidation)
+         */
+        BidCache &get_bid_cache() { return cache_; }
+        const BidCache &get_bid_cache() const { return cache_; }
+
+        /**
+         * Score travel with a cost model (nullptr restores straight-line travel); drops cached bids
+         * @param model Cost model (shared with other builders if desired)
+         * @param capacity Task-to-task legs kept in the travel cost cache
+         */
+        void set_travel_cost_model(std::shared_ptr<const TravelCostModel> model,
+                                   size_t capacity = DEFAULT_TRAVEL_CACHE_CAPACITY) {
+            travel_costs_ = model ? std::make_unique<TravelCostCache>(std::move(model), *spatial_index_, capacity)
+                                  : nullptr;
+            scorer_.set_travel_costs(travel_costs_.get());
+            cache_.invalidate();
+            fill_stage_ = FillStage::IDLE;
+        }
+
+        /**
+         * Get the travel cost cache (nullptr without a cost model)
+         */
+        const TravelCostCache *get_travel_costs() const { return travel_costs_.get(); }
 
-      private:
         /**
-         * Get candidate tasks using spatial filtering
-         * Queries spatial index for tasks near agent's position
+         * Score candidate batches in parallel on an executor (nullptr = serial)
          *
-         * @param agent Agent state
-         * @param available_tasks List of available task IDs
-         * @return Filtered list of candidate task IDs
+         * Batches are split into contiguous slices scored concurrently against the same path
+         * profile and merged in candidate order, so bundles are identical to serial ones. Scoring
+         * stays serial while a travel cost model is set (its cache is not thread-safe).
+         * @param executor Executor (not owned, must outlive the builder or be reset)
+         */
+        void set_executor(Executor *executor) { executor_ = executor; }
+
+        /**
+         * Get the executor (nullptr if scoring is serial)
+         */
+        Executor *get_executor() const { return executor_; }
+
+        /**
+         * Reorder the path with 2-opt / Or-opt moves after each build (see PathImprover)
+         * @param budget Time spent per build_bundle call (0 = disabled)
+         */
+        void set_path_improvement_budget(std::chrono::microseconds budget) { improver_.set_budget(budget); }
+
+        /**
+         * Get the path improver (budget, move statistics)
          */
-        std::vector<TaskID> get_candidates(const CBBAAgent &agent, const std::vector<TaskID> &available_tasks) const;
+        const PathImprover &get_path_improver() const { return improver_; }
 
+        /**
+         * Limit the time one FULLBUNDLE build_bundle call spends (0 = fill to completion)
+         *
+         * A call that runs out of time pauses between two steps (a slice of candidate scoring or
+         * one pick) and the next call resumes where it stopped, so a large fill spreads over
+         * several ticks. Every call makes at least one step. The paused fill is dropped and
+         * restarted if the agent's path was changed by anyone else (e.g. a consensus reset), the
+         * spatial index changed, or a builder setting changed. Tasks that stopped being available
+         * are skipped.
+         *
+         * Heap keys are only upper bounds for the pose they were scored at, so the fill also
+         * restarts when the agent's velocity changed or it moved further than the bid cache's
+         * pose_epsilon (the same motion cached bids tolerate) from where the fill started, summed
+         * over all pauses. A call that restarts for motion
+         * does not pause before its first pick, so an agent moving every tick still fills up.
+         */
+        void set_build_budget(std::chrono::microseconds budget) { build_budget_ = budget; }
+
+        std::chrono::microseconds get_build_budget() const { return build_budget_; }
+
+        /**
+         * Check if a paused fill will resume on the next call
+         */
+        bool is_building() const { return fill_stage_ != FillStage::IDLE; }
+
+        /**
+         * Drop the paused fill, its candidates and every cached bid (settings are kept)
+         */
+        void reset() {
+            fill_stage_ = FillStage::IDLE;
+            fill_scored_ = 0;
+            lazy_.clear();
+            lazy_heap_.clear();
+            cache_.invalidate();
+        }
+
+      private:
         /**
          * Find best task to add to bundle
-         * Computes marginal gain for each candidate and selects best
+         *
+         * Streams tasks nearest-first from the spatial index and scores only available ones
+         * within query radius. Stops as soon as the scorer's upper bound on marginal gain for
+         * the next (and every farther) task drops below the best gain found so far.
+         * Equal gains are broken towards the lower TaskIndex. Scores come from the bid cache
+         * when the agent's path, pose and velocity are unchanged since they were computed;
+         * cache misses are scored in batches by the SIMD insertion kernel (one batch per
+         * executor thread at a time, see set_executor).
          *
          * @param agent Agent state
-         * @param candidates List of candidate task IDs
-         * @return Tuple of (best_task_id, best_score, best_position), or empty task_id if none found
+         * @param available Available tasks
+         * @return Pair of (best_task, best_insertion), or NO_TASK if none found
          */
-        std::tuple<TaskID, Score, size_t> find_best_task(const CBBAAgent &agent, const std::vector<TaskID> &candidates);
+        std::pair<TaskIndex, Insertion> find_best_task(const CBBAAgent &agent, const TaskSet &available);
 
         /**
          * Check if agent should bid on a task
          * Returns true if agent's bid is better than current winning bid
          *
          * @param agent Agent state
-         * @param task_id Task to check
+         * @param task Task to check
          * @param my_bid Agent's computed bid
          * @return True if agent should bid
          */
-        bool should_bid(const CBBAAgent &agent, const TaskID &task_id, Score my_bid) const;
+        bool should_bid(const CBBAAgent &agent, TaskIndex task, Score my_bid) const;
 
         /**
          * Add one task to bundle (ADD mode)
          * @return True if a task was added
          */
-        bool add_one_task(CBBAAgent &agent, const std::vector<TaskID> &available_tasks);
+        bool add_one_task(CBBAAgent &agent, const TaskSet &available);
 
         /**
          * Fill bundle to capacity (FULLBUNDLE mode)
-         * @return Number of tasks added
+         *
+         * Lazy greedy: candidates in radius are gathered and scored once, then kept in a max-heap
+         * keyed on their best gain. For local policies (RPT) an insertion only replaces one slot
+         * with two, so every key is patched with the gains of the two new slots (one kernel call per direction)
+         * and only candidates whose best slot was split become upper bounds, re-evaluated when
+         * they reach the top. Otherwise (TDR) an insertion delays every later task, so all keys
+         * are rescored exactly. Either way each pick equals add_one_task's, so bundles are identical.
+         * Runs as a state machine (see FillStage) that can pause between steps and resume; a paused
+         * fill is restarted when the agent moved beyond pose_epsilon, since its keys are then stale.
+         *
+         * @return Number of tasks added by this call
+         */
+        size_t fill_bundle(CBBAAgent &agent, const TaskSet &available);
+
+        /**
+         * Gather the candidates of a new fill and start scoring them
+         */
+        void start_fill(const CBBAAgent &agent, const TaskSet &available);
+
+        /**
+         * Run one step of the fill (FillStage::IDLE once it is complete)
+         * @return True if a task was added
+         */
+        bool fill_step(CBBAAgent &agent, const TaskSet &available);
+
+        /**
+         * Check if the paused fill still matches the agent, its path and the index
+         */
+        bool can_resume_fill(const CBBAAgent &agent) const {
+            return fill_stage_ != FillStage::IDLE && agent.get_handle().index() == fill_agent_ &&
+                   agent.get_path().version() == fill_path_version_ &&
+                   spatial_index_->revision() == fill_index_revision_;
+        }
+
+        /**
+         * Check if the agent is still within pose_epsilon of where the fill started
+         * Measured from the start, not from the last pause, so slow drift adds up.
+         */
+        bool fill_pose_matches(const CBBAAgent &agent) const {
+            return agent.get_velocity() == fill_velocity_ &&
+                   agent.get_pose().position.distance_to(fill_position_) <= cache_.get_pose_epsilon();
+        }
+
+        /**
+         * Path task at or after a position that is present in the index (NO_TASK if none)
+         */
+        TaskIndex next_indexed_task(const Path &path, size_t position) const;
+
+        /**
+         * Start rescoring every fill_bundle candidate exactly against the current path
+         */
+        void rescore_lazy_candidates(const CBBAAgent &agent);
+
+        /**
+         * Score the next slice of candidates (all of them without a build budget)
+         * @return True once every candidate is scored
+         */
+        bool score_lazy_candidates();
+
+        /**
+         * Rebuild the heap from freshly scored candidates
+         */
+        void rebuild_lazy_heap(const CBBAAgent &agent);
+
+        /**
+         * Patch fill_bundle keys after `task` was inserted in front of `next` (local policies only)
+         */
+        void patch_lazy_candidates(const CBBAAgent &agent, TaskIndex task, TaskIndex next);
+
+        /**
+         * Push a candidate's current key onto the heap (invalidates its older entries)
+         */
+        void push_lazy_candidate(uint32_t index);
+
+        /**
+         * Number of slices a batch is scored in at once (1 = serial)
+         */
+        size_t scoring_lanes() const { return executor_ && !travel_costs_ ? executor_->concurrency() : 1; }
+
+        /**
+         * Best insertion of every candidate against profile_ (same results as the scorer's
+         * find_optimal_insertions); batches larger than SCORING_BATCH_SIZE are split across the executor
+         */
+        void score_batch(InsertionBatch &batch, std::vector<Insertion> &out);
+    };
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::build_bundle(CBBAAgent &agent, const TaskSet &available) {
+        if (mode_ == BundleMode::ADD) {
+            add_one_task(agent, available);
+        } else {
+            fill_bundle(agent, available);
+        }
+        if (!is_building()) {
+            improver_.improve(agent, scorer_, *spatial_index_);
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::build_bundle(CBBAAgent &agent, const std::vector<TaskIndex> &available_tasks) {
+        scratch_available_.clear();
+        for (TaskIndex task : available_tasks) {
+            scratch_available_.insert(task);
+        }
+        build_bundle(agent, scratch_available_);
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::build_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks) {
+        scratch_available_.clear();
+        for (const auto &task_id : available_tasks) {
+            scratch_available_.insert(task_ids().find(task_id));
+        }
+        build_bundle(agent, scratch_available_);
+    }
+
+    template <ScoringPolicy Policy>
+    std::pair<TaskIndex, Insertion> BasicBundleBuilder<Policy>::find_best_task(const CBBAAgent &agent,
+                                                                               const TaskSet &available) {
+        TaskIndex best_task = NO_TASK;
+        Insertion best{MIN_SCORE, 0, Direction::FORWARD};
+
+        const Path &path = agent.get_path();
+        const Point &agent_pos = agent.get_pose().position;
+        PathBounds bounds = scorer_.compute_path_bounds(agent, path, *spatial_index_);
+        bool profile_ready = false;
+        cache_.validate(agent, *spatial_index_);
+        batch_.clear();
+
+        // Ties go to the lower handle, independent of stream order
+        auto consider = [&](TaskIndex task, const Insertion &insertion) {
+            if (insertion.score > best.score || (insertion.score == best.score && task < best_task)) {
+                best = insertion;
+                best_task = task;
+            }
+        };
+
+        // Score pending cache misses in one call (profile built on the first one); results are
+        // merged in candidate order, so ties break the same however the batch was split
+        size_t flush_size = SCORING_BATCH_SIZE * scoring_lanes();
+        auto flush = [&]() {
+            if (batch_.empty()) {
+                return;
+            }
+            if (!profile_ready) {
+                scorer_.compute_path_profile(agent, path, *spatial_index_, profile_);
+                profile_ready = true;
+            }
+            score_batch(batch_, batch_results_);
+            for (size_t i = 0; i < batch_.size(); i++) {
+                cache_.store(batch_.tasks[i], spatial_index_->task_revision(batch_.tasks[i]), batch_results_[i]);
+                consider(batch_.tasks[i], batch_results_[i]);
+            }
+            batch_.clear();
+        };
+
+        // Consume candidates nearest-first until none of the remaining ones can win. Pending
+        // candidates only make best_score lower than it could be, so stopping stays exact.
+        spatial_index_->visit_nearest(agent_pos, [&](TaskIndex task, double min_distance) {
+            if (min_distance > query_radius_) {
+                return false;
+            }
+            if (best_task != NO_TASK && scorer_.marginal_gain_bound(agent, bounds, min_distance) < best.score) {
+                return false;
+            }
+
+            // Skip tasks that are not available or already in bundle
+            if (!available.contains(task) || agent.get_bundle().contains(task)) {
+                return true;
+            }
+
+            // Exact distance check (box distance is only a lower bound)
+            const Task *candidate = spatial_index_->find_task(task);
+            if (candidate->distance_to(agent_pos) > query_radius_) {
+                return true;
+            }
+
+            // Tighter per-candidate bound including its own duration and length
+            if (best_task != NO_TASK &&
+                scorer_.marginal_gain_bound(agent, bounds, min_distance, candidate->get_duration(),
+                                            candidate->get_length()) < best.score) {
+                return true;
+            }
+
+            // Cached best insertion, or queue the candidate for the batch kernel
+            Insertion cached;
+            if (cache_.lookup(task, spatial_index_->task_revision(task), cached)) {
+                consider(task, cached);
+            } else {
+                batch_.add(task, *candidate);
+                if (batch_.size() >= flush_size) {
+                    flush();
+                }
+            }
+            return true;
+        });
+        flush();
+
+        return {best_task, best};
+    }
+
+    template <ScoringPolicy Policy>
+    bool BasicBundleBuilder<Policy>::should_bid(const CBBAAgent &agent, TaskIndex task, Score my_bid) const {
+        // Get current winning bid for this task
+        Bid winning_bid = agent.get_winning_bid(task);
+
+        // If no winner yet, we should bid
+        if (!winning_bid.is_valid()) {
+            return true;
+        }
+
+        // Create our bid
+        Bid our_bid(agent.get_handle(), my_bid, agent.get_timestamp(agent.get_handle().index()));
+
+        // Bid if ours is better
+        return our_bid > winning_bid;
+    }
+
+    template <ScoringPolicy Policy>
+    bool BasicBundleBuilder<Policy>::add_one_task(CBBAAgent &agent, const TaskSet &available) {
+        // Check if bundle is full
+        if (agent.get_bundle().is_full()) {
+            return false;
+        }
+
+        if (available.empty()) {
+            return false;
+        }
+
+        // Find best task to add (spatially filtered nearest-first search)
+        auto [best_task, best] = find_best_task(agent, available);
+
+        // Check if we found a valid task
+        if (best_task == NO_TASK) {
+            return false;
+        }
+
+        // Check if we should bid on this task
+        if (!should_bid(agent, best_task, best.score)) {
+            return false;
+        }
+
+        // Add task to bundle (at its best position, in its best direction)
+        agent.add_to_bundle(best_task, best.score, best.position, best.direction);
+
+        return true;
+    }
+
+    template <ScoringPolicy Policy>
+    size_t BasicBundleBuilder<Policy>::fill_bundle(CBBAAgent &agent, const TaskSet &available) {
+        // Only motion is left to invalidate a fill that could otherwise resume
+        bool resumable = can_resume_fill(agent);
+        bool moved = resumable && !fill_pose_matches(agent);
+        if (!resumable || moved) {
+            fill_stage_ = FillStage::IDLE;
+            if (agent.get_bundle().is_full() || available.empty()) {
+                return 0;
+            }
+            fill_position_ = agent.get_pose().position;
+            fill_velocity_ = agent.get_velocity();
+            start_fill(agent, available);
+        }
+
+        bool budgeted = build_budget_.count() > 0;
+        auto deadline = std::chrono::steady_clock::now() + build_budget_;
+        size_t added_count = 0;
+        while (fill_stage_ != FillStage::IDLE) {
+            added_count += fill_step(agent, available) ? 1 : 0;
+            bool may_pause = !moved || added_count > 0;
+            if (budgeted && may_pause && fill_stage_ != FillStage::IDLE &&
+                std::chrono::steady_clock::now() >= deadline) {
+                // Pause; the snapshot tells the next call whether the fill is still valid
+                fill_agent_ = agent.get_handle().index();
+                fill_path_version_ = agent.get_path().version();
+                fill_index_revision_ = spatial_index_->revision();
+                break;
+            }
+        }
+
+        return added_count;
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::start_fill(const CBBAAgent &agent, const TaskSet &available) {
+        // The candidate set is fixed while the bundle fills (same radius, taken at the start)
+        spatial_index_->query_radius(agent.get_pose().position, query_radius_, lazy_tasks_);
+        batch_.clear();
+        lazy_.clear();
+        lazy_heap_.clear();
+        for (TaskIndex task : lazy_tasks_) {
+            if (!available.contains(task) || agent.get_bundle().contains(task)) {
+                continue;
+            }
+            batch_.add(task, *spatial_index_->find_task(task));
+            lazy_.push_back(LazyCandidate{task, MIN_SCORE, NO_TASK, 0, false, false});
+        }
+        rescore_lazy_candidates(agent);
+    }
+
+    template <ScoringPolicy Policy>
+    bool BasicBundleBuilder<Policy>::fill_step(CBBAAgent &agent, const TaskSet &available) {
+        if (fill_stage_ == FillStage::SCORING) {
+            if (score_lazy_candidates()) {
+                rebuild_lazy_heap(agent);
+            }
+            return false;
+        }
+
+        if (agent.get_bundle().is_full() || lazy_heap_.empty()) {
+            fill_stage_ = FillStage::IDLE;
+            return false;
+        }
+
+        std::pop_heap(lazy_heap_.begin(), lazy_heap_.end());
+        LazyEntry top = lazy_heap_.back();
+        lazy_heap_.pop_back();
+
+        LazyCandidate &candidate = lazy_[top.candidate];
+        if (candidate.taken || top.stamp != candidate.stamp) {
+            return false; // Outdated entry
+        }
+        if (!available.contains(candidate.task)) {
+            candidate.taken = true; // Lost availability while the fill was paused
+            return false;
+        }
+
+        // profile_ is rebuilt once per accepted insertion (see rescore/patch_lazy_candidates), so
+        // stale pops of one selection share it
+        const Path &path = agent.get_path();
+        Insertion best = scorer_.find_optimal_insertion(agent, candidate.task, path, profile_, *spatial_index_);
+
+        // An upper bound reached the top: replace it by the exact gain and let it compete again
+        // (an exact key that disagrees with a fresh evaluation is treated the same way)
+        if (!candidate.exact || best.score != candidate.key) {
+            candidate.key = best.score;
+            candidate.slot = next_indexed_task(path, best.position);
+            candidate.exact = true;
+            push_lazy_candidate(top.candidate);
+            return false;
+        }
+
+        // Exact and no other key is higher: this is the task add_one_task would pick
+        if (!should_bid(agent, candidate.task, best.score)) {
+            fill_stage_ = FillStage::IDLE;
+            return false;
+        }
+
+        TaskIndex next = next_indexed_task(path, best.position);
+        agent.add_to_bundle(candidate.task, best.score, best.position, best.direction);
+        candidate.taken = true;
+
+        if constexpr (LocalScoringPolicy<Policy>) {
+            patch_lazy_candidates(agent, candidate.task, next);
+        } else {
+            rescore_lazy_candidates(agent);
+        }
+        return true;
+    }
+
+    template <ScoringPolicy Policy>
+    TaskIndex BasicBundleBuilder<Policy>::next_indexed_task(const Path &path, size_t position) const {
+        for (size_t i = position; i < path.size(); i++) {
+            if (spatial_index_->find_task(path.index_at(i))) {
+                return path.index_at(i);
+            }
+        }
+        return NO_TASK;
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::rescore_lazy_candidates(const CBBAAgent &agent) {
+        scorer_.compute_path_profile(agent, agent.get_path(), *spatial_index_, profile_);
+        fill_scored_ = 0;
+        fill_stage_ = FillStage::SCORING;
+    }
+
+    template <ScoringPolicy Policy> bool BasicBundleBuilder<Policy>::score_lazy_candidates() {
+        size_t n = batch_.size();
+        if (build_budget_.count() <= 0) {
+            score_batch(batch_, batch_results_);
+            fill_scored_ = n;
+            return true;
+        }
+
+        // One flush worth of candidates per step, as in find_best_task
+        size_t count = std::min(SCORING_BATCH_SIZE * scoring_lanes(), n - fill_scored_);
+        batch_results_.resize(n);
+        fill_chunk_.assign(batch_, fill_scored_, count);
+        score_batch(fill_chunk_, fill_chunk_results_);
+        std::copy(fill_chunk_results_.begin(), fill_chunk_results_.end(), batch_results_.begin() + fill_scored_);
+        fill_scored_ += count;
+        return fill_scored_ == n;
+    }
+
+    template <ScoringPolicy Policy> void BasicBundleBuilder<Policy>::rebuild_lazy_heap(const CBBAAgent &agent) {
+        const Path &path = agent.get_path();
+        lazy_heap_.clear();
+        for (uint32_t i = 0; i < lazy_.size(); i++) {
+            LazyCandidate &candidate = lazy_[i];
+            if (candidate.taken) {
+                continue;
+            }
+            candidate.key = batch_results_[i].score;
+            candidate.slot = next_indexed_task(path, batch_results_[i].position);
+            candidate.exact = true;
+            push_lazy_candidate(i);
+        }
+        fill_stage_ = FillStage::FILLING;
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::patch_lazy_candidates(const CBBAAgent &agent, TaskIndex task, TaskIndex next) {
+        const Path &path = agent.get_path();
+        size_t task_pos = path.find_position(task);
+        size_t next_pos = next == NO_TASK ? SIZE_MAX : path.find_position(next);
+
+        // The slot in front of `next` became two: in front of `task`, and between `task` and `next`
+        scorer_.compute_path_profile(agent, path, *spatial_index_, profile_);
+        size_t slot = static_cast<size_t>(
+            std::lower_bound(profile_.positions.begin(), profile_.positions.end(), task_pos) -
+            profile_.positions.begin());
+        scorer_.compute_slot_gains(profile_, slot, 2, batch_, lazy_gains_);
+
+        size_t count = batch_.size();
+        for (uint32_t i = 0; i < count; i++) {
+            LazyCandidate &candidate = lazy_[i];
+            if (candidate.taken) {
+                continue;
+            }
+
+            // Gains of the two new slots, best direction of each
+            Score before_task = lazy_gains_[i];
+            Score before_next = lazy_gains_[count + i];
+
+            // Best slot was split (or already unknown): the other slots are no better than the
+            // old key, so the max with the new slots bounds the new best
+            if (!candidate.exact || candidate.slot == next) {
+                Score bound = std::max({candidate.key, before_task, before_next});
+                if (candidate.exact || bound != candidate.key) {
+                    candidate.key = bound;
+                    candidate.exact = false;
+                    push_lazy_candidate(i);
+                }
+                continue;
+            }
+
+            // Best slot untouched: the new best is exact (ties keep the earliest slot)
+            size_t best_pos = candidate.slot == NO_TASK ? SIZE_MAX : path.find_position(candidate.slot);
+            bool improved = false;
+            if (before_task > candidate.key || (before_task == candidate.key && task_pos < best_pos)) {
+                candidate.key = before_task;
+                candidate.slot = task;
+                best_pos = task_pos;
+                improved = true;
+            }
+            if (before_next > candidate.key || (before_next == candidate.key && next_pos < best_pos)) {
+                candidate.key = before_next;
+                candidate.slot = next;
+                improved = true;
+            }
+            if (improved) {
+                push_lazy_candidate(i);
+            }
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::push_lazy_candidate(uint32_t index) {
+        LazyCandidate &candidate = lazy_[index];
+        candidate.stamp++;
+        lazy_heap_.push_back(LazyEntry{candidate.key, candidate.task, index, candidate.stamp});
+        std::push_heap(lazy_heap_.begin(), lazy_heap_.end());
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicBundleBuilder<Policy>::score_batch(InsertionBatch &batch, std::vector<Insertion> &out) {
+        size_t n = batch.size();
+        size_t lanes = std::min(scoring_lanes(), (n + SCORING_BATCH_SIZE - 1) / SCORING_BATCH_SIZE);
+        if (lanes <= 1) {
+            scorer_.find_optimal_insertions(profile_, batch, out);
+            return;
+        }
+
+        // Contiguous slices; each lane copies and scores its own (the profile is only read)
+        size_t slice = (n + lanes - 1) / lanes;
+        lanes = (n + slice - 1) / slice;
+        if (lanes_.size() < lanes) {
+            lanes_.resize(lanes);
+        }
+        executor_->parallel_for(lanes, [&](size_t k) {
+            ScoringLane &lane = lanes_[k];
+            size_t first = k * slice;
+            lane.batch.assign(batch, first, std::min(slice, n - first));
+            scorer_.find_optimal_insertions(profile_, lane.batch, lane.results);
+        });
+
+        out.resize(n);
+        for (size_t k = 0; k < lanes; k++) {
+            std::copy(lanes_[k].results.begin(), lanes_[k].results.end(), out.begin() + k * slice);
+        }
+    }
+
+    // Built-in policies are instantiated once in the library
+    extern template class BasicBundleBuilder<RptPolicy>;
+    extern template class BasicBundleBuilder<TdrPolicy>;
+
+    /**
+     * Bundle builder selected by the Metric enum at runtime
+     * Dispatches once per call to BasicBundleBuilder<RptPolicy> or BasicBundleBuilder<TdrPolicy>;
+     * bundle construction itself is specialised for the metric.
+     */
+    class BundleBuilder {
+      private:
+        using Builder = std::variant<BasicBundleBuilder<RptPolicy>, BasicBundleBuilder<TdrPolicy>>;
+
+        Builder builder_;
+
+        static Builder make_builder(Metric metric, SpatialIndex *spatial_index, float query_radius, BundleMode mode,
+                                    double pose_epsilon);
+
+      public:
+        /**
+         * Constructor
+         * @param spatial_index Pointer to spatial index (not owned)
+         * @param metric Scoring metric (default: RPT)
+         * @param query_radius Radius for spatial queries (default: 100m)
+         * @param mode Bundle building mode (default: ADD)
+         * @param pose_epsilon Agent motion (meters) tolerated before cached bids are dropped (default: 0)
+         */
+        BundleBuilder(SpatialIndex *spatial_index, Metric metric = Metric::RPT, float query_radius = 100.0f,
+                      BundleMode mode = BundleMode::ADD, double pose_epsilon = 0.0);
+
+        /**
+         * Build bundle for an agent (see BasicBundleBuilder::build_bundle)
+         */
+        void build_bundle(CBBAAgent &agent, const TaskSet &available);
+        void build_bundle(CBBAAgent &agent, const std::vector<TaskIndex> &available_tasks);
+        void build_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks);
+
+        /**
+         * Set spatial query radius
+         */
+        void set_query_radius(float radius) {
+            std::visit([&](auto &builder) { builder.set_query_radius(radius); }, builder_);
+        }
+
+        /**
+         * Get current query radius
+         */
+        float get_query_radius() const {
+            return std::visit([](const auto &builder) { return builder.get_query_radius(); }, builder_);
+        }
+
+        /**
+         * Set bundle building mode
+         */
+        void set_mode(BundleMode mode) {
+            std::visit([&](auto &builder) { builder.set_mode(mode); }, builder_);
+        }
+
+        /**
+         * Get current mode
+         */
+        BundleMode get_mode() const {
+            return std::visit([](const auto &builder) { return builder.get_mode(); }, builder_);
+        }
+
+        /**
+         * Set scoring metric (switching drops cached bids)
+         */
+        void set_metric(Metric metric);
+
+        /**
+         * Get current metric
+         */
+        Metric get_metric() const { return builder_.index() == 0 ? Metric::RPT : Metric::TDR; }
+
+        /**
+         * Score travel with a cost model (see BasicBundleBuilder::set_travel_cost_model)
+         */
+        void set_travel_cost_model(std::shared_ptr<const TravelCostModel> model,
+                                   size_t capacity = DEFAULT_TRAVEL_CACHE_CAPACITY) {
+            std::visit([&](auto &builder) { builder.set_travel_cost_model(model, capacity); }, builder_);
+        }
+
+        /**
+         * Get the travel cost cache (nullptr without a cost model)
+         */
+        const TravelCostCache *get_travel_costs() const {
+            return std::visit([](const auto &builder) { return builder.get_travel_costs(); }, builder_);
+        }
+
+        /**
+         * Score candidate batches in parallel on an executor (see BasicBundleBuilder::set_executor)
+         */
+        void set_executor(Executor *executor) {
+            std::visit([&](auto &builder) { builder.set_executor(executor); }, builder_);
+        }
+
+        /**
+         * Get the executor (nullptr if scoring is serial)
+         */
+        Executor *get_executor() const {
+            return std::visit([](const auto &builder) { return builder.get_executor(); }, builder_);
+        }
+
+        /**
+         * Reorder the path after each build (see BasicBundleBuilder::set_path_improvement_budget)
+         */
+        void set_path_improvement_budget(std::chrono::microseconds budget) {
+            std::visit([&](auto &builder) { builder.set_path_improvement_budget(budget); }, builder_);
+        }
+
+        /**
+         * Get the path improver (budget, move statistics)
+         */
+        const PathImprover &get_path_improver() const {
+            return std::visit([](const auto &builder) -> const PathImprover & { return builder.get_path_improver(); },
+                              builder_);
+        }
+
+        /**
+         * Limit the time one FULLBUNDLE build spends (see BasicBundleBuilder::set_build_budget)
+         */
+        void set_build_budget(std::chrono::microseconds budget) {
+            std::visit([&](auto &builder) { builder.set_build_budget(budget); }, builder_);
+        }
+
+        std::chrono::microseconds get_build_budget() const {
+            return std::visit([](const auto &builder) { return builder.get_build_budget(); }, builder_);
+        }
+
+        /**
+         * Check if a paused fill will resume on the next call
+         */
+        bool is_building() const {
+            return std::visit([](const auto &builder) { return builder.is_building(); }, builder_);
+        }
+
+        /**
+         * Drop the paused fill and cached bids (see BasicBundleBuilder::reset)
+         */
+        void reset() {
+            std::visit([](auto &builder) { builder.reset(); }, builder_);
+        }
+
+        /**
+         * Get the bid cache (hit statistics, manual invalidation)
          */
-        size_t fill_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks);
+        BidCache &get_bid_cache() {
+            return std::visit([](auto &builder) -> BidCache & { return builder.get_bid_cache(); }, builder_);
+        }
+        const BidCache &get_bid_cache() const {
+            return std::visit([](const auto &builder) -> const BidCache & { return builder.get_bid_cache(); },
+                              builder_);
+        }
     };
 
 } // namespace consens::cbba
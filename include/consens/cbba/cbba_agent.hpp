@@ -3,8 +3,11 @@
 #include "../types.hpp"
 #include "bid.hpp"
 #include "bundle.hpp"
+#include "task_set.hpp"
 #include "types.hpp"
 
+#include <vector>
+
 namespace consens::cbba {
 
     /**
@@ -14,28 +17,65 @@ namespace consens::cbba {
      */
     class CBBAAgent {
       private:
+        /**
+         * Task handles taken with IdTable::acquire() through the TaskID overloads
+         * Released by reset_task() and on destruction; copies take their own references.
+         */
+        class HeldTasks {
+          private:
+            TaskSet tasks_;
+
+          public:
+            HeldTasks() = default;
+            HeldTasks(const HeldTasks &other);
+            HeldTasks(HeldTasks &&other) noexcept;
+            HeldTasks &operator=(HeldTasks other) noexcept;
+            ~HeldTasks();
+
+            /**
+             * Keep an acquired reference; drops it again if one is already held
+             */
+            void hold(TaskIndex task);
+
+            /**
+             * Release the reference to a task, if held
+             */
+            void release(TaskIndex task);
+        };
+
         // Agent identification
         AgentID id_;
+        AgentHandle handle_;
 
         // Current agent state (updated from simulator)
         Pose pose_;
         double velocity_;
 
         // CBBA state vectors
-        Bundle bundle_;                      // b: bundle (unordered tasks this agent claims)
-        Path path_;                          // p: path (ordered tasks to execute)
-        TaskBids winning_bids_;              // y: winning bid for each task
-        TaskWinners winners_;                // z: winning agent for each task
-        std::map<TaskID, Score> local_bids_; // c: my computed bids (marginal gains)
-        AgentTimestamps timestamps_;         // s: timestamps for each agent (for consensus)
+        // Per-task state is stored as parallel arrays indexed by TaskIndex, so a consensus
+        // pass over all tasks is a linear scan. Arrays grow on demand (see ensure_task)
+        Bundle bundle_;                         // b: bundle (unordered tasks this agent claims)
+        Path path_;                             // p: path (ordered tasks to execute)
+        std::vector<Score> bid_scores_;         // y: winning bid score for each task
+        std::vector<AgentIndex> winners_;       // z: winning agent for each task
+        std::vector<Timestamp> bid_timestamps_; // timestamp of the winning bid for each task
+        std::vector<Score> local_bids_;         // c: my computed bids (marginal gains)
+        AgentTimestamps timestamps_;            // s: timestamps for each agent (for consensus)
 
         // Convergence tracking
         bool converged_;
-        TaskWinners previous_winners_; // For detecting convergence
+        std::vector<AgentIndex> previous_winners_; // For detecting convergence
 
         // Configuration
         size_t bundle_capacity_;
 
+        HeldTasks held_; // Tasks this agent added by TaskID
+
+        /**
+         * Grow the state arrays so that task is a valid index
+         */
+        void ensure_task(TaskIndex task);
+
       public:
         /**
          * Constructor
@@ -61,17 +101,30 @@ namespace consens::cbba {
          * @param task_id Task to add
          * @param bid Bid value for this task
          * @param position Position in path to insert (default: end)
+         * @param direction Traversal of the task (default: head -> tail)
+         *
+         * The TaskID overload holds the task handle until reset_task(), so it is not
+         * recycled while this agent keeps state for it. All other TaskID overloads only
+         * look the task up, and do nothing for a task that is not known.
          */
-        void add_to_bundle(const TaskID &task_id, Score bid, size_t position = SIZE_MAX);
+        void add_to_bundle(TaskIndex task, Score bid, size_t position = SIZE_MAX,
+                           Direction direction = Direction::FORWARD);
+        void add_to_bundle(const TaskID &task_id, Score bid, size_t position = SIZE_MAX,
+                           Direction direction = Direction::FORWARD);
 
         /**
          * Remove a task from bundle and path
+         *
+         * Winning and local bids are kept, so a handle held by the TaskID overload of
+         * add_to_bundle() stays held until reset_task().
          */
+        void remove_from_bundle(TaskIndex task);
         void remove_from_bundle(const TaskID &task_id);
 
         /**
          * Insert task in path at specific position
          */
+        void insert_in_path(TaskIndex task, size_t position);
         void insert_in_path(const TaskID &task_id, size_t position);
 
         // ========== Bid Management ==========
@@ -79,22 +132,26 @@ namespace consens::cbba {
         /**
          * Update winning bid for a task
          */
+        void update_winning_bid(TaskIndex task, const Bid &bid);
         void update_winning_bid(const TaskID &task_id, const Bid &bid);
 
         /**
          * Reset a task (mark as unassigned)
          * Used in consensus when task is lost
          */
+        void reset_task(TaskIndex task);
         void reset_task(const TaskID &task_id);
 
         /**
          * Set local bid (computed marginal gain) for a task
          */
+        void set_local_bid(TaskIndex task, Score score);
         void set_local_bid(const TaskID &task_id, Score score);
 
         /**
          * Get local bid for a task
          */
+        Score get_local_bid(TaskIndex task) const;
         Score get_local_bid(const TaskID &task_id) const;
 
         // ========== Timestamp Management ==========
@@ -102,11 +159,13 @@ namespace consens::cbba {
         /**
          * Update timestamp for an agent (consensus protocol)
          */
+        void update_timestamp(AgentIndex agent, Timestamp ts);
         void update_timestamp(const AgentID &agent_id, Timestamp ts);
 
         /**
          * Get timestamp for an agent
          */
+        Timestamp get_timestamp(AgentIndex agent) const;
         Timestamp get_timestamp(const AgentID &agent_id) const;
 
         /**
@@ -130,6 +189,7 @@ namespace consens::cbba {
         // ========== Getters ==========
 
         const AgentID &get_id() const { return id_; }
+        AgentHandle get_handle() const { return handle_; }
         const Pose &get_pose() const { return pose_; }
         double get_velocity() const { return velocity_; }
 
@@ -139,11 +199,15 @@ namespace consens::cbba {
         const Path &get_path() const { return path_; }
         Path &get_path() { return path_; }
 
-        const TaskBids &get_winning_bids() const { return winning_bids_; }
-        TaskBids &get_winning_bids() { return winning_bids_; }
-
-        const TaskWinners &get_winners() const { return winners_; }
-        TaskWinners &get_winners() { return winners_; }
+        /**
+         * Per-task state arrays, indexed by TaskIndex
+         * All have length get_state_size(); unknown tasks hold (MIN_SCORE, NO_AGENT_INDEX, 0.0)
+         */
+        size_t get_state_size() const { return winners_.size(); }
+        const std::vector<Score> &get_bid_scores() const { return bid_scores_; }
+        const std::vector<AgentIndex> &get_winners() const { return winners_; }
+        const std::vector<Timestamp> &get_bid_timestamps() const { return bid_timestamps_; }
+        const std::vector<Score> &get_local_bids() const { return local_bids_; }
 
         const AgentTimestamps &get_timestamps() const { return timestamps_; }
         AgentTimestamps &get_timestamps() { return timestamps_; }
@@ -153,11 +217,13 @@ namespace consens::cbba {
         /**
          * Get winning bid for a specific task
          */
+        Bid get_winning_bid(TaskIndex task) const;
         Bid get_winning_bid(const TaskID &task_id) const;
 
         /**
          * Get winner for a specific task
          */
+        AgentHandle get_winner(TaskIndex task) const;
         AgentID get_winner(const TaskID &task_id) const;
     };
 
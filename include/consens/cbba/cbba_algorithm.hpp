@@ -7,9 +7,10 @@
 #include "consensus_resolver.hpp"
 #include "messages.hpp"
 #include "spatial_index.hpp"
+#include "task_set.hpp"
+#include "task_store.hpp"
 #include "types.hpp"
 
-#include <map>
 #include <memory>
 
 namespace consens::cbba {
@@ -32,12 +33,15 @@ namespace consens::cbba {
         void update_pose(const Pose &pose) override;
         void update_velocity(double velocity) override;
         void add_task(const Task &task) override;
+        void add_tasks(std::span<const Task> tasks) override;
         void remove_task(const TaskID &id) override;
         void mark_task_completed(const TaskID &id) override;
         void tick(float dt) override;
         std::vector<TaskID> get_bundle() const override;
         std::vector<TaskID> get_path() const override;
         std::optional<TaskID> get_next_task() const override;
+        std::vector<TaskStep> get_path_steps() const override;
+        std::optional<TaskStep> get_next_step() const override;
         std::optional<Task> get_task(const TaskID &id) const override;
         std::vector<Task> get_all_tasks() const override;
         bool has_converged() const override;
@@ -55,15 +59,16 @@ namespace consens::cbba {
         Pose pose_;
         double velocity_;
 
+        // Tasks (shared with the spatial index, so declared first)
+        TaskStore task_store_;
+        TaskSet available_; // Known, not completed; maintained on add/remove/complete
+
         // CBBA components
         CBBAAgent cbba_agent_;
         SpatialIndex spatial_index_;
         BundleBuilder bundle_builder_;
         ConsensusResolver consensus_resolver_;
 
-        // Tasks
-        std::map<TaskID, Task> tasks_;
-
         // State
         size_t iteration_count_;
         double current_time_;
@@ -74,9 +79,7 @@ namespace consens::cbba {
         void consensus_phase();
 
         // Helper methods
-        std::vector<TaskID> get_available_tasks() const;
         CBBAMessage create_message();
-        void update_spatial_index();
     };
 
 } // namespace consens::cbba
@@ -4,6 +4,7 @@
 #include "messages.hpp"
 #include "types.hpp"
 
+#include <cstdint>
 #include <vector>
 
 namespace consens::cbba {
@@ -11,10 +12,61 @@ namespace consens::cbba {
     /**
      * Consensus resolver implements the conflict resolution phase of CBBA
      * Applies UPDATE, RESET, and LEAVE rules based on neighbor messages
+     *
+     * Neighbors resend their full state every tick, but near convergence almost none of it changes.
+     * The resolver remembers, per sender and task, the entry it last resolved and the state it left
+     * the agent in; an entry that matches both is skipped, since resolving it again can only LEAVE.
+     * Consensus work then scales with the entries that changed rather than with tasks x neighbors.
+     *
+     * A message is walked as a merge-join: its bids, winners and timestamps are sorted by dense
+     * handle, so each is one linear stream, read against the agent's per-task arrays by index.
+     * Nothing is looked up and nothing is allocated per message once the per-sender state has grown.
+     *
+     * In BATCHED mode the messages of a tick are first reduced per task, in the same order and with
+     * the same rules, to the entry the agent would end up with; that entry is then written once, and
+     * a task lost along the way is reset once. The outcome matches SEQUENTIAL mode.
      */
     class ConsensusResolver {
+      private:
+        /**
+         * Last resolved entry of one sender for one task, with the agent's state right after it
+         */
+        struct SeenTask {
+            AgentIndex neighbor_winner = NO_AGENT_INDEX;
+            Score neighbor_score = MIN_SCORE;
+            Timestamp neighbor_timestamp = 0.0;
+            AgentIndex winner = NO_AGENT_INDEX;
+            Score score = MIN_SCORE;
+            Timestamp timestamp = 0.0;
+        };
+
+        /**
+         * Winning bid a task is reduced to within a batch (BATCHED mode)
+         */
+        struct PendingTask {
+            Bid bid;
+            bool touched = false; // Listed in touched_
+            bool lost = false;    // Lost by this agent at some point of the batch
+        };
+
+        /**
+         * Rule selected for one neighbor entry
+         */
+        enum class Rule : uint8_t {
+            LEAVE,  // Keep our information
+            UPDATE, // Take the neighbor's bid
+            RESET   // Take the neighbor's bid and drop the lost task from our bundle
+        };
+
+        ConsensusMode mode_;
+        std::vector<std::vector<SeenTask>> seen_; // Per sender AgentIndex, per TaskIndex
+        std::vector<PendingTask> pending_;        // Per TaskIndex (BATCHED mode)
+        std::vector<TaskIndex> touched_;          // Tasks with a pending entry
+        size_t resolved_ = 0;
+        size_t updates_ = 0;
+
       public:
-        ConsensusResolver() = default;
+        explicit ConsensusResolver(ConsensusMode mode = ConsensusMode::SEQUENTIAL) : mode_(mode) {}
         ~ConsensusResolver() = default;
 
         /**
@@ -26,6 +78,35 @@ namespace consens::cbba {
          */
         void resolve_conflicts(CBBAAgent &agent, const std::vector<CBBAMessage> &neighbor_messages);
 
+        /**
+         * Set how the messages of one call are applied
+         */
+        void set_mode(ConsensusMode mode) { mode_ = mode; }
+
+        ConsensusMode get_mode() const { return mode_; }
+
+        /**
+         * Task conflicts resolved so far; skipped entries are not counted (for monitoring and tests)
+         */
+        size_t resolved() const { return resolved_; }
+
+        /**
+         * Winning bids written to agents so far (for monitoring and tests)
+         */
+        size_t updates() const { return updates_; }
+
+        /**
+         * Forget what any sender last sent for a task
+         * Call when the task is removed, before its handle can be recycled.
+         */
+        void forget_task(TaskIndex task);
+
+        /**
+         * Forget what every sender last sent, so their next entries are all applied
+         * Call when the agent's state is reset.
+         */
+        void forget_all() { seen_.clear(); }
+
       private:
         /**
          * Process a single message from a neighbor
@@ -35,25 +116,46 @@ namespace consens::cbba {
          */
         void process_message(CBBAAgent &agent, const CBBAMessage &msg);
 
+        /**
+         * Reduce all messages per task, then apply the outcome once (BATCHED mode)
+         *
+         * @param agent Agent state to update
+         * @param neighbor_messages Messages received from neighboring agents
+         */
+        void process_batch(CBBAAgent &agent, const std::vector<CBBAMessage> &neighbor_messages);
+
         /**
          * Resolve conflict for a specific task
          * Applies CBBA consensus rules (UPDATE/RESET/LEAVE)
          *
          * @param agent Agent state
-         * @param msg Neighbor's message
-         * @param task_id Task to resolve conflict for
+         * @param task Task to resolve conflict for
+         * @param neighbor_bid Neighbor's winning bid for the task
+         * @param neighbor_winner Neighbor's winner for the task
+         */
+        void resolve_task_conflict(CBBAAgent &agent, TaskIndex task, const Bid &neighbor_bid,
+                                   AgentHandle neighbor_winner);
+
+        /**
+         * Select the CBBA consensus rule for one task
+         *
+         * @param my_bid Our winning bid for the task
+         * @param neighbor_bid Neighbor's winning bid for the task
+         * @param neighbor_winner Neighbor's winner for the task
+         * @param self Handle of our agent
          */
-        void resolve_task_conflict(CBBAAgent &agent, const CBBAMessage &msg, const TaskID &task_id);
+        static Rule select_rule(const Bid &my_bid, const Bid &neighbor_bid, AgentHandle neighbor_winner,
+                                AgentHandle self);
 
         /**
          * UPDATE rule: Accept neighbor's information
          * Called when neighbor has better or newer information
          *
          * @param agent Agent state
-         * @param msg Neighbor's message
-         * @param task_id Task to update
+         * @param task Task to update
+         * @param neighbor_bid Neighbor's winning bid for the task
          */
-        void apply_update_rule(CBBAAgent &agent, const CBBAMessage &msg, const TaskID &task_id);
+        void apply_update_rule(CBBAAgent &agent, TaskIndex task, const Bid &neighbor_bid);
 
         /**
          * RESET rule: Lost task, remove from bundle
@@ -61,9 +163,9 @@ namespace consens::cbba {
          * Also resets all tasks after this one in path
          *
          * @param agent Agent state
-         * @param task_id Task that was lost
+         * @param task Task that was lost
          */
-        void apply_reset_rule(CBBAAgent &agent, const TaskID &task_id);
+        void apply_reset_rule(CBBAAgent &agent, TaskIndex task);
 
         /**
          * LEAVE rule: No conflict, maintain current state
@@ -79,21 +181,34 @@ namespace consens::cbba {
          *
          * @param agent Agent state
          * @param msg Neighbor's message
+         * @param sender Handle of the message's sender
          */
-        void update_timestamps(CBBAAgent &agent, const CBBAMessage &msg);
+        void update_timestamps(CBBAAgent &agent, const CBBAMessage &msg, AgentIndex sender);
 
         /**
          * Check if agent i's information about agent k is outdated
          * compared to neighbor j's information
          *
-         * @param agent Agent i
-         * @param neighbor_id Agent j (neighbor)
-         * @param other_agent_id Agent k (third agent)
+         * @param my_ts Agent i's timestamp for k (0 if unknown)
          * @param neighbor_ts Agent j's timestamp for k
          * @return True if j has newer information about k
          */
-        bool has_newer_info(const CBBAAgent &agent, const AgentID &neighbor_id, const AgentID &other_agent_id,
-                            Timestamp neighbor_ts) const;
+        bool has_newer_info(Timestamp my_ts, Timestamp neighbor_ts) const;
+
+        /**
+         * Entries last resolved from a sender (grown to cover task)
+         */
+        SeenTask &seen_task(AgentIndex sender, TaskIndex task);
+
+        /**
+         * Check if a sender's entry and our bid for a task are as left by the last resolve
+         */
+        static bool is_unchanged(const SeenTask &seen, const Bid &my_bid, const Bid &bid);
+
+        /**
+         * Remember a sender's entry and our bid for a task after resolving it
+         */
+        static void remember(SeenTask &seen, const Bid &my_bid, const Bid &bid);
     };
 
 } // namespace consens::cbba
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Runs independent jobs in parallel (injected into BasicBundleBuilder, not owned)
+     */
+    class Executor {
+      public:
+        virtual ~Executor() = default;
+
+        /**
+         * Number of jobs that can run at once (including the calling thread)
+         */
+        virtual size_t concurrency() const = 0;
+
+        /**
+         * Call job(i) for every i in [0, count) and return once all calls finished
+         * Calls may run concurrently and in any order; job must not throw.
+         */
+        virtual void parallel_for(size_t count, const std::function<void(size_t)> &job) = 0;
+    };
+
+    /**
+     * Executor backed by a fixed set of worker threads
+     *
+     * Workers are started once and sleep between calls; the calling thread works along. Calls from
+     * several threads are serialised, so one pool can be shared by the builders of many agents.
+     * A job must not call parallel_for on the pool running it.
+     */
+    class ThreadPool final : public Executor {
+      private:
+        std::vector<std::thread> workers_;
+        std::mutex submit_mutex_; // Held for a whole parallel_for call
+        std::mutex mutex_;        // Guards the fields below
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(size_t)> *job_;
+        size_t count_;
+        std::atomic<size_t> next_; // Next unclaimed job index
+        size_t busy_;              // Workers still inside the current call
+        uint64_t generation_;      // Bumped once per call
+        bool stopping_;
+
+      public:
+        /**
+         * Constructor
+         * @param concurrency Total number of threads including the caller (0 = hardware concurrency)
+         */
+        explicit ThreadPool(size_t concurrency = 0);
+        ~ThreadPool() override;
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        size_t concurrency() const override { return workers_.size() + 1; }
+
+        void parallel_for(size_t count, const std::function<void(size_t)> &job) override;
+
+      private:
+        void worker_loop();
+
+        /**
+         * Claim and run job indices until none are left
+         */
+        void drain(const std::function<void(size_t)> &job, size_t count);
+    };
+
+} // namespace consens::cbba
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Interning table mapping string IDs to dense integer handles
+     *
+     * Handles are assigned densely starting at 0. The empty string maps to INVALID_INDEX.
+     * A handle obtained from intern() is never reused, so it (and the reference returned by
+     * name()) stays valid for the lifetime of the process. A handle obtained from acquire()
+     * is reference counted instead: once every holder released it, and nobody interned it,
+     * the ID is forgotten and the handle goes to the next new ID.
+     *
+     * String IDs are only needed at the API boundary; everything inside the CBBA
+     * implementation works on handles, and per-task state is sized by the largest handle.
+     * TaskStore acquires the tasks it holds, so the task table (and that state) is bounded by
+     * the tasks alive at once rather than by every task ever seen. Task IDs from the network
+     * go through find(), so a peer cannot add tasks; agent IDs from the network (senders,
+     * winners) are interned, so the agent table grows with the agents met.
+     *
+     * Entries live in chunks that never move, so name() and less() read a live handle without
+     * taking the lock; only the string -> handle map and reference counts are locked.
+     */
+    class IdTable {
+      private:
+        struct Entry {
+            std::string name;
+            uint64_t prefix = 0; // First 8 bytes of name, big-endian and zero-padded (see less())
+            uint32_t refs = 0;   // acquire() minus release()
+            bool pinned = false; // Interned: never recycled
+        };
+
+        // Chunk k holds FIRST_CHUNK << k entries; 27 chunks cover every 32-bit handle
+        static constexpr uint32_t FIRST_CHUNK = 64;
+        static constexpr size_t CHUNK_COUNT = 27;
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, uint32_t> indices_;
+        std::array<std::atomic<Entry *>, CHUNK_COUNT> chunks_{};
+        std::atomic<uint32_t> size_{0};
+        std::vector<uint32_t> free_; // Released handles, reused before growing
+
+      public:
+        IdTable() = default;
+        ~IdTable();
+        IdTable(const IdTable &) = delete;
+        IdTable &operator=(const IdTable &) = delete;
+
+        /**
+         * Get handle for an ID, assigning a new one if the ID is not known yet
+         * The handle is never recycled.
+         */
+        uint32_t intern(const std::string &id);
+
+        /**
+         * Get handle for an ID like intern(), and hold a reference to it
+         * Each call must be matched by one release().
+         */
+        uint32_t acquire(const std::string &id);
+
+        /**
+         * Drop a reference taken by acquire()
+         * The last release of a handle that was never interned recycles it: the handle
+         * must not be used afterwards.
+         */
+        void release(uint32_t index);
+
+        /**
+         * Get handle for an ID without assigning one
+         * @return Handle, or INVALID_INDEX if the ID was never interned
+         */
+        uint32_t find(const std::string &id) const;
+
+        /**
+         * Get the string ID for a handle (lock-free)
+         * @return ID, or an empty string for INVALID_INDEX
+         */
+        const std::string &name(uint32_t index) const;
+
+        /**
+         * Check if the ID of one handle sorts before the ID of another (lock-free)
+         * Same result as name(a) < name(b), with INVALID_INDEX as the empty string, but IDs
+         * that differ in their first 8 bytes are told apart by a precomputed integer.
+         */
+        bool less(uint32_t a, uint32_t b) const;
+
+        /**
+         * One past the largest handle ever assigned
+         */
+        size_t size() const;
+
+      private:
+        /**
+         * Get the handle of an ID, taking a free one if it is new (caller holds the lock)
+         */
+        uint32_t assign(const std::string &id);
+
+        /**
+         * Entry of an assigned handle
+         */
+        Entry &entry(uint32_t index) const;
+    };
+
+    /**
+     * Process-wide table for task IDs
+     */
+    IdTable &task_ids();
+
+    /**
+     * Process-wide table for agent IDs
+     */
+    IdTable &agent_ids();
+
+    /**
+     * Agent handle stored in bids and winner vectors
+     * Trivially copyable; converts from AgentID at the API boundary
+     */
+    class AgentHandle {
+      private:
+        AgentIndex index_;
+
+      public:
+        AgentHandle() : index_(NO_AGENT_INDEX) {}
+        AgentHandle(const AgentID &id) : index_(agent_ids().intern(id)) {}
+        AgentHandle(const char *id) : AgentHandle(AgentID(id)) {}
+        explicit AgentHandle(AgentIndex index) : index_(index) {}
+
+        AgentIndex index() const { return index_; }
+        const AgentID &name() const { return agent_ids().name(index_); }
+        bool is_valid() const { return index_ != NO_AGENT_INDEX; }
+
+        bool operator==(const AgentHandle &other) const { return index_ == other.index_; }
+        bool operator==(const AgentID &id) const { return name() == id; }
+        bool operator==(const char *id) const { return name() == id; }
+    };
+
+} // namespace consens::cbba
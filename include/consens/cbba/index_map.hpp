@@ -0,0 +1,136 @@
+#pragma once
+
+#include "id_table.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Flat map keyed by dense handle
+     * Entries are kept sorted by handle in one contiguous vector, so iteration is a
+     * linear scan and lookups are a binary search (no string compares, no node chasing).
+     * The string overloads intern/look up through Table and are meant for the API boundary.
+     *
+     * @tparam Value Mapped type
+     * @tparam Table Interning table for the key space (task_ids or agent_ids)
+     */
+    template <typename Value, IdTable &(*Table)()> class IndexMap {
+      public:
+        using value_type = std::pair<uint32_t, Value>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+      private:
+        std::vector<value_type> entries_;
+
+        const_iterator lower_bound(uint32_t index) const {
+            return std::lower_bound(entries_.begin(), entries_.end(), index,
+                                    [](const value_type &entry, uint32_t key) { return entry.first < key; });
+        }
+
+        iterator lower_bound(uint32_t index) {
+            return std::lower_bound(entries_.begin(), entries_.end(), index,
+                                    [](const value_type &entry, uint32_t key) { return entry.first < key; });
+        }
+
+      public:
+        IndexMap() = default;
+
+        /**
+         * Access entry for a handle, default-constructing it if missing
+         */
+        Value &operator[](uint32_t index) {
+            auto it = lower_bound(index);
+            if (it == entries_.end() || it->first != index) {
+                it = entries_.insert(it, value_type(index, Value()));
+            }
+            return it->second;
+        }
+
+        /**
+         * Access entry for a string ID (interned on first use)
+         */
+        Value &operator[](const std::string &id) { return (*this)[Table().intern(id)]; }
+
+        /**
+         * Find entry for a handle
+         * @return Pointer to value, or nullptr if missing
+         */
+        const Value *find(uint32_t index) const {
+            auto it = lower_bound(index);
+            if (it != entries_.end() && it->first == index) {
+                return &it->second;
+            }
+            return nullptr;
+        }
+
+        Value *find(uint32_t index) {
+            auto it = lower_bound(index);
+            if (it != entries_.end() && it->first == index) {
+                return &it->second;
+            }
+            return nullptr;
+        }
+
+        /**
+         * Find entry for a string ID (does not intern)
+         */
+        const Value *find(const std::string &id) const { return find(Table().find(id)); }
+
+        bool contains(uint32_t index) const { return find(index) != nullptr; }
+
+        /**
+         * Insert an entry in front of position, which must keep the entries sorted
+         * Lets a merge over the sorted entries add missing handles without a search
+         * @return Iterator to the inserted entry
+         */
+        iterator insert(iterator position, uint32_t index, Value value) {
+            return entries_.insert(position, value_type(index, std::move(value)));
+        }
+
+        /**
+         * Remove entry for a handle (no-op if missing)
+         */
+        void erase(uint32_t index) {
+            auto it = lower_bound(index);
+            if (it != entries_.end() && it->first == index) {
+                entries_.erase(it);
+            }
+        }
+
+        /**
+         * Replace all entries
+         * Input may be unsorted; later duplicates win
+         */
+        void assign(std::vector<value_type> entries) {
+            std::stable_sort(entries.begin(), entries.end(),
+                             [](const value_type &a, const value_type &b) { return a.first < b.first; });
+            entries_.clear();
+            entries_.reserve(entries.size());
+            for (auto &entry : entries) {
+                if (!entries_.empty() && entries_.back().first == entry.first) {
+                    entries_.back().second = std::move(entry.second);
+                } else {
+                    entries_.push_back(std::move(entry));
+                }
+            }
+        }
+
+        void clear() { entries_.clear(); }
+        void reserve(size_t count) { entries_.reserve(count); }
+        size_t size() const { return entries_.size(); }
+        bool empty() const { return entries_.empty(); }
+
+        iterator begin() { return entries_.begin(); }
+        iterator end() { return entries_.end(); }
+        const_iterator begin() const { return entries_.begin(); }
+        const_iterator end() const { return entries_.end(); }
+
+        bool operator==(const IndexMap &other) const { return entries_ == other.entries_; }
+    };
+
+} // namespace consens::cbba
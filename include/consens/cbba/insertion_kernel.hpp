@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../task.hpp"
+#include "types.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * One insertion slot of a path (see PathProfile)
+     */
+    struct InsertionEdge {
+        Point prev;         // Agent position before the slot
+        Point next;         // Entry point of the task after the slot (unused for the append slot)
+        double weight;      // 1 if a task follows the slot, 0 for the append slot
+        double bypass_time; // Travel time prev -> next (0 for the append slot)
+    };
+
+    /**
+     * Instruction set used by the batch insertion kernel
+     */
+    enum class SimdLevel {
+        SCALAR, // Portable loop
+        AVX2,   // 4 candidates per instruction
+        AVX512  // 8 candidates per instruction
+    };
+
+    /**
+     * Candidates scored together against one path, in structure-of-arrays layout
+     *
+     * compute_insertion_costs fills the two slot-major matrices (slot * size() + candidate):
+     *   reach = travel(prev -> entry) + duration
+     *   delay = reach + travel(exit -> next) - travel(prev -> next)
+     * i.e. the time to complete the candidate from the slot, and how much later every
+     * following path task finishes. Every instruction set gives bit-identical results,
+     * computed in the same operation order as the scalar scorer.
+     *
+     * Candidates are traversed in `direction`; reverse() flips all of them at once, so
+     * geometric tasks can be scored both ways with the same kernel.
+     */
+    struct InsertionBatch {
+        std::vector<TaskIndex> tasks;
+        std::vector<double> entry_x, entry_y, exit_x, exit_y, duration;
+        std::vector<double> reach, delay;
+        Direction direction = Direction::FORWARD;
+        size_t geometric = 0; // Candidates whose entry and exit differ
+
+        /**
+         * Append a candidate
+         */
+        void add(TaskIndex task, const Task &data) {
+            const Point &entry = data.get_entry(direction);
+            const Point &exit = data.get_exit(direction);
+            geometric += data.has_geometry() ? 1 : 0;
+            tasks.push_back(task);
+            entry_x.push_back(entry.x);
+            entry_y.push_back(entry.y);
+            exit_x.push_back(exit.x);
+            exit_y.push_back(exit.y);
+            duration.push_back(data.get_duration());
+        }
+
+        /**
+         * Replace the candidates by `count` candidates of another batch starting at `first`
+         * (cost matrices are not copied)
+         */
+        void assign(const InsertionBatch &source, size_t first, size_t count) {
+            auto slice = [&](auto &to, const auto &from) {
+                to.assign(from.begin() + first, from.begin() + first + count);
+            };
+            slice(tasks, source.tasks);
+            slice(entry_x, source.entry_x);
+            slice(entry_y, source.entry_y);
+            slice(exit_x, source.exit_x);
+            slice(exit_y, source.exit_y);
+            slice(duration, source.duration);
+            direction = source.direction;
+            geometric = 0;
+            for (size_t i = 0; i < count; i++) {
+                geometric += (entry_x[i] != exit_x[i] || entry_y[i] != exit_y[i]) ? 1 : 0;
+            }
+        }
+
+        size_t size() const { return tasks.size(); }
+        bool empty() const { return tasks.empty(); }
+
+        /**
+         * Swap entry and exit of every candidate (O(1))
+         */
+        void reverse() {
+            entry_x.swap(exit_x);
+            entry_y.swap(exit_y);
+            direction = direction == Direction::FORWARD ? Direction::REVERSE : Direction::FORWARD;
+        }
+
+        /**
+         * Remove all candidates (keeps capacity)
+         */
+        void clear() {
+            tasks.clear();
+            entry_x.clear();
+            entry_y.clear();
+            exit_x.clear();
+            exit_y.clear();
+            duration.clear();
+            direction = Direction::FORWARD;
+            geometric = 0;
+        }
+    };
+
+    /**
+     * Best instruction set supported by this CPU (detected once)
+     */
+    SimdLevel detect_simd_level();
+
+    /**
+     * Check if an instruction set can run on this CPU
+     */
+    bool simd_supported(SimdLevel level);
+
+    /**
+     * Fill batch.reach and batch.delay for every (slot, candidate) pair
+     * Vectorised across candidates; slot values are broadcast.
+     *
+     * @param edges Insertion slots of the path
+     * @param velocity Agent velocity (m/s, > 0)
+     * @param batch Candidates; output matrices are resized to edges.size() * batch.size()
+     * @param level Instruction set (must be supported; defaults to the best available)
+     */
+    void compute_insertion_costs(std::span<const InsertionEdge> edges, double velocity, InsertionBatch &batch,
+                                 SimdLevel level = detect_simd_level());
+
+} // namespace consens::cbba
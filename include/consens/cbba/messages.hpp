@@ -10,6 +10,8 @@
 
 namespace consens::cbba {
 
+    class TaskStore; // task_store.hpp
+
     /**
      * CBBA message structure for inter-agent communication
      * Contains all information needed for consensus resolution
@@ -49,41 +51,53 @@ namespace consens::cbba {
         /**
          * Deserialize message from binary format
          * Returns true if successful, false if data is invalid
+         * Task IDs are looked up, not interned: entries naming a task unknown to this process
+         * are dropped. Agent IDs are interned.
+         *
+         * @param tasks If set, entries for tasks not in this store are dropped as well, so a
+         *              receiver never picks up state for a task it removed (whose handle may
+         *              be recycled once no store holds it)
          */
-        bool deserialize(const std::vector<uint8_t> &data);
+        bool deserialize(const std::vector<uint8_t> &data, const TaskStore *tasks = nullptr);
 
         /**
          * Get winning bid for a specific task
          */
-        Bid get_winning_bid(const TaskID &task_id) const {
-            auto it = winning_bids.find(task_id);
-            if (it != winning_bids.end()) {
-                return it->second;
+        Bid get_winning_bid(TaskIndex task) const {
+            const Bid *bid = winning_bids.find(task);
+            if (bid) {
+                return *bid;
             }
             return Bid::invalid();
         }
 
+        Bid get_winning_bid(const TaskID &task_id) const { return get_winning_bid(task_ids().find(task_id)); }
+
         /**
          * Get winner for a specific task
          */
-        AgentID get_winner(const TaskID &task_id) const {
-            auto it = winners.find(task_id);
-            if (it != winners.end()) {
-                return it->second;
+        AgentHandle get_winner(TaskIndex task) const {
+            const AgentHandle *winner = winners.find(task);
+            if (winner) {
+                return *winner;
             }
-            return NO_AGENT;
+            return AgentHandle();
         }
 
+        AgentID get_winner(const TaskID &task_id) const { return get_winner(task_ids().find(task_id)).name(); }
+
         /**
          * Get timestamp for a specific agent
          */
-        Timestamp get_timestamp(const AgentID &agent_id) const {
-            auto it = timestamps.find(agent_id);
-            if (it != timestamps.end()) {
-                return it->second;
+        Timestamp get_timestamp(AgentIndex agent) const {
+            const Timestamp *ts = timestamps.find(agent);
+            if (ts) {
+                return *ts;
             }
             return 0.0;
         }
+
+        Timestamp get_timestamp(const AgentID &agent_id) const { return get_timestamp(agent_ids().find(agent_id)); }
     };
 
 } // namespace consens::cbba
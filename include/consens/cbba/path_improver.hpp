@@ -0,0 +1,247 @@
+#pragma once
+
+#include "cbba_agent.hpp"
+#include "scorer.hpp"
+#include "spatial_index.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Local search over the order of an agent's path (2-opt and Or-opt moves)
+     *
+     * Greedy insertion never reorders the path, so long bundles pick up crossing legs. Each run
+     * applies improving moves until none is left or the time budget runs out:
+     *   2-opt:  reverse a run of tasks (flipping their directions); a run of one flips a geometric task
+     *   Or-opt: move a run of up to three tasks to another gap, in either orientation
+     * Moves are scored with BasicTaskScorer::evaluate_splice against a profile of the current path.
+     * Only the path order changes: bundle, local bids and winning bids are left as published, so
+     * no bid is ever raised. A path that ended a run at a local optimum is skipped until it, the
+     * agent position or the velocity changes. Paths holding tasks missing from the index are left alone.
+     */
+    class PathImprover {
+      private:
+        // Or-opt moves runs of up to this many tasks
+        static constexpr size_t MAX_SEGMENT = 3;
+
+        // Relative score gain a move needs (keeps rounding noise from cycling moves)
+        static constexpr double MIN_RELATIVE_GAIN = 1e-9;
+
+        std::chrono::microseconds budget_;
+        std::chrono::steady_clock::time_point deadline_;
+        bool expired_;
+        PathProfile profile_;
+        std::vector<PathStep> steps_;
+
+        // State of the last path left at a local optimum
+        uint64_t settled_version_;
+        Point settled_position_;
+        double settled_velocity_;
+
+        size_t moves_;
+
+      public:
+        /**
+         * Constructor
+         * @param budget Time spent per run (0 = disabled)
+         */
+        explicit PathImprover(std::chrono::microseconds budget = std::chrono::microseconds(0))
+            : budget_(budget), expired_(false), settled_version_(0), settled_velocity_(0.0), moves_(0) {}
+
+        /**
+         * Improve the order of an agent's path
+         * @param agent Agent whose path is reordered
+         * @param scorer Scorer defining the path score
+         * @param spatial_index Spatial index for looking up tasks
+         * @return Number of moves applied
+         */
+        template <ScoringPolicy Policy>
+        size_t improve(CBBAAgent &agent, const BasicTaskScorer<Policy> &scorer, const SpatialIndex &spatial_index);
+
+        /**
+         * Set the time spent per run (0 = disabled)
+         */
+        void set_budget(std::chrono::microseconds budget) { budget_ = budget; }
+
+        std::chrono::microseconds get_budget() const { return budget_; }
+
+        bool enabled() const { return budget_.count() > 0; }
+
+        /**
+         * Moves applied so far (for monitoring and tests)
+         */
+        size_t moves() const { return moves_; }
+
+      private:
+        /**
+         * Apply the first improving 2-opt move
+         */
+        template <ScoringPolicy Policy>
+        bool apply_two_opt(Path &path, const BasicTaskScorer<Policy> &scorer, const SpatialIndex &spatial_index);
+
+        /**
+         * Apply the first improving Or-opt move
+         */
+        template <ScoringPolicy Policy>
+        bool apply_or_opt(Path &path, const BasicTaskScorer<Policy> &scorer, const SpatialIndex &spatial_index);
+
+        /**
+         * Check if steps_ in place of tasks [first, last) beats the profiled path (false once out of time)
+         */
+        template <ScoringPolicy Policy>
+        bool improves(const BasicTaskScorer<Policy> &scorer, size_t first, size_t last,
+                      const SpatialIndex &spatial_index);
+
+        /**
+         * Append tasks [first, last) of the profiled path to steps_ (reversed: back to front, flipped)
+         */
+        void append_steps(size_t first, size_t last, bool reversed);
+
+        bool is_settled(const CBBAAgent &agent) const {
+            return agent.get_path().version() == settled_version_ && agent.get_pose().position == settled_position_ &&
+                   agent.get_velocity() == settled_velocity_;
+        }
+
+        void settle(const CBBAAgent &agent) {
+            settled_version_ = agent.get_path().version();
+            settled_position_ = agent.get_pose().position;
+            settled_velocity_ = agent.get_velocity();
+        }
+    };
+
+    template <ScoringPolicy Policy>
+    size_t PathImprover::improve(CBBAAgent &agent, const BasicTaskScorer<Policy> &scorer,
+                                 const SpatialIndex &spatial_index) {
+        Path &path = agent.get_path();
+        if (!enabled() || path.size() < 2 || is_settled(agent)) {
+            return 0;
+        }
+
+        deadline_ = std::chrono::steady_clock::now() + budget_;
+        expired_ = false;
+
+        // Slots and path positions coincide only if every path task is indexed
+        scorer.compute_path_profile(agent, path, spatial_index, profile_);
+        if (profile_.tasks.size() != path.size()) {
+            settle(agent);
+            return 0;
+        }
+
+        // Moves change the path only when they are applied, so its version (and the bid cache)
+        // survives a run that finds nothing
+        size_t applied = 0;
+        while (apply_two_opt(path, scorer, spatial_index) || apply_or_opt(path, scorer, spatial_index)) {
+            applied++;
+            scorer.compute_path_profile(agent, path, spatial_index, profile_);
+        }
+        moves_ += applied;
+
+        if (!expired_) {
+            settle(agent);
+        }
+        return applied;
+    }
+
+    template <ScoringPolicy Policy>
+    bool PathImprover::apply_two_opt(Path &path, const BasicTaskScorer<Policy> &scorer,
+                                     const SpatialIndex &spatial_index) {
+        size_t count = profile_.tasks.size();
+        for (size_t first = 0; first < count && !expired_; first++) {
+            for (size_t last = first + 1; last <= count; last++) {
+                // Reversing a single point task changes nothing
+                if (last == first + 1 && !spatial_index.find_task(profile_.tasks[first])->has_geometry()) {
+                    continue;
+                }
+                steps_.clear();
+                append_steps(first, last, true);
+                if (improves(scorer, first, last, spatial_index)) {
+                    path.reverse(first, last);
+                    return true;
+                }
+                if (expired_) {
+                    return false;
+                }
+            }
+        }
+        return false;
+    }
+
+    template <ScoringPolicy Policy>
+    bool PathImprover::apply_or_opt(Path &path, const BasicTaskScorer<Policy> &scorer,
+                                    const SpatialIndex &spatial_index) {
+        size_t count = profile_.tasks.size();
+        for (size_t length = 1; length <= MAX_SEGMENT && length < count; length++) {
+            for (size_t first = 0; first + length <= count; first++) {
+                size_t last = first + length;
+
+                // A single point task reads the same both ways
+                bool flippable = length > 1 || spatial_index.find_task(profile_.tasks[first])->has_geometry();
+
+                // Gap g is in front of task g; the gaps next to the segment leave it in place
+                for (size_t gap = 0; gap <= count; gap++) {
+                    if (gap >= first && gap <= last) {
+                        continue;
+                    }
+                    for (int reversed = 0; reversed <= (flippable ? 1 : 0); reversed++) {
+                        steps_.clear();
+                        if (gap < first) {
+                            append_steps(first, last, reversed);
+                            append_steps(gap, first, false);
+                        } else {
+                            append_steps(last, gap, false);
+                            append_steps(first, last, reversed);
+                        }
+
+                        if (improves(scorer, std::min(gap, first), std::max(gap, last), spatial_index)) {
+                            if (reversed) {
+                                path.reverse(first, last);
+                            }
+                            if (gap < first) {
+                                path.rotate(gap, first, last);
+                            } else {
+                                path.rotate(first, last, gap);
+                            }
+                            return true;
+                        }
+                        if (expired_) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    template <ScoringPolicy Policy>
+    bool PathImprover::improves(const BasicTaskScorer<Policy> &scorer, size_t first, size_t last,
+                                const SpatialIndex &spatial_index) {
+        if (std::chrono::steady_clock::now() >= deadline_) {
+            expired_ = true;
+            return false;
+        }
+        Score current = profile_.score.back();
+        Score candidate = scorer.evaluate_splice(profile_, first, last, steps_, spatial_index);
+        return candidate - current > MIN_RELATIVE_GAIN * (1.0 + std::abs(current));
+    }
+
+    inline void PathImprover::append_steps(size_t first, size_t last, bool reversed) {
+        if (!reversed) {
+            for (size_t i = first; i < last; i++) {
+                steps_.push_back(PathStep{profile_.tasks[i], profile_.directions[i]});
+            }
+            return;
+        }
+        for (size_t i = last; i-- > first;) {
+            steps_.push_back(PathStep{profile_.tasks[i], opposite(profile_.directions[i])});
+        }
+    }
+
+} // namespace consens::cbba
@@ -3,27 +3,53 @@
 #include "../task.hpp"
 #include "bundle.hpp"
 #include "cbba_agent.hpp"
+#include "insertion_kernel.hpp"
+#include "scoring_policy.hpp"
 #include "spatial_index.hpp"
+#include "travel_cost.hpp"
 #include "types.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
 namespace consens::cbba {
 
     /**
      * Task scorer for computing utilities in CBBA
-     * Implements various scoring metrics (RPT, TDR)
+     * The metric is a compile-time policy (see ScoringPolicy), so insertion loops carry no
+     * metric dispatch; TaskScorer wraps the built-in policies behind the Metric enum.
+     *
+     * @tparam Policy Scoring policy (RptPolicy, TdrPolicy or user-defined)
      */
-    class TaskScorer {
+    template <ScoringPolicy Policy> class BasicTaskScorer {
       private:
-        Metric metric_;
-        double lambda_; // Discount factor for TDR metric
+        /**
+         * Path profile kept for the overloads that take none, with the inputs it was built from
+         */
+        struct ProfileScratch {
+            PathProfile profile;
+            uint64_t path_version = 0; // Path::version() starts at 1, so 0 never matches
+            const SpatialIndex *spatial_index = nullptr;
+            uint64_t index_revision = 0;
+            Point position;
+            double velocity = 0.0;
+        };
+
+        Policy policy_;
+        TravelCostCache *travel_costs_; // Not owned; nullptr = straight-line travel
+        mutable ProfileScratch scratch_;
 
       public:
         /**
          * Constructor
-         * @param metric Scoring metric to use (default: RPT)
-         * @param lambda Discount factor for TDR (default: 0.95)
+         * @param policy Scoring policy (with its parameters)
          */
-        explicit TaskScorer(Metric metric = Metric::RPT, double lambda = 0.95);
+        explicit BasicTaskScorer(Policy policy = Policy()) : policy_(std::move(policy)), travel_costs_(nullptr) {}
 
         /**
          * Compute marginal gain of adding a task to the path
@@ -34,10 +60,15 @@ namespace consens::cbba {
          * @param current_path Current path
          * @param insertion_pos Position to insert task in path
          * @param spatial_index Spatial index for looking up tasks
+         * @param direction Traversal of the inserted task
          * @return Marginal utility (score) of adding this task
          */
         Score compute_marginal_gain(const CBBAAgent &agent, const Task &task, const Path &current_path,
-                                    size_t insertion_pos, const SpatialIndex &spatial_index) const;
+                                    size_t insertion_pos, const SpatialIndex &spatial_index,
+                                    Direction direction = Direction::FORWARD) const;
+        Score compute_marginal_gain(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                    size_t insertion_pos, const SpatialIndex &spatial_index,
+                                    Direction direction = Direction::FORWARD) const;
 
         /**
          * Evaluate the score of an entire path
@@ -51,37 +82,180 @@ namespace consens::cbba {
 
         /**
          * Find optimal insertion position for a task in the path
-         * Tries all positions and returns the one with best marginal gain
+         * Tries all positions, and both directions of geometric tasks, and returns the one with
+         * best marginal gain (ties keep the forward direction, then the earliest position);
+         * local policies are scored in closed form in one O(L) pass with no allocation
          *
          * @param agent Agent state
          * @param task Task to insert
          * @param current_path Current path
          * @param spatial_index Spatial index for looking up tasks
-         * @return Pair of (best_score, best_position)
+         * @return Best insertion (score, position, direction)
+         *
+         * Non-local policies score against a path profile that is kept between calls and only
+         * rebuilt when the path, the index, or the agent position or velocity changed, so one
+         * scorer must not run these overloads (or compute_marginal_gain) concurrently.
          */
-        std::pair<Score, size_t> find_optimal_insertion(const CBBAAgent &agent, const Task &task,
-                                                        const Path &current_path,
-                                                        const SpatialIndex &spatial_index) const;
+        Insertion find_optimal_insertion(const CBBAAgent &agent, const Task &task, const Path &current_path,
+                                         const SpatialIndex &spatial_index) const;
+        Insertion find_optimal_insertion(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                         const SpatialIndex &spatial_index) const;
 
         /**
-         * Get current metric
+         * Find optimal insertion position against a precomputed path profile
+         * O(L) per task; callers scoring many tasks against the same path build the profile
+         * once with compute_path_profile
+         *
+         * @param agent Agent state
+         * @param task Task to insert
+         * @param current_path Current path (the profile must have been built from it)
+         * @param profile Result of compute_path_profile for current_path
+         * @param spatial_index Spatial index for looking up tasks
+         * @return Best insertion (score, position, direction)
          */
-        Metric get_metric() const { return metric_; }
+        Insertion find_optimal_insertion(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                         const PathProfile &profile, const SpatialIndex &spatial_index) const;
 
         /**
-         * Set metric
+         * Find optimal insertion positions for a batch of candidates against a path profile
+         * Runs the SIMD insertion kernel over every (slot, candidate) pair, then reduces per
+         * candidate; out[i] equals find_optimal_insertion for batch.tasks[i]. If the batch holds
+         * geometric tasks it is scored a second time reversed. Candidates must not be on the path.
+         *
+         * @param profile Result of compute_path_profile
+         * @param batch Candidates, added forward (cost matrices are overwritten)
+         * @param out Best insertion per candidate
+         */
+        void find_optimal_insertions(const PathProfile &profile, InsertionBatch &batch,
+                                     std::vector<Insertion> &out) const;
+
+        /**
+         * Score of a profiled path with its found tasks [first, last) replaced by `steps`
+         *
+         * Folds the policy from the profile's state in front of task `first` over the steps, then
+         * over the later tasks: only the leg into task `last` is recomputed, the others keep their
+         * profiled travel times and are shifted in time. Path improvement scores 2-opt and Or-opt
+         * moves this way in O(L) without copying the path; fewer steps than replaced tasks scores
+         * a removal. Step tasks must be in the index.
+         *
+         * @param profile Result of compute_path_profile
+         * @param first First replaced task (slot index)
+         * @param last One past the last replaced task (at most profile.tasks.size())
+         * @param steps Tasks visited instead, in order
+         * @param spatial_index Spatial index
+         * @return Score of the modified path (equals evaluate_path on it, up to rounding)
+         */
+        Score evaluate_splice(const PathProfile &profile, size_t first, size_t last, std::span<const PathStep> steps,
+                              const SpatialIndex &spatial_index) const;
+
+        /**
+         * Compute prefix times and policy suffix data of a path (reuses the profile's storage)
+         */
+        void compute_path_profile(const CBBAAgent &agent, const Path &path, const SpatialIndex &spatial_index,
+                                  PathProfile &profile) const;
+
+        /**
+         * Fill batch.reach and batch.delay for slots [first, first + count) of a profile
+         * Matrices are slot-major relative to `first`. Runs the SIMD kernel, or goes through the
+         * travel cost cache if one is set (same operation order, so straight-line costs match).
+         */
+        void compute_slot_costs(const PathProfile &profile, size_t first, size_t count, InsertionBatch &batch) const;
+
+        /**
+         * Best gain over both directions for slots [first, first + count) of a profile
+         * Slot-major like compute_slot_costs; the batch must be forward (cost matrices are overwritten).
+         */
+        void compute_slot_gains(const PathProfile &profile, size_t first, size_t count, InsertionBatch &batch,
+                                std::vector<Score> &gains) const;
+
+        /**
+         * Marginal gain of an insertion into one slot of a path profile, given its cost
+         * (local policies ignore the profile)
+         */
+        Score slot_gain(const PathProfile &profile, size_t slot, const InsertionCost &cost) const {
+            if constexpr (LocalScoringPolicy<Policy>) {
+                return policy_.slot_gain(cost);
+            } else {
+                return policy_.slot_gain(profile, slot, cost);
+            }
+        }
+
+        /**
+         * Compute the path geometry needed by marginal_gain_bound
+         */
+        PathBounds compute_path_bounds(const CBBAAgent &agent, const Path &path,
+                                       const SpatialIndex &spatial_index) const;
+
+        /**
+         * Upper bound on the marginal gain of any task at least `distance` away from the agent
+         *
+         * The task's entry and exit points are both at least `distance` from the agent and every
+         * path point is within bounds.radius, so by the triangle inequality inserting it adds at
+         * least min(d - R, 2(d - R) - max_leg) of travel. Driving a geometric task is work, not
+         * travel, so a row along the route can shorten it by up to the task's entry -> exit
+         * length L; with straight-line travel the extra travel is therefore also at least -L (0
+         * for point tasks). A travel cost model need not satisfy that triangle inequality (the
+         * direct leg may have to go around what the row crosses), so it gets no such floor. RPT turns
+         * that into a time penalty; TDR caps the task's own reward at lambda^((d - J) / v) and bounds
+         * how much earlier later tasks can get (entry -> exit jumps inside path tasks are not travel,
+         * so the arrival bound uses d - bounds.jump). The bound is non-increasing in distance.
+         * Policies without gain_bound return +infinity (no pruning).
+         *
+         * @param agent Agent state
+         * @param bounds Result of compute_path_bounds for the current path
+         * @param distance Lower bound on the distance from the agent to the task
+         * @param duration Lower bound on the task duration
+         * @param length Upper bound on the task's entry -> exit length (infinity if unknown)
+         * @return Upper bound on compute_marginal_gain for any such task and insertion position
+         */
+        Score marginal_gain_bound(const CBBAAgent &agent, const PathBounds &bounds, double distance,
+                                  double duration = 0.0,
+                                  double length = std::numeric_limits<double>::infinity()) const;
+
+        /**
+         * Get the scoring policy
+         */
+        const Policy &get_policy() const { return policy_; }
+
+        /**
+         * Use a travel cost model through its cache (not owned, nullptr = straight line)
+         * With a model set, batches are scored through the cache instead of the SIMD kernel.
          */
-        void set_metric(Metric metric) { metric_ = metric; }
+        void set_travel_costs(TravelCostCache *travel_costs) {
+            travel_costs_ = travel_costs;
+            scratch_.path_version = 0;
+        }
+
+        TravelCostCache *get_travel_costs() const { return travel_costs_; }
 
       private:
         /**
-         * Compute travel time between two points
-         * @param from Start point
-         * @param to End point
+         * Agent velocity used for scoring (falls back to 2 m/s if unset)
+         */
+        double effective_velocity(const CBBAAgent &agent) const;
+
+        /**
+         * Compute travel time of one leg (through the travel cost cache if set)
+         * @param from Task the leg starts after, or NO_TASK for the agent position
+         * @param from_direction Direction `from` is traversed in
+         * @param from_point Exit point of `from`, or the agent position
+         * @param to Task the leg ends at
+         * @param to_direction Direction `to` is traversed in
+         * @param to_point Entry point of `to`
          * @param velocity Agent velocity (m/s)
          * @return Time in seconds
          */
-        double compute_travel_time(const Point &from, const Point &to, double velocity) const;
+        double compute_travel_time(TaskIndex from, Direction from_direction, const Point &from_point, TaskIndex to,
+                                   Direction to_direction, const Point &to_point, double velocity) const;
+
+        /**
+         * Travel distance of one leg (see compute_travel_time)
+         */
+        double compute_travel_distance(TaskIndex from, Direction from_direction, const Point &from_point,
+                                       TaskIndex to, Direction to_direction, const Point &to_point) const {
+            return travel_costs_ ? travel_costs_->distance(from, from_direction, from_point, to, to_direction, to_point)
+                                 : from_point.distance_to(to_point);
+        }
 
         /**
          * Compute time to complete a task
@@ -91,26 +265,724 @@ namespace consens::cbba {
         double compute_task_time(const Task &task) const;
 
         /**
-         * Compute total time for a path using RPT metric
-         * RPT = Reward Per Time = -total_time (we want to minimize time)
+         * Best insertion for a local policy, in closed form
+         * Inserting t between prev and next only changes that leg, so all positions (in both
+         * directions) are scored in one O(L) pass with no allocation. Path tasks missing from the
+         * index are skipped, as in evaluate_with_insertion.
          *
          * @param agent Agent state
-         * @param path Path to evaluate
+         * @param task Task to insert (not on the path)
+         * @param path Current path
          * @param spatial_index Spatial index
-         * @return Negative total time (higher is better)
+         * @return Best insertion (score, position, direction)
+         */
+        Insertion find_local_insertion(const CBBAAgent &agent, TaskIndex task, const Path &path,
+                                       const SpatialIndex &spatial_index) const
+            requires LocalScoringPolicy<Policy>;
+
+        /**
+         * Marginal gain of inserting a task at one position for a local policy, in closed form
+         */
+        Score compute_local_insertion_gain(const CBBAAgent &agent, TaskIndex task, const Path &path,
+                                           size_t insertion_pos, Direction direction,
+                                           const SpatialIndex &spatial_index) const
+            requires LocalScoringPolicy<Policy>;
+
+        /**
+         * Profile of a path, rebuilt into the scratch only if its inputs changed since the last call
+         */
+        const PathProfile &cached_path_profile(const CBBAAgent &agent, const Path &path,
+                                               const SpatialIndex &spatial_index) const;
+
+        /**
+         * Marginal gain of inserting a task into one slot of a path profile
+         */
+        Score compute_slot_gain(const PathProfile &profile, size_t slot, TaskIndex task, const Task &data,
+                                Direction direction) const;
+
+        /**
+         * Cost of visiting `task` after a point (the exit of `prev`, or the agent position if
+         * prev is NO_TASK) and before an optional next task entered at `next_entry`
          */
-        Score compute_rpt_score(const CBBAAgent &agent, const Path &path, const SpatialIndex &spatial_index) const;
+        InsertionCost compute_insertion_cost(TaskIndex prev, Direction prev_direction, const Point &prev_point,
+                                             TaskIndex task, const Task &data, Direction direction, TaskIndex next,
+                                             Direction next_direction, const Point *next_entry,
+                                             double velocity) const;
 
         /**
-         * Compute time-discounted reward for a path using TDR metric
-         * TDR = sum of lambda^t_i for each task
+         * Evaluate a path with one task virtually inserted, without copying the path
+         * Folds policy.add_task over the path tasks found in the index, in execution order.
          *
          * @param agent Agent state
          * @param path Path to evaluate
+         * @param inserted Task to insert, or NO_TASK to evaluate the path as is
+         * @param insertion_pos Position of the inserted task
+         * @param direction Traversal of the inserted task
          * @param spatial_index Spatial index
-         * @return Time-discounted reward (higher is better)
+         * @return Score under the policy
+         */
+        Score evaluate_with_insertion(const CBBAAgent &agent, const Path &path, TaskIndex inserted,
+                                      size_t insertion_pos, Direction direction,
+                                      const SpatialIndex &spatial_index) const;
+    };
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::compute_marginal_gain(const CBBAAgent &agent, const Task &task,
+                                                         const Path &current_path, size_t insertion_pos,
+                                                         const SpatialIndex &spatial_index,
+                                                         Direction direction) const {
+        return compute_marginal_gain(agent, task_ids().find(task.get_id()), current_path, insertion_pos,
+                                     spatial_index, direction);
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::compute_marginal_gain(const CBBAAgent &agent, TaskIndex task,
+                                                         const Path &current_path, size_t insertion_pos,
+                                                         const SpatialIndex &spatial_index,
+                                                         Direction direction) const {
+        // A task already on the path cannot be inserted again
+        if (current_path.contains(task)) {
+            return 0.0;
+        }
+
+        if constexpr (LocalScoringPolicy<Policy>) {
+            return compute_local_insertion_gain(agent, task, current_path, insertion_pos, direction, spatial_index);
+        } else {
+            const Task *inserted = spatial_index.find_task(task);
+            if (!inserted) {
+                return 0.0;
+            }
+
+            // Slot = number of found path tasks before the insertion position
+            const PathProfile &profile = cached_path_profile(agent, current_path, spatial_index);
+            size_t slot = static_cast<size_t>(std::lower_bound(profile.positions.begin(), profile.positions.end(),
+                                                               std::min(insertion_pos, current_path.size())) -
+                                              profile.positions.begin());
+            return compute_slot_gain(profile, slot, task, *inserted, direction);
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::evaluate_path(const CBBAAgent &agent, const Path &path,
+                                                 const SpatialIndex &spatial_index) const {
+        return evaluate_with_insertion(agent, path, NO_TASK, 0, Direction::FORWARD, spatial_index);
+    }
+
+    template <ScoringPolicy Policy>
+    Insertion BasicTaskScorer<Policy>::find_optimal_insertion(const CBBAAgent &agent, const Task &task,
+                                                              const Path &current_path,
+                                                              const SpatialIndex &spatial_index) const {
+        return find_optimal_insertion(agent, task_ids().find(task.get_id()), current_path, spatial_index);
+    }
+
+    template <ScoringPolicy Policy>
+    Insertion BasicTaskScorer<Policy>::find_optimal_insertion(const CBBAAgent &agent, TaskIndex task,
+                                                              const Path &current_path,
+                                                              const SpatialIndex &spatial_index) const {
+        if (current_path.contains(task)) {
+            return {0.0, current_path.find_position(task), current_path.get_direction(task)};
+        }
+
+        if constexpr (LocalScoringPolicy<Policy>) {
+            return find_local_insertion(agent, task, current_path, spatial_index);
+        } else {
+            return find_optimal_insertion(agent, task, current_path,
+                                          cached_path_profile(agent, current_path, spatial_index), spatial_index);
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    Insertion BasicTaskScorer<Policy>::find_optimal_insertion(const CBBAAgent &, TaskIndex task,
+                                                              const Path &current_path, const PathProfile &profile,
+                                                              const SpatialIndex &spatial_index) const {
+        if (current_path.contains(task)) {
+            return {0.0, current_path.find_position(task), current_path.get_direction(task)};
+        }
+
+        // An unknown task leaves the path score unchanged at every position
+        const Task *inserted = spatial_index.find_task(task);
+        if (!inserted) {
+            return {0.0, 0, Direction::FORWARD};
+        }
+
+        // Positions between two consecutive found tasks share a slot (and gain), so only the
+        // first position of each slot is reported; ties keep the earliest position. Point tasks
+        // are the same both ways, so only geometric tasks are scored reversed.
+        Insertion best{MIN_SCORE, 0, Direction::FORWARD};
+        Insertion best_reverse{MIN_SCORE, 0, Direction::REVERSE};
+        for (size_t slot = 0; slot < profile.slots(); slot++) {
+            Score gain = compute_slot_gain(profile, slot, task, *inserted, Direction::FORWARD);
+            if (gain > best.score) {
+                best.score = gain;
+                best.position = profile.slot_position(slot);
+            }
+            if (inserted->has_geometry()) {
+                gain = compute_slot_gain(profile, slot, task, *inserted, Direction::REVERSE);
+                if (gain > best_reverse.score) {
+                    best_reverse.score = gain;
+                    best_reverse.position = profile.slot_position(slot);
+                }
+            }
+        }
+
+        return best_reverse.score > best.score ? best_reverse : best;
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicTaskScorer<Policy>::find_optimal_insertions(const PathProfile &profile, InsertionBatch &batch,
+                                                          std::vector<Insertion> &out) const {
+        size_t n = batch.size();
+        out.assign(n, Insertion{MIN_SCORE, 0, Direction::FORWARD});
+        if (n == 0) {
+            return;
+        }
+
+        // Forward pass, then a reverse pass that only takes strictly better gains: same slot
+        // order and tie-breaking as find_optimal_insertion
+        size_t passes = batch.geometric > 0 ? 2 : 1;
+        for (size_t pass = 0; pass < passes; pass++) {
+            if (pass == 1) {
+                batch.reverse();
+            }
+            compute_slot_costs(profile, 0, profile.slots(), batch);
+
+            for (size_t slot = 0; slot < profile.slots(); slot++) {
+                const double *reach = batch.reach.data() + slot * n;
+                const double *delay = batch.delay.data() + slot * n;
+                size_t position = profile.slot_position(slot);
+                for (size_t c = 0; c < n; c++) {
+                    Score gain = slot_gain(profile, slot, InsertionCost{reach[c], delay[c], batch.duration[c]});
+                    if (gain > out[c].score) {
+                        out[c] = Insertion{gain, position, batch.direction};
+                    }
+                }
+            }
+        }
+        if (passes == 2) {
+            batch.reverse();
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicTaskScorer<Policy>::compute_path_profile(const CBBAAgent &agent, const Path &path,
+                                                       const SpatialIndex &spatial_index, PathProfile &profile) const {
+        profile.clear();
+        double velocity = effective_velocity(agent);
+        profile.velocity = velocity;
+
+        // Forward pass: position and elapsed time in front of each slot
+        Point current_pos = agent.get_pose().position;
+        TaskIndex current_task = NO_TASK;
+        Direction current_direction = Direction::FORWARD;
+        double elapsed = 0.0;
+        Score score = 0.0;
+        const auto &tasks = path.indices();
+        for (size_t i = 0; i < tasks.size(); i++) {
+            const Task *task = spatial_index.find_task(tasks[i]);
+            if (!task) {
+                continue;
+            }
+
+            Direction direction = path.direction_at(i);
+            const Point &entry = task->get_entry(direction);
+            double bypass_time =
+                compute_travel_time(current_task, current_direction, current_pos, tasks[i], direction, entry, velocity);
+            profile.edges.push_back(InsertionEdge{current_pos, entry, 1.0, bypass_time});
+            profile.time.push_back(elapsed);
+            profile.score.push_back(score);
+            profile.positions.push_back(i);
+            profile.tasks.push_back(tasks[i]);
+            profile.directions.push_back(direction);
+
+            double task_time = compute_task_time(*task);
+            elapsed += bypass_time + task_time;
+            score = policy_.add_task(score, elapsed, bypass_time, task_time);
+            current_pos = task->get_exit(direction);
+            current_task = tasks[i];
+            current_direction = direction;
+        }
+
+        // Append slot: no following task, so no onward travel and nothing bypassed
+        profile.edges.push_back(InsertionEdge{current_pos, current_pos, 0.0, 0.0});
+        profile.time.push_back(elapsed);
+        profile.score.push_back(score);
+
+        // Backward pass, if the policy needs one
+        profile.suffix.assign(profile.slots(), 0.0);
+        if constexpr (requires { policy_.prepare(profile); }) {
+            policy_.prepare(profile);
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    const PathProfile &BasicTaskScorer<Policy>::cached_path_profile(const CBBAAgent &agent, const Path &path,
+                                                                    const SpatialIndex &spatial_index) const {
+        const Point &position = agent.get_pose().position;
+        double velocity = effective_velocity(agent);
+
+        // Any change to the indexed set bumps the revision, so re-indexed path tasks are seen
+        bool unchanged = path.version() == scratch_.path_version && &spatial_index == scratch_.spatial_index &&
+                         spatial_index.revision() == scratch_.index_revision && position == scratch_.position &&
+                         velocity == scratch_.velocity;
+        if (!unchanged) {
+            compute_path_profile(agent, path, spatial_index, scratch_.profile);
+            scratch_.path_version = path.version();
+            scratch_.spatial_index = &spatial_index;
+            scratch_.index_revision = spatial_index.revision();
+            scratch_.position = position;
+            scratch_.velocity = velocity;
+        }
+        return scratch_.profile;
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::evaluate_splice(const PathProfile &profile, size_t first, size_t last,
+                                                   std::span<const PathStep> steps,
+                                                   const SpatialIndex &spatial_index) const {
+        double velocity = profile.velocity;
+        Score score = profile.score[first];
+        double elapsed = profile.time[first];
+        Point current_pos = profile.edges[first].prev;
+        TaskIndex current_task = profile.slot_origin(first);
+        Direction current_direction = profile.slot_origin_direction(first);
+
+        // Replaced range, in the same operation order as compute_path_profile
+        for (const PathStep &step : steps) {
+            const Task *task = spatial_index.find_task(step.task);
+            double travel_time = compute_travel_time(current_task, current_direction, current_pos, step.task,
+                                                     step.direction, task->get_entry(step.direction), velocity);
+            double task_time = compute_task_time(*task);
+            elapsed += travel_time + task_time;
+            score = policy_.add_task(score, elapsed, travel_time, task_time);
+            current_pos = task->get_exit(step.direction);
+            current_task = step.task;
+            current_direction = step.direction;
+        }
+
+        // Later tasks: new leg into `last`, then every completion moves by the same shift
+        size_t count = profile.tasks.size();
+        if (last >= count) {
+            return score;
+        }
+        double travel_time = compute_travel_time(current_task, current_direction, current_pos, profile.tasks[last],
+                                                 profile.directions[last], profile.edges[last].next, velocity);
+        double shift = (elapsed + travel_time) - (profile.time[last] + profile.edges[last].bypass_time);
+        for (size_t j = last; j < count; j++) {
+            double task_time = compute_task_time(*spatial_index.find_task(profile.tasks[j]));
+            score = policy_.add_task(score, profile.time[j + 1] + shift,
+                                     j == last ? travel_time : profile.edges[j].bypass_time, task_time);
+        }
+        return score;
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::compute_slot_gain(const PathProfile &profile, size_t slot, TaskIndex task,
+                                                     const Task &data, Direction direction) const {
+        // Same operation order as the batch kernel, so both give identical gains
+        const InsertionEdge &edge = profile.edges[slot];
+        double duration = compute_task_time(data);
+        double reach = compute_travel_time(profile.slot_origin(slot), profile.slot_origin_direction(slot), edge.prev,
+                                           task, direction, data.get_entry(direction), profile.velocity) +
+                       duration;
+        double onward = slot < profile.tasks.size() // The append slot has no onward leg (weight 0)
+                            ? compute_travel_time(task, direction, data.get_exit(direction), profile.tasks[slot],
+                                                  profile.directions[slot], edge.next, profile.velocity)
+                            : 0.0;
+        double delay = (reach + edge.weight * onward) - edge.bypass_time;
+        return slot_gain(profile, slot, InsertionCost{reach, delay, duration});
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicTaskScorer<Policy>::compute_slot_costs(const PathProfile &profile, size_t first, size_t count,
+                                                     InsertionBatch &batch) const {
+        if (!travel_costs_) {
+            compute_insertion_costs(std::span<const InsertionEdge>(profile.edges).subspan(first, count),
+                                    profile.velocity, batch);
+            return;
+        }
+
+        // Same operation order as the kernel's scalar loop; the append slot has no onward leg
+        size_t n = batch.size();
+        batch.reach.resize(count * n);
+        batch.delay.resize(count * n);
+        for (size_t j = 0; j < count; j++) {
+            size_t slot = first + j;
+            const InsertionEdge &edge = profile.edges[slot];
+            TaskIndex origin = profile.slot_origin(slot);
+            Direction origin_direction = profile.slot_origin_direction(slot);
+            bool append = slot == profile.tasks.size();
+            for (size_t c = 0; c < n; c++) {
+                Point entry(batch.entry_x[c], batch.entry_y[c]);
+                Point exit(batch.exit_x[c], batch.exit_y[c]);
+                double reach = compute_travel_time(origin, origin_direction, edge.prev, batch.tasks[c],
+                                                   batch.direction, entry, profile.velocity) +
+                               batch.duration[c];
+                double onward = append ? 0.0
+                                       : compute_travel_time(batch.tasks[c], batch.direction, exit, profile.tasks[slot],
+                                                             profile.directions[slot], edge.next, profile.velocity);
+                batch.reach[j * n + c] = reach;
+                batch.delay[j * n + c] = (reach + edge.weight * onward) - edge.bypass_time;
+            }
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    void BasicTaskScorer<Policy>::compute_slot_gains(const PathProfile &profile, size_t first, size_t count,
+                                                     InsertionBatch &batch, std::vector<Score> &gains) const {
+        size_t n = batch.size();
+        gains.assign(count * n, MIN_SCORE);
+
+        size_t passes = batch.geometric > 0 ? 2 : 1;
+        for (size_t pass = 0; pass < passes; pass++) {
+            if (pass == 1) {
+                batch.reverse();
+            }
+            compute_slot_costs(profile, first, count, batch);
+
+            for (size_t j = 0; j < count * n; j++) {
+                Score gain = slot_gain(profile, first + j / n,
+                                       InsertionCost{batch.reach[j], batch.delay[j], batch.duration[j % n]});
+                gains[j] = std::max(gains[j], gain);
+            }
+        }
+        if (passes == 2) {
+            batch.reverse();
+        }
+    }
+
+    template <ScoringPolicy Policy>
+    PathBounds BasicTaskScorer<Policy>::compute_path_bounds(const CBBAAgent &agent, const Path &path,
+                                                            const SpatialIndex &spatial_index) const {
+        PathBounds bounds;
+        bounds.score = evaluate_path(agent, path, spatial_index);
+
+        const Point &origin = agent.get_pose().position;
+        Point exit = origin;
+        TaskIndex previous = NO_TASK;
+        Direction previous_direction = Direction::FORWARD;
+        for (size_t i = 0; i < path.size(); i++) {
+            TaskIndex index = path.index_at(i);
+            const Task *task = spatial_index.find_task(index);
+            if (!task) {
+                continue;
+            }
+
+            // Same entry/exit points as the path evaluation; legs in travel cost model distance,
+            // since that is what an insertion bypasses
+            Direction direction = path.direction_at(i);
+            const Point &entry = task->get_entry(direction);
+            bounds.max_leg = std::max(
+                bounds.max_leg, compute_travel_distance(previous, previous_direction, exit, index, direction, entry));
+            exit = task->get_exit(direction);
+            previous = index;
+            previous_direction = direction;
+            bounds.jump += entry.distance_to(exit);
+            bounds.radius = std::max({bounds.radius, origin.distance_to(entry), origin.distance_to(exit)});
+        }
+
+        return bounds;
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::marginal_gain_bound(const CBBAAgent &agent, const PathBounds &bounds,
+                                                       double distance, double duration, double length) const {
+        if constexpr (requires { policy_.gain_bound(bounds, distance, distance, distance, duration); }) {
+            double velocity = effective_velocity(agent);
+
+            // Extra travel for appending (d - R) or inserting between two path points (2(d - R) - max_leg),
+            // and with straight-line travel never less than minus the task's own entry -> exit length
+            double reach = distance - bounds.radius;
+            double detour = std::min(reach, 2.0 * reach - bounds.max_leg);
+            if (!travel_costs_) {
+                detour = std::max(detour, -length);
+            }
+
+            return policy_.gain_bound(bounds, velocity, distance, detour, duration);
+        } else {
+            (void)agent; // Suppress unused parameter warning
+            return std::numeric_limits<double>::infinity();
+        }
+    }
+
+    template <ScoringPolicy Policy> double BasicTaskScorer<Policy>::effective_velocity(const CBBAAgent &agent) const {
+        double velocity = agent.get_velocity();
+        return velocity > 0.0 ? velocity : 2.0;
+    }
+
+    template <ScoringPolicy Policy>
+    double BasicTaskScorer<Policy>::compute_travel_time(TaskIndex from, Direction from_direction,
+                                                        const Point &from_point, TaskIndex to, Direction to_direction,
+                                                        const Point &to_point, double velocity) const {
+        if (velocity <= 0.0) {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        double distance = compute_travel_distance(from, from_direction, from_point, to, to_direction, to_point);
+        return distance / velocity;
+    }
+
+    template <ScoringPolicy Policy> double BasicTaskScorer<Policy>::compute_task_time(const Task &task) const {
+        // For now, just use the task's duration
+        // In the future, this could be more sophisticated
+        return task.get_duration();
+    }
+
+    template <ScoringPolicy Policy>
+    Insertion BasicTaskScorer<Policy>::find_local_insertion(const CBBAAgent &agent, TaskIndex task, const Path &path,
+                                                            const SpatialIndex &spatial_index) const
+        requires LocalScoringPolicy<Policy>
+    {
+        // An unknown task leaves the path score unchanged at every position
+        const Task *inserted = spatial_index.find_task(task);
+        if (!inserted) {
+            return {0.0, 0, Direction::FORWARD};
+        }
+
+        double velocity = effective_velocity(agent);
+        Insertion best{MIN_SCORE, 0, Direction::FORWARD};
+        Insertion best_reverse{MIN_SCORE, 0, Direction::REVERSE};
+
+        // Scores both directions of one slot (point tasks are the same both ways)
+        auto consider = [&](size_t position, TaskIndex prev, Direction prev_direction, const Point &prev_point,
+                            TaskIndex next, Direction next_direction, const Point *next_entry) {
+            Score gain = policy_.slot_gain(compute_insertion_cost(prev, prev_direction, prev_point, task, *inserted,
+                                                                  Direction::FORWARD, next, next_direction,
+                                                                  next_entry, velocity));
+            if (gain > best.score) {
+                best.score = gain;
+                best.position = position;
+            }
+            if (inserted->has_geometry()) {
+                gain = policy_.slot_gain(compute_insertion_cost(prev, prev_direction, prev_point, task, *inserted,
+                                                                Direction::REVERSE, next, next_direction,
+                                                                next_entry, velocity));
+                if (gain > best_reverse.score) {
+                    best_reverse.score = gain;
+                    best_reverse.position = position;
+                }
+            }
+        };
+
+        // Positions between two consecutive found tasks share the same neighbours (and gain), so
+        // only the first position of each run is scored; ties keep the earliest position
+        Point prev_point = agent.get_pose().position;
+        TaskIndex prev = NO_TASK;
+        Direction prev_direction = Direction::FORWARD;
+        size_t run_start = 0;
+        for (size_t i = 0; i < path.size(); i++) {
+            TaskIndex index = path.index_at(i);
+            const Task *next = spatial_index.find_task(index);
+            if (!next) {
+                continue;
+            }
+
+            Direction direction = path.direction_at(i);
+            consider(run_start, prev, prev_direction, prev_point, index, direction, &next->get_entry(direction));
+
+            prev_point = next->get_exit(direction);
+            prev = index;
+            prev_direction = direction;
+            run_start = i + 1;
+        }
+
+        // Append after the last found task
+        consider(run_start, prev, prev_direction, prev_point, NO_TASK, Direction::FORWARD, nullptr);
+
+        return best_reverse.score > best.score ? best_reverse : best;
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::compute_local_insertion_gain(const CBBAAgent &agent, TaskIndex task,
+                                                                const Path &path, size_t insertion_pos,
+                                                                Direction direction,
+                                                                const SpatialIndex &spatial_index) const
+        requires LocalScoringPolicy<Policy>
+    {
+        const Task *inserted = spatial_index.find_task(task);
+        if (!inserted) {
+            return 0.0;
+        }
+
+        // Neighbours: last found task before the position and first found task at or after it
+        size_t pos = std::min(insertion_pos, path.size());
+        Point prev_point = agent.get_pose().position;
+        TaskIndex prev = NO_TASK;
+        Direction prev_direction = Direction::FORWARD;
+        for (size_t i = 0; i < pos; i++) {
+            const Task *before = spatial_index.find_task(path.index_at(i));
+            if (before) {
+                prev_point = before->get_exit(path.direction_at(i));
+                prev = path.index_at(i);
+                prev_direction = path.direction_at(i);
+            }
+        }
+
+        const Point *next_entry = nullptr;
+        TaskIndex next = NO_TASK;
+        Direction next_direction = Direction::FORWARD;
+        for (size_t i = pos; i < path.size() && !next_entry; i++) {
+            const Task *after = spatial_index.find_task(path.index_at(i));
+            if (after) {
+                next_entry = &after->get_entry(path.direction_at(i));
+                next = path.index_at(i);
+                next_direction = path.direction_at(i);
+            }
+        }
+
+        return policy_.slot_gain(compute_insertion_cost(prev, prev_direction, prev_point, task, *inserted, direction,
+                                                        next, next_direction, next_entry, effective_velocity(agent)));
+    }
+
+    template <ScoringPolicy Policy>
+    InsertionCost BasicTaskScorer<Policy>::compute_insertion_cost(TaskIndex prev, Direction prev_direction,
+                                                                  const Point &prev_point, TaskIndex task,
+                                                                  const Task &data, Direction direction,
+                                                                  TaskIndex next, Direction next_direction,
+                                                                  const Point *next_entry, double velocity) const {
+        // Same operation order as the batch kernel (the append slot has no onward leg)
+        double duration = compute_task_time(data);
+        double reach = compute_travel_time(prev, prev_direction, prev_point, task, direction,
+                                           data.get_entry(direction), velocity) +
+                       duration;
+        double delay = reach;
+        if (next_entry) {
+            delay += compute_travel_time(task, direction, data.get_exit(direction), next, next_direction, *next_entry,
+                                         velocity);
+            delay -= compute_travel_time(prev, prev_direction, prev_point, next, next_direction, *next_entry,
+                                         velocity);
+        }
+        return InsertionCost{reach, delay, duration};
+    }
+
+    template <ScoringPolicy Policy>
+    Score BasicTaskScorer<Policy>::evaluate_with_insertion(const CBBAAgent &agent, const Path &path,
+                                                           TaskIndex inserted, size_t insertion_pos,
+                                                           Direction direction,
+                                                           const SpatialIndex &spatial_index) const {
+        size_t count = path.size() + (inserted != NO_TASK ? 1 : 0);
+        size_t pos = inserted != NO_TASK ? std::min(insertion_pos, path.size()) : count;
+        Score score = 0.0;
+        double elapsed = 0.0;
+        Point current_pos = agent.get_pose().position;
+        TaskIndex current_task = NO_TASK;
+        Direction current_direction = Direction::FORWARD;
+        double velocity = effective_velocity(agent);
+
+        for (size_t i = 0; i < count; i++) {
+            // Path task i, shifted by one after the inserted task
+            TaskIndex index = i == pos ? inserted : path.index_at(i < pos ? i : i - 1);
+            Direction traversal = i == pos ? direction : path.direction_at(i < pos ? i : i - 1);
+
+            // Get task from spatial index (no copy)
+            const Task *task = spatial_index.find_task(index);
+            if (!task) {
+                continue; // Skip if task not found
+            }
+
+            // Travel to the task, then execute it
+            double travel_time = compute_travel_time(current_task, current_direction, current_pos, index, traversal,
+                                                     task->get_entry(traversal), velocity);
+            double task_time = compute_task_time(*task);
+            elapsed += travel_time;
+            elapsed += task_time;
+            score = policy_.add_task(score, elapsed, travel_time, task_time);
+
+            current_pos = task->get_exit(traversal);
+            current_task = index;
+            current_direction = traversal;
+        }
+
+        return score;
+    }
+
+    // Built-in policies are instantiated once in the library
+    extern template class BasicTaskScorer<RptPolicy>;
+    extern template class BasicTaskScorer<TdrPolicy>;
+
+    /**
+     * Task scorer selected by the Metric enum at runtime
+     * Dispatches once per call to BasicTaskScorer<RptPolicy> or BasicTaskScorer<TdrPolicy>;
+     * the loops inside each call are specialised for the metric.
+     */
+    class TaskScorer {
+      private:
+        std::variant<BasicTaskScorer<RptPolicy>, BasicTaskScorer<TdrPolicy>> scorer_;
+        double lambda_; // Discount factor for TDR metric
+
+      public:
+        /**
+         * Constructor
+         * @param metric Scoring metric to use (default: RPT)
+         * @param lambda Discount factor for TDR (default: 0.95)
+         */
+        explicit TaskScorer(Metric metric = Metric::RPT, double lambda = 0.95);
+
+        /**
+         * Compute marginal gain of adding a task to the path (see BasicTaskScorer)
+         */
+        Score compute_marginal_gain(const CBBAAgent &agent, const Task &task, const Path &current_path,
+                                    size_t insertion_pos, const SpatialIndex &spatial_index,
+                                    Direction direction = Direction::FORWARD) const;
+        Score compute_marginal_gain(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                    size_t insertion_pos, const SpatialIndex &spatial_index,
+                                    Direction direction = Direction::FORWARD) const;
+
+        /**
+         * Evaluate the score of an entire path
+         */
+        Score evaluate_path(const CBBAAgent &agent, const Path &path, const SpatialIndex &spatial_index) const;
+
+        /**
+         * Find optimal insertion position and direction for a task in the path
+         * @return Best insertion (score, position, direction)
+         */
+        Insertion find_optimal_insertion(const CBBAAgent &agent, const Task &task, const Path &current_path,
+                                         const SpatialIndex &spatial_index) const;
+        Insertion find_optimal_insertion(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                         const SpatialIndex &spatial_index) const;
+        Insertion find_optimal_insertion(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                         const PathProfile &profile, const SpatialIndex &spatial_index) const;
+
+        /**
+         * Find optimal insertions for a batch of candidates against a path profile
+         */
+        void find_optimal_insertions(const PathProfile &profile, InsertionBatch &batch,
+                                     std::vector<Insertion> &out) const;
+
+        /**
+         * Score of a profiled path with tasks [first, last) replaced (see BasicTaskScorer::evaluate_splice)
+         */
+        Score evaluate_splice(const PathProfile &profile, size_t first, size_t last, std::span<const PathStep> steps,
+                              const SpatialIndex &spatial_index) const;
+
+        /**
+         * Compute prefix times and TDR suffix sums of a path (reuses the profile's storage)
+         */
+        void compute_path_profile(const CBBAAgent &agent, const Path &path, const SpatialIndex &spatial_index,
+                                  PathProfile &profile) const;
+
+        /**
+         * Compute the path geometry needed by marginal_gain_bound
+         */
+        PathBounds compute_path_bounds(const CBBAAgent &agent, const Path &path,
+                                       const SpatialIndex &spatial_index) const;
+
+        /**
+         * Upper bound on the marginal gain of any task at least `distance` away from the agent
+         */
+        Score marginal_gain_bound(const CBBAAgent &agent, const PathBounds &bounds, double distance,
+                                  double duration = 0.0,
+                                  double length = std::numeric_limits<double>::infinity()) const;
+
+        /**
+         * Get current metric
+         */
+        Metric get_metric() const { return scorer_.index() == 0 ? Metric::RPT : Metric::TDR; }
+
+        /**
+         * Set metric
          */
-        Score compute_tdr_score(const CBBAAgent &agent, const Path &path, const SpatialIndex &spatial_index) const;
+        void set_metric(Metric metric);
     };
 
 } // namespace consens::cbba
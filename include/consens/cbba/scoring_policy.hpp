@@ -0,0 +1,185 @@
+#pragma once
+
+#include "insertion_kernel.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Path geometry used to bound marginal gains (see BasicTaskScorer::marginal_gain_bound)
+     */
+    struct PathBounds {
+        double radius = 0.0;  // Max distance from the agent to any task entry/exit point on the path
+        double max_leg = 0.0; // Longest travel leg (agent -> first task, task exit -> next task)
+        double jump = 0.0;    // Total entry -> exit displacement inside path tasks (not counted as travel)
+        Score score = 0.0;    // Current path score
+    };
+
+    /**
+     * Per-path data shared by every insertion evaluated against the same path
+     * Slot j is the gap before the j-th path task found in the index; slot m (m found tasks)
+     * appends. Inserting into slot j delays every later task by the same dt, so under TDR their
+     * contribution is suffix[j] * lambda^dt.
+     */
+    struct PathProfile {
+        std::vector<InsertionEdge> edges;  // Slot j: position before it and entry of task j
+        std::vector<double> time;          // Elapsed time at edges[j].prev
+        std::vector<Score> score;          // Path score of the found tasks before slot j
+        std::vector<Score> suffix;         // Policy data per slot (TDR: sum of lambda^t over found tasks j..)
+        std::vector<size_t> positions;     // Path position of task j (m entries)
+        std::vector<TaskIndex> tasks;      // Handle of task j (m entries)
+        std::vector<Direction> directions; // Direction of task j (m entries)
+        double velocity = 0.0;             // Velocity the times were computed with
+
+        /**
+         * Number of slots (found tasks + 1)
+         */
+        size_t slots() const { return edges.size(); }
+
+        /**
+         * Task the slot starts after (NO_TASK for the agent position) and its direction
+         */
+        TaskIndex slot_origin(size_t slot) const { return slot == 0 ? NO_TASK : tasks[slot - 1]; }
+        Direction slot_origin_direction(size_t slot) const {
+            return slot == 0 ? Direction::FORWARD : directions[slot - 1];
+        }
+
+        /**
+         * First path position that falls into a slot
+         */
+        size_t slot_position(size_t slot) const { return slot == 0 ? 0 : positions[slot - 1] + 1; }
+
+        void clear() {
+            edges.clear();
+            time.clear();
+            score.clear();
+            suffix.clear();
+            positions.clear();
+            tasks.clear();
+            directions.clear();
+        }
+    };
+
+    /**
+     * Cost of visiting a task from one slot (same quantities as InsertionBatch)
+     */
+    struct InsertionCost {
+        double reach;    // Time from the slot start until the task is completed (travel + duration)
+        double delay;    // How much later every following path task completes
+        double duration; // Task duration (reach - duration is the travel to the task)
+    };
+
+    /**
+     * Scoring policy whose slot gain only depends on the slot's own insertion cost
+     *
+     *   Score slot_gain(const InsertionCost &cost) const
+     *
+     * An insertion leaves every other slot's cost unchanged, so local policies are scored in
+     * closed form without a path profile and bundle filling only rescores the two new slots.
+     */
+    template <typename Policy>
+    concept LocalScoringPolicy = requires(const Policy &policy, const InsertionCost &cost) {
+        { policy.slot_gain(cost) } -> std::convertible_to<Score>;
+    };
+
+    /**
+     * Scoring policy plugged into BasicTaskScorer and BasicBundleBuilder
+     *
+     * Required:
+     *   Score add_task(Score score, double elapsed, double travel, double duration) const
+     *     Path score after completing one more task at time `elapsed` (0 for the empty path)
+     *   Score slot_gain(const InsertionCost &cost) const                        (local), or
+     *   Score slot_gain(const PathProfile &profile, size_t slot, const InsertionCost &cost) const
+     *     Marginal gain of an insertion; must equal the change of the add_task fold
+     *
+     * Optional:
+     *   void prepare(PathProfile &profile) const
+     *     Fill profile.suffix after the forward pass (zero-initialised)
+     *   Score gain_bound(const PathBounds &bounds, double velocity, double distance, double detour,
+     *                    double duration) const
+     *     Upper bound on the gain of a task `distance` away (see BasicTaskScorer::marginal_gain_bound);
+     *     `detour` bounds the extra travel from below and can be negative for geometric tasks;
+     *     without it every task in radius is scored
+     *
+     * Every call is resolved at compile time, so the policy inlines into the insertion loops.
+     */
+    template <typename Policy>
+    concept ScoringPolicy =
+        std::copy_constructible<Policy> &&
+        requires(const Policy &policy, Score score, double time, const PathProfile &profile, size_t slot,
+                 const InsertionCost &cost) {
+            { policy.add_task(score, time, time, time) } -> std::convertible_to<Score>;
+        } &&
+        (LocalScoringPolicy<Policy> ||
+         requires(const Policy &policy, const PathProfile &profile, size_t slot, const InsertionCost &cost) {
+             { policy.slot_gain(profile, slot, cost) } -> std::convertible_to<Score>;
+         });
+
+    /**
+     * Reward Per Time: minus the total path time (higher is better)
+     */
+    struct RptPolicy {
+        static constexpr Metric METRIC = Metric::RPT;
+
+        Score add_task(Score, double elapsed, double, double) const { return -elapsed; }
+
+        Score slot_gain(const InsertionCost &cost) const { return -cost.delay; }
+
+        Score gain_bound(const PathBounds &, double velocity, double, double detour, double duration) const {
+            return -(duration + detour / velocity);
+        }
+    };
+
+    /**
+     * Time-Discounted Reward: sum of lambda^t over task completion times
+     */
+    struct TdrPolicy {
+        static constexpr Metric METRIC = Metric::TDR;
+
+        double lambda = 0.95; // Discount factor
+
+        Score add_task(Score score, double elapsed, double, double) const { return score + std::pow(lambda, elapsed); }
+
+        /**
+         * Discounted reward of everything from slot j on (task j completes at time[j + 1])
+         */
+        void prepare(PathProfile &profile) const {
+            for (size_t j = profile.positions.size(); j-- > 0;) {
+                profile.suffix[j] = profile.suffix[j + 1] + std::pow(lambda, profile.time[j + 1]);
+            }
+        }
+
+        /**
+         * Own reward plus the later tasks shifted by `delay`
+         */
+        Score slot_gain(const PathProfile &profile, size_t slot, const InsertionCost &cost) const {
+            return std::pow(lambda, profile.time[slot] + cost.reach) +
+                   profile.suffix[slot] * (std::pow(lambda, cost.delay) - 1.0);
+        }
+
+        Score gain_bound(const PathBounds &bounds, double velocity, double distance, double detour,
+                         double duration) const {
+            // Only holds for a proper discount factor
+            if (lambda <= 0.0 || lambda >= 1.0) {
+                return std::numeric_limits<double>::infinity();
+            }
+
+            // Own reward: reaching the task takes at least (d - jump) / v of travel
+            Score own = std::pow(lambda, std::max(0.0, distance - bounds.jump) / velocity + duration);
+
+            // Later tasks can only get earlier if the detour is negative (entry and exit differ)
+            double shift = std::min(0.0, detour) / velocity;
+            Score later = bounds.score * (std::pow(lambda, shift) - 1.0);
+
+            return own + later;
+        }
+    };
+
+} // namespace consens::cbba
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace consens::cbba {
+
+    // Boost geometry types for R-tree
+    namespace bg = boost::geometry;
+    namespace bgi = boost::geometry::index;
+
+    using BoostPoint = bg::model::point<double, 2, bg::cs::cartesian>;
+    using BoostBox = bg::model::box<BoostPoint>;
+
+    /**
+     * Value stored in the index: (BoundingBox, task handle)
+     */
+    using RTreeValue = std::pair<BoostBox, TaskIndex>;
+
+    template <typename Signature> class FunctionRef;
+
+    /**
+     * Non-owning reference to a callable, used for query callbacks
+     * Cheaper than std::function: never allocates, just a context pointer and a thunk.
+     * The referenced callable must outlive the FunctionRef.
+     */
+    template <typename R, typename... Args> class FunctionRef<R(Args...)> {
+      private:
+        void *context_;
+        R (*call_)(void *, Args...);
+
+      public:
+        template <typename Fn>
+            requires(!std::is_same_v<std::remove_cv_t<Fn>, FunctionRef>)
+        FunctionRef(Fn &fn)
+            : context_(&fn),
+              call_([](void *context, Args... args) -> R { return (*static_cast<Fn *>(context))(args...); }) {}
+
+        R operator()(Args... args) const { return call_(context_, args...); }
+    };
+
+    /**
+     * Called with each task handle found by a box query
+     */
+    using TaskVisitor = FunctionRef<void(TaskIndex)>;
+
+    /**
+     * Called with (task handle, distance to its box) in non-decreasing distance order
+     * Return false to stop the traversal
+     */
+    using NearestVisitor = FunctionRef<bool(TaskIndex, double)>;
+
+    /**
+     * Storage backend for SpatialIndex
+     * Holds (box, handle) pairs and answers box and nearest queries; task data and
+     * exact distance filtering stay in SpatialIndex.
+     */
+    class SpatialBackend {
+      public:
+        virtual ~SpatialBackend() = default;
+
+        /**
+         * Insert one entry
+         */
+        virtual void insert(const RTreeValue &value) = 0;
+
+        /**
+         * Insert a batch of entries
+         * Backends may rebuild themselves (e.g. R-tree packing) when that is cheaper
+         * @param values Entries to insert (may be consumed)
+         */
+        virtual void insert_bulk(std::vector<RTreeValue> &values) = 0;
+
+        /**
+         * Remove an entry (box must match the inserted one)
+         * @return True if the entry was found
+         */
+        virtual bool remove(const RTreeValue &value) = 0;
+
+        /**
+         * Remove all entries
+         */
+        virtual void clear() = 0;
+
+        /**
+         * Get number of entries
+         */
+        virtual size_t size() const = 0;
+
+        /**
+         * Append handles of all entries intersecting a box
+         */
+        virtual void query_box(const BoostBox &box, std::vector<TaskIndex> &out) const = 0;
+
+        /**
+         * Call visit for every entry intersecting a box, without collecting results
+         * Lets callers filter during the traversal instead of on a candidate vector
+         */
+        virtual void visit_box(const BoostBox &box, TaskVisitor visit) const = 0;
+
+        /**
+         * Append handles of the k entries nearest to a point, closest first
+         * Distance is measured to the entry's box (zero inside)
+         */
+        virtual void query_nearest(const BoostPoint &point, size_t k, std::vector<TaskIndex> &out) const = 0;
+
+        /**
+         * Stream entries closest first until the visitor returns false
+         * Entries are produced incrementally, so stopping early skips the rest of the index
+         */
+        virtual void visit_nearest(const BoostPoint &point, NearestVisitor visit) const = 0;
+    };
+
+    /**
+     * Create a backend for the given configuration
+     */
+    std::unique_ptr<SpatialBackend> make_spatial_backend(const SpatialIndexConfig &config);
+
+} // namespace consens::cbba
@@ -1,58 +1,89 @@
 #pragma once
 
 #include "../task.hpp"
+#include "id_table.hpp"
+#include "spatial_backend.hpp"
+#include "task_store.hpp"
 #include "types.hpp"
 
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/box.hpp>
-#include <boost/geometry/geometries/point.hpp>
-#include <boost/geometry/index/rtree.hpp>
-
-#include <map>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace consens::cbba {
 
-    // Boost geometry types for R-tree
-    namespace bg = boost::geometry;
-    namespace bgi = boost::geometry::index;
-
-    using BoostPoint = bg::model::point<double, 2, bg::cs::cartesian>;
-    using BoostBox = bg::model::box<BoostPoint>;
-
-    /**
-     * Value stored in R-tree: (BoundingBox, pointer to TaskID string)
-     * We use a pointer to avoid copies
-     */
-    using RTreeValue = std::pair<BoostBox, const TaskID *>;
-
     /**
-     * R-tree type using quadratic split algorithm
+     * Radius query result: (task handle, distance to the task)
      */
-    using RTree = bgi::rtree<RTreeValue, bgi::quadratic<16>>;
+    using TaskDistance = std::pair<TaskIndex, double>;
 
     /**
-     * Spatial index for efficient task queries using R-tree
-     * Wraps boost::geometry R-tree for spatial operations
+     * Spatial index for efficient task queries
+     * Wraps a SpatialBackend (boost::geometry R-tree variants or a uniform grid)
+     *
+     * Task data lives in a TaskStore; the R-tree only holds handles. The store is either
+     * owned by the index (default constructor) or shared with the caller, in which case
+     * the index tracks which of the store's tasks are currently indexed.
      */
     class SpatialIndex {
       private:
-        std::unique_ptr<RTree> rtree_;
-        std::map<TaskID, Task> tasks_;
+        std::unique_ptr<TaskStore> owned_store_;
+        TaskStore *store_;
+        std::unique_ptr<SpatialBackend> backend_;
+        std::vector<uint8_t> indexed_; // 1 if task handle is in the backend
+        size_t count_;
+        uint64_t revision_; // Bumped on every change to the indexed set
+        std::vector<uint64_t> task_revisions_; // Revision of the last change to each task
 
       public:
-        SpatialIndex();
+        /**
+         * Create an index with its own task store
+         * @param config Backend selection
+         */
+        explicit SpatialIndex(const SpatialIndexConfig &config = SpatialIndexConfig());
+
+        /**
+         * Create an index over an external task store
+         * @param store Store holding the task data (must outlive the index)
+         * @param config Backend selection
+         */
+        explicit SpatialIndex(TaskStore &store, const SpatialIndexConfig &config = SpatialIndexConfig());
+
         ~SpatialIndex();
 
+        SpatialIndex(const SpatialIndex &) = delete;
+        SpatialIndex &operator=(const SpatialIndex &) = delete;
+
         /**
          * Insert a task into the spatial index
+         * Writes the task into the store, replacing any previous version
          */
         void insert(const Task &task);
 
+        /**
+         * Index a task that is already in the store
+         */
+        void insert(TaskIndex task);
+
+        /**
+         * Insert a batch of tasks
+         * Writes the tasks into the store, then indexes them as one batch (see below)
+         */
+        void insert(std::span<const Task> tasks);
+
+        /**
+         * Index a batch of tasks that are already in the store
+         * R-tree backends rebuild with boost's packing (STR bulk-load) constructor when the
+         * batch is at least as large as the current tree, instead of one insert per task
+         */
+        void insert(std::span<const TaskIndex> tasks);
+
         /**
          * Remove a task from the spatial index
+         * An owned store also drops the task data; a shared store keeps it
          */
+        void remove(TaskIndex task);
         void remove(const TaskID &task_id);
 
         /**
@@ -60,6 +91,26 @@ namespace consens::cbba {
          */
         void clear();
 
+        /**
+         * Revision of the indexed set
+         * Changes whenever a task is indexed, re-indexed or removed, so callers can tell
+         * whether results derived from task geometry are still current
+         */
+        uint64_t revision() const { return revision_; }
+
+        /**
+         * Revision at which a task was last indexed, re-indexed or removed (0 if never)
+         * Lets caches of per-task results invalidate only the tasks that changed
+         */
+        uint64_t task_revision(TaskIndex task) const {
+            return task < task_revisions_.size() ? task_revisions_[task] : 0;
+        }
+
+        /**
+         * Get the backing task store
+         */
+        const TaskStore &get_store() const { return *store_; }
+
         /**
          * Query K nearest tasks to a point
          * @param position Query point
@@ -70,12 +121,43 @@ namespace consens::cbba {
 
         /**
          * Query tasks within a radius
+         * Distance is measured with Task::distance_to, i.e. to the closest point of a
+         * geometric task's segment rather than its centre
          * @param position Center point
          * @param radius Search radius (meters)
          * @return Vector of task IDs within radius
          */
         std::vector<TaskID> query_radius(const Point &position, double radius) const;
 
+        /**
+         * Query tasks within a radius (handles)
+         * @param position Center point
+         * @param radius Search radius (meters)
+         * @param out Receives task handles within radius (cleared first)
+         */
+        void query_radius(const Point &position, double radius, std::vector<TaskIndex> &out) const;
+
+        /**
+         * Query tasks within a radius, with their distances
+         * The distance filter runs inside the index traversal, so no candidate list is built.
+         * @param position Center point
+         * @param radius Search radius (meters)
+         * @param out Receives (handle, distance) pairs within radius (cleared first, capacity reused)
+         */
+        void query_radius(const Point &position, double radius, std::vector<TaskDistance> &out) const;
+
+        /**
+         * Stream indexed tasks in order of increasing distance until fn returns false
+         * The distance passed is to the task's bounding box, a lower bound on Task::distance_to.
+         * Tasks are produced lazily by the backend, so stopping early skips the rest of the index.
+         * @param position Query point
+         * @param fn Callable taking (TaskIndex, double lower_bound_distance), returning bool (continue)
+         */
+        template <typename Fn> void visit_nearest(const Point &position, Fn &&fn) const {
+            auto visit = [&](TaskIndex task, double distance) -> bool { return fn(task, distance); };
+            backend_->visit_nearest(to_boost_point(position), visit);
+        }
+
         /**
          * Query tasks within a bounding box
          * @param bbox Bounding box to query
@@ -87,11 +169,21 @@ namespace consens::cbba {
          * Get task by ID
          * @return Task if found, std::nullopt otherwise
          */
+        std::optional<Task> get_task(TaskIndex task) const;
         std::optional<Task> get_task(const TaskID &id) const;
 
+        /**
+         * Get non-owning access to an indexed task (no copy)
+         * The pointer stays valid until the task is re-inserted or removed
+         * @return Pointer to task, or nullptr if not indexed
+         */
+        const Task *find_task(TaskIndex task) const { return is_indexed(task) ? store_->get(task) : nullptr; }
+        const Task *find_task(const TaskID &id) const { return find_task(task_ids().find(id)); }
+
         /**
          * Check if task exists
          */
+        bool has_task(TaskIndex task) const;
         bool has_task(const TaskID &id) const;
 
         /**
@@ -115,6 +207,16 @@ namespace consens::cbba {
         std::vector<Task> get_all_tasks() const;
 
       private:
+        /**
+         * Check if a task handle is in the backend
+         */
+        bool is_indexed(TaskIndex task) const { return task < indexed_.size() && indexed_[task]; }
+
+        /**
+         * Record the current revision as the task's last change
+         */
+        void set_task_revision(TaskIndex task);
+
         /**
          * Convert consens Point to boost Point
          */
@@ -129,6 +231,23 @@ namespace consens::cbba {
          * Create boost Box from task
          */
         static BoostBox task_to_boost_box(const Task &task);
+
+        /**
+         * Visit every indexed task within radius of a point
+         * @param fn Callable taking (TaskIndex, double distance)
+         */
+        template <typename Fn> void visit_radius(const Point &position, double radius, Fn &&fn) const {
+            BoostBox query_box(BoostPoint(position.x - radius, position.y - radius),
+                               BoostPoint(position.x + radius, position.y + radius));
+
+            auto filter = [&](TaskIndex task) {
+                double dist = store_->get(task)->distance_to(position);
+                if (dist <= radius) {
+                    fn(task, dist);
+                }
+            };
+            backend_->visit_box(query_box, filter);
+        }
     };
 
 } // namespace consens::cbba
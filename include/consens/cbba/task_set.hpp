@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Set of tasks as a bitset over TaskIndex
+     * Insert, erase and membership are O(1); memory is one bit per handle up to the largest member.
+     */
+    class TaskSet {
+      private:
+        std::vector<uint64_t> words_;
+        size_t count_ = 0;
+
+      public:
+        TaskSet() = default;
+
+        /**
+         * Add a task (no-op for NO_TASK or if already present)
+         */
+        void insert(TaskIndex task) {
+            if (task == NO_TASK) {
+                return;
+            }
+            size_t word = task / 64;
+            if (word >= words_.size()) {
+                words_.resize(word + 1, 0);
+            }
+            uint64_t bit = uint64_t{1} << (task % 64);
+            if (!(words_[word] & bit)) {
+                words_[word] |= bit;
+                count_++;
+            }
+        }
+
+        /**
+         * Remove a task (no-op if missing)
+         */
+        void erase(TaskIndex task) {
+            if (!contains(task)) {
+                return;
+            }
+            words_[task / 64] &= ~(uint64_t{1} << (task % 64));
+            count_--;
+        }
+
+        /**
+         * Check if a task is in the set
+         */
+        bool contains(TaskIndex task) const {
+            size_t word = task / 64;
+            return word < words_.size() && (words_[word] >> (task % 64)) & 1u;
+        }
+
+        /**
+         * Remove all tasks (keeps capacity)
+         */
+        void clear() {
+            std::fill(words_.begin(), words_.end(), 0);
+            count_ = 0;
+        }
+
+        size_t size() const { return count_; }
+        bool empty() const { return count_ == 0; }
+
+        /**
+         * Visit every task in handle order
+         * @param fn Callable taking TaskIndex
+         */
+        template <typename Fn> void for_each(Fn &&fn) const {
+            for (size_t word = 0; word < words_.size(); ++word) {
+                uint64_t bits = words_[word];
+                while (bits) {
+                    fn(static_cast<TaskIndex>(word * 64 + std::countr_zero(bits)));
+                    bits &= bits - 1;
+                }
+            }
+        }
+    };
+
+} // namespace consens::cbba
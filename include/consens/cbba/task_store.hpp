@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../task.hpp"
+#include "id_table.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Authoritative task storage indexed by TaskIndex
+     *
+     * Tasks live in one contiguous vector slot per handle. Everything else (spatial
+     * index, bundle builder, algorithm) refers to tasks by handle instead of keeping
+     * its own copy.
+     *
+     * The store holds a reference on the handle of every task it contains (see
+     * IdTable::acquire), so removing a task lets its handle be reused once no other store
+     * holds it. Whoever keeps per-task state must drop it before removing the task.
+     */
+    class TaskStore {
+      private:
+        std::vector<Task> tasks_;
+        std::vector<uint8_t> present_; // 1 if slot holds a task
+        size_t count_;
+
+      public:
+        TaskStore() : count_(0) {}
+        ~TaskStore() { clear(); }
+
+        TaskStore(const TaskStore &) = delete;
+        TaskStore &operator=(const TaskStore &) = delete;
+
+        /**
+         * Insert or replace a task
+         * @return Handle of the task
+         */
+        TaskIndex insert(const Task &task);
+
+        /**
+         * Remove a task (no-op if missing); its handle may be recycled afterwards
+         * @return True if a task was removed
+         */
+        bool remove(TaskIndex task);
+
+        /**
+         * Remove all tasks
+         */
+        void clear();
+
+        /**
+         * Get task by handle
+         * @return Pointer to task, or nullptr if missing
+         */
+        const Task *get(TaskIndex task) const { return contains(task) ? &tasks_[task] : nullptr; }
+
+        Task *get(TaskIndex task) { return contains(task) ? &tasks_[task] : nullptr; }
+
+        /**
+         * Check if task exists
+         */
+        bool contains(TaskIndex task) const { return task < present_.size() && present_[task]; }
+
+        /**
+         * Get number of tasks
+         */
+        size_t size() const { return count_; }
+
+        /**
+         * Check if store is empty
+         */
+        bool empty() const { return count_ == 0; }
+
+        /**
+         * One past the largest handle that may hold a task
+         */
+        size_t slot_count() const { return present_.size(); }
+
+        /**
+         * Visit every task in handle order
+         * @param fn Callable taking (TaskIndex, const Task &)
+         */
+        template <typename Fn> void for_each(Fn &&fn) const {
+            for (TaskIndex i = 0; i < present_.size(); ++i) {
+                if (present_[i]) {
+                    fn(i, tasks_[i]);
+                }
+            }
+        }
+    };
+
+} // namespace consens::cbba
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../task.hpp"
+#include "spatial_index.hpp"
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace consens::cbba {
+
+    /**
+     * Travel distance between two points (e.g. a shortest path on a road graph)
+     *
+     * Distances must never be shorter than the straight line: the spatial pruning in
+     * BasicBundleBuilder bounds insertion gains by straight-line geometry. They need not obey
+     * the triangle inequality through a task: going around the ends of a row may cost far
+     * more than driving it.
+     */
+    class TravelCostModel {
+      public:
+        virtual ~TravelCostModel() = default;
+
+        /**
+         * Travel distance from one point to another (meters)
+         */
+        virtual double distance(const Point &from, const Point &to) const = 0;
+    };
+
+    /**
+     * Straight-line distance (what the scorer uses when no model is set)
+     */
+    class EuclideanCostModel final : public TravelCostModel {
+      public:
+        double distance(const Point &from, const Point &to) const override { return from.distance_to(to); }
+    };
+
+    /**
+     * Memoised travel distances for a TravelCostModel
+     *
+     * Every leg the scorer evaluates ends at a task entry and starts at a task exit or at the
+     * agent; which end of a geometric task that is depends on its direction. Task-to-task legs
+     * are kept in an LRU table keyed by both handles and directions (legs touching a handle of
+     * 2^31 or above do not fit that key and are computed uncached); legs from the agent are kept
+     * per task and direction while the agent stays put. Each entry remembers
+     * SpatialIndex::task_revision of its tasks, so re-indexing or removing a task only
+     * invalidates the legs touching it (recomputed on their next lookup).
+     */
+    class TravelCostCache {
+      private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+        static constexpr TaskIndex CACHED_TASKS = TaskIndex{1} << 31; // Handles end() can encode
+
+        struct Leg {
+            uint64_t key; // end(from) << 32 | end(to)
+            uint64_t from_revision;
+            uint64_t to_revision;
+            double distance;
+            uint32_t prev; // LRU neighbours (towards head_ = most recently used)
+            uint32_t next;
+        };
+
+        struct OriginLeg {
+            double distance;
+            uint64_t revision;
+            uint32_t generation; // Valid only if it matches origin_generation_
+        };
+
+        std::shared_ptr<const TravelCostModel> model_;
+        const SpatialIndex *spatial_index_;
+        size_t capacity_;
+
+        std::vector<Leg> legs_;
+        std::unordered_map<uint64_t, uint32_t> slots_; // Key -> index in legs_
+        uint32_t head_;
+        uint32_t tail_;
+
+        std::vector<OriginLeg> origin_legs_; // Indexed by end(task)
+        Point origin_;
+        uint32_t origin_generation_;
+
+        size_t hits_;
+        size_t misses_;
+
+      public:
+        /**
+         * Constructor
+         * @param model Cost model (shared, must not be null)
+         * @param spatial_index Index holding the tasks (for per-task revisions, must outlive the cache)
+         * @param capacity Maximum number of task-to-task legs kept (at least 1)
+         */
+        TravelCostCache(std::shared_ptr<const TravelCostModel> model, const SpatialIndex &spatial_index,
+                        size_t capacity = DEFAULT_TRAVEL_CACHE_CAPACITY);
+
+        /**
+         * Travel distance of one leg
+         *
+         * @param from Task whose exit the leg starts at, or NO_TASK for the agent position
+         * @param from_direction Direction `from` is traversed in (ignored for the agent)
+         * @param from_point Exit point of `from`, or the agent position
+         * @param to Task whose entry the leg ends at
+         * @param to_direction Direction `to` is traversed in
+         * @param to_point Entry point of `to`
+         * @return Distance (meters)
+         */
+        double distance(TaskIndex from, Direction from_direction, const Point &from_point, TaskIndex to,
+                        Direction to_direction, const Point &to_point);
+
+        /**
+         * Drop all legs
+         */
+        void clear();
+
+        const std::shared_ptr<const TravelCostModel> &get_model() const { return model_; }
+        size_t capacity() const { return capacity_; }
+        size_t size() const { return legs_.size(); }
+
+        /**
+         * Lookup statistics (for monitoring and tests)
+         */
+        size_t hits() const { return hits_; }
+        size_t misses() const { return misses_; }
+
+      private:
+        /**
+         * Dense key of a task traversed in a direction (task below CACHED_TASKS)
+         */
+        static uint32_t end(TaskIndex task, Direction direction) {
+            return (task << 1) | (direction == Direction::REVERSE ? 1u : 0u);
+        }
+
+        /**
+         * Distance from the agent position to a task entry
+         */
+        double origin_distance(const Point &origin, uint32_t to_end, const Point &to_point, uint64_t to_revision);
+
+        /**
+         * Drop all legs from the agent position (O(1))
+         */
+        void drop_origin_legs();
+
+        /**
+         * Move a leg to the head of the LRU list
+         */
+        void touch(uint32_t index);
+
+        void unlink(uint32_t index);
+    };
+
+} // namespace consens::cbba
@@ -2,16 +2,49 @@
 
 #include "../types.hpp"
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
 namespace consens::cbba {
 
     // Re-export common types
     using consens::AgentID;
+    using consens::Direction;
     using consens::Point;
     using consens::Pose;
     using consens::Score;
     using consens::TaskID;
     using consens::Timestamp;
 
+    /**
+     * Dense integer handle for a task (see IdTable)
+     * All internal CBBA state is keyed by this instead of TaskID
+     */
+    using TaskIndex = uint32_t;
+
+    /**
+     * Dense integer handle for an agent (see IdTable)
+     */
+    using AgentIndex = uint32_t;
+
+    /**
+     * Sentinel handle (unknown task / unassigned agent)
+     */
+    constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * Handle used for tasks that are not known
+     */
+    constexpr TaskIndex NO_TASK = INVALID_INDEX;
+
+    /**
+     * Handle used for unassigned tasks (counterpart of NO_AGENT)
+     */
+    constexpr AgentIndex NO_AGENT_INDEX = INVALID_INDEX;
+
     /**
      * Scoring metric for CBBA
      */
@@ -28,6 +61,58 @@ namespace consens::cbba {
         FULLBUNDLE // Build full bundle in one iteration (baseline CBBA)
     };
 
+    /**
+     * How the neighbor messages of one consensus phase are applied
+     */
+    enum class ConsensusMode {
+        SEQUENTIAL, // Resolve each message in turn - default
+        BATCHED     // Reduce all messages per task first, then update and reset once
+    };
+
+    /**
+     * Spatial index backend
+     */
+    enum class SpatialIndexType {
+        QUADRATIC, // R-tree, quadratic split - default
+        LINEAR,    // R-tree, linear split (fastest inserts, looser nodes)
+        RSTAR,     // R*-tree (slowest inserts, tightest nodes and fastest queries)
+        GRID       // Hashed uniform grid (dense, regular fields such as crop rows)
+    };
+
+    /**
+     * Spatial index configuration
+     */
+    struct SpatialIndexConfig {
+        SpatialIndexType type = SpatialIndexType::QUADRATIC;
+        size_t node_size = 16;        // Max entries per R-tree node
+        double grid_cell_size = 10.0; // Grid cell edge length (meters)
+    };
+
+    /**
+     * Best way to insert a task into a path
+     */
+    struct Insertion {
+        Score score = 0.0;                        // Marginal gain
+        size_t position = 0;                      // Path position the task goes to
+        Direction direction = Direction::FORWARD; // Traversal of the task
+    };
+
+    /**
+     * One task of a path, with the direction it is traversed in
+     */
+    struct PathStep {
+        TaskIndex task;
+        Direction direction;
+    };
+
+    class TravelCostModel; // travel_cost.hpp
+    class Executor;        // executor.hpp
+
+    /**
+     * Default number of task-to-task legs kept by a TravelCostCache
+     */
+    constexpr size_t DEFAULT_TRAVEL_CACHE_CAPACITY = 1 << 16;
+
     /**
      * CBBA algorithm configuration
      */
@@ -39,15 +124,23 @@ namespace consens::cbba {
 
         // Spatial filtering
         float spatial_query_radius = 100.0f; // meters
+        SpatialIndexConfig spatial_index;
 
         // Algorithm parameters
         BundleMode bundle_mode = BundleMode::ADD;
         size_t consensus_iterations_per_bundle = 1;
+        ConsensusMode consensus_mode = ConsensusMode::SEQUENTIAL;
         size_t max_iterations = 1000;
 
         // Scoring
         Metric metric = Metric::RPT;
         double lambda = 0.95; // Discount factor for TDR metric
+        double bid_cache_pose_epsilon = 0.0; // meters; motion within this keeps cached bids (0 = exact)
+        std::shared_ptr<const TravelCostModel> travel_cost_model; // nullptr = straight-line travel
+        size_t travel_cost_cache_capacity = DEFAULT_TRAVEL_CACHE_CAPACITY; // Task-to-task legs kept
+        std::shared_ptr<Executor> executor; // Scores bundle candidates in parallel (nullptr = serial)
+        std::chrono::microseconds path_improvement_budget{0}; // 2-opt / Or-opt reordering per tick (0 = off)
+        std::chrono::microseconds bundle_build_budget{0}; // FULLBUNDLE filling per tick, resumed next tick (0 = unlimited)
 
         // Convergence
         bool enable_convergence_detection = true;
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "cbba/types.hpp"
 #include "task.hpp"
 #include "types.hpp"
 
 #include <map>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace consens {
@@ -28,6 +30,12 @@ namespace consens {
             float spatial_query_radius = 100.0f;
             bool enable_logging = true;
 
+            // Everything else for the default CBBA algorithm (bundle mode, metric, travel cost
+            // model, executor, budgets, consensus mode, ...). max_bundle_size,
+            // spatial_query_radius and enable_logging above override the same fields here.
+            // Ignored when a custom algorithm is passed in
+            cbba::CBBAConfig cbba;
+
             // Communication callbacks
             SendCallback send_message;
             ReceiveCallback receive_messages;
@@ -89,6 +97,12 @@ namespace consens {
          */
         void add_task(const Task &task);
 
+        /**
+         * Add a batch of tasks (e.g. a whole mission) in one call
+         * Much faster than repeated add_task for large task sets
+         */
+        void add_tasks(std::span<const Task> tasks);
+
         /**
          * Remove a task (completed or canceled)
          */
@@ -129,6 +143,17 @@ namespace consens {
          */
         std::optional<TaskID> get_next_task() const;
 
+        /**
+         * Get current path with the end each task is entered from
+         * Geometric tasks (rows) can be driven tail -> head (Direction::REVERSE)
+         */
+        std::vector<TaskStep> get_path_steps() const;
+
+        /**
+         * Get next task to execute (first in path), with the direction to drive it in
+         */
+        std::optional<TaskStep> get_next_step() const;
+
         /**
          * Get task details by ID
          */
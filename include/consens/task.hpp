@@ -35,6 +35,17 @@ namespace consens {
         bool has_geometry() const { return has_geometry_; }
         const BoundingBox &get_bbox() const { return bbox_; }
 
+        /**
+         * Point where work on the task starts / ends when traversed in a direction
+         * Point tasks start and end at their position in either direction
+         */
+        const Point &get_entry(Direction direction = Direction::FORWARD) const {
+            return direction == Direction::REVERSE ? tail_ : head_;
+        }
+        const Point &get_exit(Direction direction = Direction::FORWARD) const {
+            return direction == Direction::REVERSE ? head_ : tail_;
+        }
+
         // Setters
         void set_completed(bool completed) { completed_ = completed; }
         void set_duration(double duration) { duration_ = duration; }
@@ -44,6 +55,13 @@ namespace consens {
          */
         double get_length() const;
 
+        /**
+         * Distance from a point to the task
+         * Geometric tasks measure to the closest point on the head-tail segment,
+         * point tasks to their position
+         */
+        double distance_to(const Point &point) const;
+
       private:
         TaskID id_;
 
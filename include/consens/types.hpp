@@ -73,6 +73,32 @@ namespace consens {
         Pose(double x, double y, double h) : position(x, y), heading(h) {}
     };
 
+    /**
+     * Traversal direction of a geometric task
+     */
+    enum class Direction : uint8_t {
+        FORWARD, // Head -> tail - default
+        REVERSE  // Tail -> head
+    };
+
+    /**
+     * Direction that traverses a task the other way round
+     */
+    inline Direction opposite(Direction direction) {
+        return direction == Direction::FORWARD ? Direction::REVERSE : Direction::FORWARD;
+    }
+
+    /**
+     * One task of an execution path, with the direction the agent drives it in
+     * REVERSE means the task is entered at its tail (see Task::get_entry)
+     */
+    struct TaskStep {
+        TaskID task;
+        Direction direction = Direction::FORWARD;
+
+        bool operator==(const TaskStep &other) const = default;
+    };
+
     /**
      * Axis-aligned bounding box for spatial indexing
      */
@@ -0,0 +1,73 @@
+#include "consens/cbba/bid_cache.hpp"
+
+#include <algorithm>
+
+namespace consens::cbba {
+
+    BidCache::BidCache(double pose_epsilon)
+        : generation_(1), pose_epsilon_(pose_epsilon), agent_(NO_AGENT_INDEX), path_version_(0), velocity_(0.0),
+          path_revision_(0), hits_(0), misses_(0) {}
+
+    bool BidCache::validate(const CBBAAgent &agent, const SpatialIndex &spatial_index) {
+        const Point &position = agent.get_pose().position;
+
+        // Every insertion is scored against the path legs, so a re-indexed path task drops all
+        uint64_t path_revision = 0;
+        for (TaskIndex task : agent.get_path().indices()) {
+            path_revision = std::max(path_revision, spatial_index.task_revision(task));
+        }
+
+        bool unchanged = agent.get_handle().index() == agent_ && agent.get_path().version() == path_version_ &&
+                         agent.get_velocity() == velocity_ && path_revision == path_revision_ &&
+                         position.distance_to(position_) <= pose_epsilon_;
+        if (unchanged) {
+            return true;
+        }
+
+        invalidate();
+        agent_ = agent.get_handle().index();
+        path_version_ = agent.get_path().version();
+        position_ = position;
+        velocity_ = agent.get_velocity();
+        path_revision_ = path_revision;
+        return false;
+    }
+
+    bool BidCache::lookup(TaskIndex task, uint64_t task_revision, Insertion &insertion) {
+        if (task >= entries_.size() || entries_[task].generation != generation_ ||
+            entries_[task].task_revision != task_revision) {
+            misses_++;
+            return false;
+        }
+
+        const Entry &entry = entries_[task];
+        insertion = Insertion{entry.score, entry.position, entry.reversed ? Direction::REVERSE : Direction::FORWARD};
+        hits_++;
+        return true;
+    }
+
+    void BidCache::store(TaskIndex task, uint64_t task_revision, const Insertion &insertion) {
+        if (task == NO_TASK) {
+            return;
+        }
+        if (task >= entries_.size()) {
+            entries_.resize(static_cast<size_t>(task) + 1, Entry{0.0, 0, 0, 0, 0});
+        }
+        entries_[task] = Entry{insertion.score, static_cast<uint32_t>(insertion.position),
+                               insertion.direction == Direction::REVERSE ? 1u : 0u, generation_, task_revision};
+    }
+
+    void BidCache::invalidate() {
+        // Generation 0 marks never-written entries; reset them all on wrap-around
+        if (++generation_ == 0) {
+            std::fill(entries_.begin(), entries_.end(), Entry{0.0, 0, 0, 0, 0});
+            generation_ = 1;
+        }
+    }
+
+    void BidCache::set_pose_epsilon(double epsilon) {
+        pose_epsilon_ = epsilon;
+        invalidate();
+    }
+
+} // namespace consens::cbba
@@ -1,136 +1,57 @@
 #include "consens/cbba/bundle_builder.hpp"
 
-#include <algorithm>
-
 namespace consens::cbba {
 
-    BundleBuilder::BundleBuilder(SpatialIndex *spatial_index, Metric metric, float query_radius, BundleMode mode)
-        : scorer_(metric), spatial_index_(spatial_index), query_radius_(query_radius), mode_(mode) {}
-
-    void BundleBuilder::build_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks) {
-        if (mode_ == BundleMode::ADD) {
-            add_one_task(agent, available_tasks);
-        } else {
-            fill_bundle(agent, available_tasks);
-        }
-    }
+    template class BasicBundleBuilder<RptPolicy>;
+    template class BasicBundleBuilder<TdrPolicy>;
 
-    std::vector<TaskID> BundleBuilder::get_candidates(const CBBAAgent &agent,
-                                                      const std::vector<TaskID> &available_tasks) const {
-        std::vector<TaskID> candidates;
-
-        // Get agent's current position
-        Point agent_pos = agent.get_pose().position;
-
-        // Query spatial index for nearby tasks
-        std::vector<TaskID> nearby_tasks = spatial_index_->query_radius(agent_pos, query_radius_);
-
-        // Filter to only include available tasks
-        for (const auto &task_id : nearby_tasks) {
-            if (std::find(available_tasks.begin(), available_tasks.end(), task_id) != available_tasks.end()) {
-                candidates.push_back(task_id);
-            }
-        }
+    BundleBuilder::BundleBuilder(SpatialIndex *spatial_index, Metric metric, float query_radius, BundleMode mode,
+                                 double pose_epsilon)
+        : builder_(make_builder(metric, spatial_index, query_radius, mode, pose_epsilon)) {}
 
-        return candidates;
+    void BundleBuilder::build_bundle(CBBAAgent &agent, const TaskSet &available) {
+        std::visit([&](auto &builder) { builder.build_bundle(agent, available); }, builder_);
     }
 
-    std::tuple<TaskID, Score, size_t> BundleBuilder::find_best_task(const CBBAAgent &agent,
-                                                                    const std::vector<TaskID> &candidates) {
-        TaskID best_task_id = "";
-        Score best_score = MIN_SCORE;
-        size_t best_position = 0;
-
-        // Try each candidate task
-        for (const auto &task_id : candidates) {
-            // Skip if already in bundle
-            if (agent.get_bundle().contains(task_id)) {
-                continue;
-            }
-
-            // Get task from spatial index
-            auto task_opt = spatial_index_->get_task(task_id);
-            if (!task_opt) {
-                continue;
-            }
-
-            const Task &task = *task_opt;
-
-            // Find optimal insertion position and score
-            auto [score, position] = scorer_.find_optimal_insertion(agent, task, agent.get_path(), *spatial_index_);
-
-            // Check if this is better
-            if (score > best_score) {
-                best_score = score;
-                best_task_id = task_id;
-                best_position = position;
-            }
-        }
-
-        return {best_task_id, best_score, best_position};
+    void BundleBuilder::build_bundle(CBBAAgent &agent, const std::vector<TaskIndex> &available_tasks) {
+        std::visit([&](auto &builder) { builder.build_bundle(agent, available_tasks); }, builder_);
     }
 
-    bool BundleBuilder::should_bid(const CBBAAgent &agent, const TaskID &task_id, Score my_bid) const {
-        // Get current winning bid for this task
-        Bid winning_bid = agent.get_winning_bid(task_id);
-
-        // If no winner yet, we should bid
-        if (!winning_bid.is_valid()) {
-            return true;
-        }
-
-        // Create our bid
-        Bid our_bid(agent.get_id(), my_bid, agent.get_timestamp(agent.get_id()));
-
-        // Bid if ours is better
-        return our_bid > winning_bid;
+    void BundleBuilder::build_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks) {
+        std::visit([&](auto &builder) { builder.build_bundle(agent, available_tasks); }, builder_);
     }
 
-    bool BundleBuilder::add_one_task(CBBAAgent &agent, const std::vector<TaskID> &available_tasks) {
-        // Check if bundle is full
-        if (agent.get_bundle().is_full()) {
-            return false;
-        }
-
-        // Get candidate tasks using spatial filtering
-        auto candidates = get_candidates(agent, available_tasks);
-
-        if (candidates.empty()) {
-            return false;
-        }
-
-        // Find best task to add
-        auto [best_task_id, best_score, best_position] = find_best_task(agent, candidates);
-
-        // Check if we found a valid task
-        if (best_task_id.empty()) {
-            return false;
-        }
-
-        // Check if we should bid on this task
-        if (!should_bid(agent, best_task_id, best_score)) {
-            return false;
-        }
-
-        // Add task to bundle
-        agent.add_to_bundle(best_task_id, best_score, best_position);
-
-        return true;
+    void BundleBuilder::set_metric(Metric metric) {
+        if (metric == get_metric()) {
+            return;
+        }
+
+        // Same settings, new policy (and an empty bid cache)
+        SpatialIndex *spatial_index =
+            std::visit([](const auto &builder) { return builder.get_spatial_index(); }, builder_);
+        const TravelCostCache *travel_costs = get_travel_costs();
+        std::shared_ptr<const TravelCostModel> model = travel_costs ? travel_costs->get_model() : nullptr;
+        size_t capacity = travel_costs ? travel_costs->capacity() : DEFAULT_TRAVEL_CACHE_CAPACITY;
+        Executor *executor = get_executor();
+        std::chrono::microseconds budget = get_path_improver().get_budget();
+        std::chrono::microseconds build_budget = get_build_budget();
+
+        builder_ = make_builder(metric, spatial_index, get_query_radius(), get_mode(),
+                                get_bid_cache().get_pose_epsilon());
+        if (model) {
+            set_travel_cost_model(std::move(model), capacity);
+        }
+        set_executor(executor);
+        set_path_improvement_budget(budget);
+        set_build_budget(build_budget);
     }
 
-    size_t BundleBuilder::fill_bundle(CBBAAgent &agent, const std::vector<TaskID> &available_tasks) {
-        size_t added_count = 0;
-
-        // Keep adding tasks until bundle is full or no more tasks can be added
-        while (!agent.get_bundle().is_full()) {
-            bool added = add_one_task(agent, available_tasks);
-            if (!added) {
-                break; // No more tasks to add
-            }
-            added_count++;
+    BundleBuilder::Builder BundleBuilder::make_builder(Metric metric, SpatialIndex *spatial_index, float query_radius,
+                                                       BundleMode mode, double pose_epsilon) {
+        if (metric == Metric::RPT) {
+            return BasicBundleBuilder<RptPolicy>(spatial_index, RptPolicy{}, query_radius, mode, pose_epsilon);
         }
-
-        return added_count;
+        return BasicBundleBuilder<TdrPolicy>(spatial_index, TdrPolicy{}, query_radius, mode, pose_epsilon);
     }
 
 } // namespace consens::cbba
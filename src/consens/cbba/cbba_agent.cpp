@@ -1,106 +1,247 @@
 #include "consens/cbba/cbba_agent.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
+#include <utility>
 
 namespace consens::cbba {
 
+    namespace {
+
+        /**
+         * Compare two winner vectors, treating missing trailing entries as unassigned
+         */
+        bool same_winners(const std::vector<AgentIndex> &a, const std::vector<AgentIndex> &b) {
+            size_t common = std::min(a.size(), b.size());
+            if (common > 0 && std::memcmp(a.data(), b.data(), common * sizeof(AgentIndex)) != 0) {
+                return false;
+            }
+
+            const auto &longer = a.size() > b.size() ? a : b;
+            return std::all_of(longer.begin() + common, longer.end(),
+                               [](AgentIndex winner) { return winner == NO_AGENT_INDEX; });
+        }
+
+    } // namespace
+
+    CBBAAgent::HeldTasks::HeldTasks(const HeldTasks &other) : tasks_(other.tasks_) {
+        // A held handle is live, so acquiring its name returns the same handle
+        tasks_.for_each([](TaskIndex task) { task_ids().acquire(task_ids().name(task)); });
+    }
+
+    CBBAAgent::HeldTasks::HeldTasks(HeldTasks &&other) noexcept : tasks_(std::exchange(other.tasks_, TaskSet())) {}
+
+    CBBAAgent::HeldTasks &CBBAAgent::HeldTasks::operator=(HeldTasks other) noexcept {
+        std::swap(tasks_, other.tasks_);
+        return *this;
+    }
+
+    CBBAAgent::HeldTasks::~HeldTasks() {
+        tasks_.for_each([](TaskIndex task) { task_ids().release(task); });
+    }
+
+    void CBBAAgent::HeldTasks::hold(TaskIndex task) {
+        if (tasks_.contains(task)) {
+            task_ids().release(task);
+            return;
+        }
+        tasks_.insert(task);
+    }
+
+    void CBBAAgent::HeldTasks::release(TaskIndex task) {
+        if (tasks_.contains(task)) {
+            tasks_.erase(task);
+            task_ids().release(task);
+        }
+    }
+
     CBBAAgent::CBBAAgent(const AgentID &id, size_t capacity)
-        : id_(id), velocity_(0.0), bundle_(capacity), converged_(false), bundle_capacity_(capacity) {
+        : id_(id), handle_(id), velocity_(0.0), bundle_(capacity), converged_(false), bundle_capacity_(capacity) {
         // Initialize own timestamp
-        timestamps_[id_] = 0.0;
+        timestamps_[handle_.index()] = 0.0;
     }
 
     void CBBAAgent::update_pose(const Pose &pose) { pose_ = pose; }
 
     void CBBAAgent::update_velocity(double velocity) { velocity_ = velocity; }
 
-    void CBBAAgent::add_to_bundle(const TaskID &task_id, Score bid, size_t position) {
+    void CBBAAgent::ensure_task(TaskIndex task) {
+        if (task < winners_.size()) {
+            return;
+        }
+
+        // std::vector::resize grows capacity geometrically, so this is amortised O(1)
+        size_t size = static_cast<size_t>(task) + 1;
+        bid_scores_.resize(size, MIN_SCORE);
+        winners_.resize(size, NO_AGENT_INDEX);
+        bid_timestamps_.resize(size, 0.0);
+        local_bids_.resize(size, MIN_SCORE);
+    }
+
+    void CBBAAgent::add_to_bundle(TaskIndex task, Score bid, size_t position, Direction direction) {
         // Add to bundle
-        bundle_.add(task_id);
+        bundle_.add(task);
 
         // Insert in path
         if (position == SIZE_MAX) {
             position = path_.size();
         }
-        path_.insert(task_id, position);
+        path_.insert(task, position, direction);
 
         // Update winning bid
-        update_winning_bid(task_id, Bid(id_, bid, timestamps_[id_]));
+        update_winning_bid(task, Bid(handle_, bid, timestamps_[handle_.index()]));
 
         // Store local bid
-        local_bids_[task_id] = bid;
+        set_local_bid(task, bid);
     }
 
-    void CBBAAgent::remove_from_bundle(const TaskID &task_id) {
-        bundle_.remove(task_id);
-        path_.remove(task_id);
+    void CBBAAgent::add_to_bundle(const TaskID &task_id, Score bid, size_t position, Direction direction) {
+        TaskIndex task = task_ids().acquire(task_id);
+        if (task == NO_TASK) {
+            return;
+        }
+        add_to_bundle(task, bid, position, direction);
+        held_.hold(task);
+    }
+
+    void CBBAAgent::remove_from_bundle(TaskIndex task) {
+        bundle_.remove(task);
+        path_.remove(task);
 
         // Note: Don't remove from winning_bids_ or winners_ here
         // Those track global state, not just local bundle
     }
 
-    void CBBAAgent::insert_in_path(const TaskID &task_id, size_t position) { path_.insert(task_id, position); }
+    void CBBAAgent::remove_from_bundle(const TaskID &task_id) { remove_from_bundle(task_ids().find(task_id)); }
+
+    void CBBAAgent::insert_in_path(TaskIndex task, size_t position) { path_.insert(task, position); }
+
+    void CBBAAgent::insert_in_path(const TaskID &task_id, size_t position) {
+        TaskIndex task = task_ids().find(task_id);
+        if (task == NO_TASK) {
+            return;
+        }
+        insert_in_path(task, position);
+    }
+
+    void CBBAAgent::update_winning_bid(TaskIndex task, const Bid &bid) {
+        if (task == NO_TASK) {
+            return;
+        }
+
+        ensure_task(task);
+        bid_scores_[task] = bid.score;
+        winners_[task] = bid.agent_id.index();
+        bid_timestamps_[task] = bid.timestamp;
+    }
 
     void CBBAAgent::update_winning_bid(const TaskID &task_id, const Bid &bid) {
-        winning_bids_[task_id] = bid;
-        winners_[task_id] = bid.agent_id;
+        TaskIndex task = task_ids().find(task_id);
+        if (task == NO_TASK) {
+            return;
+        }
+        update_winning_bid(task, bid);
     }
 
-    void CBBAAgent::reset_task(const TaskID &task_id) {
+    void CBBAAgent::reset_task(TaskIndex task) {
         // Reset to invalid bid
-        winning_bids_[task_id] = Bid::invalid();
-        winners_[task_id] = NO_AGENT;
+        update_winning_bid(task, Bid::invalid());
 
         // Remove from bundle if present
-        remove_from_bundle(task_id);
+        remove_from_bundle(task);
 
         // Also remove from local bids
-        local_bids_.erase(task_id);
+        if (task < local_bids_.size()) {
+            local_bids_[task] = MIN_SCORE;
+        }
+
+        // No state is left for the task, so its handle may be recycled
+        held_.release(task);
     }
 
-    void CBBAAgent::set_local_bid(const TaskID &task_id, Score score) { local_bids_[task_id] = score; }
+    void CBBAAgent::reset_task(const TaskID &task_id) {
+        TaskIndex task = task_ids().find(task_id);
+        if (task == NO_TASK) {
+            return;
+        }
+        reset_task(task);
+    }
+
+    void CBBAAgent::set_local_bid(TaskIndex task, Score score) {
+        if (task == NO_TASK) {
+            return;
+        }
+
+        ensure_task(task);
+        local_bids_[task] = score;
+    }
 
-    Score CBBAAgent::get_local_bid(const TaskID &task_id) const {
-        auto it = local_bids_.find(task_id);
-        if (it != local_bids_.end()) {
-            return it->second;
+    void CBBAAgent::set_local_bid(const TaskID &task_id, Score score) {
+        TaskIndex task = task_ids().find(task_id);
+        if (task == NO_TASK) {
+            return;
+        }
+        set_local_bid(task, score);
+    }
+
+    Score CBBAAgent::get_local_bid(TaskIndex task) const {
+        if (task < local_bids_.size()) {
+            return local_bids_[task];
         }
         return MIN_SCORE;
     }
 
-    void CBBAAgent::update_timestamp(const AgentID &agent_id, Timestamp ts) { timestamps_[agent_id] = ts; }
+    Score CBBAAgent::get_local_bid(const TaskID &task_id) const { return get_local_bid(task_ids().find(task_id)); }
 
-    Timestamp CBBAAgent::get_timestamp(const AgentID &agent_id) const {
-        auto it = timestamps_.find(agent_id);
-        if (it != timestamps_.end()) {
-            return it->second;
+    void CBBAAgent::update_timestamp(AgentIndex agent, Timestamp ts) {
+        if (agent == NO_AGENT_INDEX) {
+            return;
+        }
+        timestamps_[agent] = ts;
+    }
+
+    void CBBAAgent::update_timestamp(const AgentID &agent_id, Timestamp ts) {
+        update_timestamp(agent_ids().find(agent_id), ts);
+    }
+
+    Timestamp CBBAAgent::get_timestamp(AgentIndex agent) const {
+        const Timestamp *ts = timestamps_.find(agent);
+        if (ts) {
+            return *ts;
         }
         return 0.0;
     }
 
-    void CBBAAgent::set_own_timestamp(Timestamp ts) { timestamps_[id_] = ts; }
+    Timestamp CBBAAgent::get_timestamp(const AgentID &agent_id) const {
+        return get_timestamp(agent_ids().find(agent_id));
+    }
+
+    void CBBAAgent::set_own_timestamp(Timestamp ts) { timestamps_[handle_.index()] = ts; }
 
     void CBBAAgent::check_convergence() {
         // Agent has converged if winners haven't changed
-        converged_ = (winners_ == previous_winners_);
+        converged_ = same_winners(winners_, previous_winners_);
     }
 
     void CBBAAgent::save_winners_for_convergence() { previous_winners_ = winners_; }
 
-    Bid CBBAAgent::get_winning_bid(const TaskID &task_id) const {
-        auto it = winning_bids_.find(task_id);
-        if (it != winning_bids_.end()) {
-            return it->second;
+    Bid CBBAAgent::get_winning_bid(TaskIndex task) const {
+        if (task < winners_.size()) {
+            return Bid(AgentHandle(winners_[task]), bid_scores_[task], bid_timestamps_[task]);
         }
         return Bid::invalid();
     }
 
-    AgentID CBBAAgent::get_winner(const TaskID &task_id) const {
-        auto it = winners_.find(task_id);
-        if (it != winners_.end()) {
-            return it->second;
+    Bid CBBAAgent::get_winning_bid(const TaskID &task_id) const { return get_winning_bid(task_ids().find(task_id)); }
+
+    AgentHandle CBBAAgent::get_winner(TaskIndex task) const {
+        if (task < winners_.size()) {
+            return AgentHandle(winners_[task]);
         }
-        return NO_AGENT;
+        return AgentHandle();
     }
 
+    AgentID CBBAAgent::get_winner(const TaskID &task_id) const { return get_winner(task_ids().find(task_id)).name(); }
+
 } // namespace consens::cbba
@@ -5,9 +5,18 @@ namespace consens::cbba {
     CBBAAlgorithm::CBBAAlgorithm(const AgentID &agent_id, const CBBAConfig &config, SendCallback send_callback,
                                  ReceiveCallback receive_callback)
         : agent_id_(agent_id), config_(config), send_callback_(send_callback), receive_callback_(receive_callback),
-          velocity_(0.0), cbba_agent_(agent_id, config.max_bundle_size), spatial_index_(),
-          bundle_builder_(&spatial_index_, config.metric, config.spatial_query_radius, config.bundle_mode),
-          consensus_resolver_(), iteration_count_(0), current_time_(0.0) {}
+          velocity_(0.0), task_store_(), cbba_agent_(agent_id, config.max_bundle_size),
+          spatial_index_(task_store_, config.spatial_index),
+          bundle_builder_(&spatial_index_, config.metric, config.spatial_query_radius, config.bundle_mode,
+                          config.bid_cache_pose_epsilon),
+          consensus_resolver_(config.consensus_mode), iteration_count_(0), current_time_(0.0) {
+        if (config.travel_cost_model) {
+            bundle_builder_.set_travel_cost_model(config.travel_cost_model, config.travel_cost_cache_capacity);
+        }
+        bundle_builder_.set_executor(config_.executor.get());
+        bundle_builder_.set_path_improvement_budget(config.path_improvement_budget);
+        bundle_builder_.set_build_budget(config.bundle_build_budget);
+    }
 
     void CBBAAlgorithm::update_pose(const Pose &pose) {
         pose_ = pose;
@@ -20,21 +29,68 @@ namespace consens::cbba {
     }
 
     void CBBAAlgorithm::add_task(const Task &task) {
-        tasks_[task.get_id()] = task;
-        update_spatial_index();
+        // Drop any stale index entry while the store still holds the old geometry
+        spatial_index_.remove(task_ids().find(task.get_id()));
+
+        TaskIndex index = task_store_.insert(task);
+        if (index == NO_TASK) {
+            return;
+        }
+        if (!task.is_completed()) {
+            spatial_index_.insert(index);
+            available_.insert(index);
+        } else {
+            available_.erase(index);
+        }
+    }
+
+    void CBBAAlgorithm::add_tasks(std::span<const Task> tasks) {
+        std::vector<TaskIndex> indexed;
+        indexed.reserve(tasks.size());
+
+        for (const Task &task : tasks) {
+            // Drop any stale index entry while the store still holds the old geometry
+            spatial_index_.remove(task_ids().find(task.get_id()));
+
+            TaskIndex index = task_store_.insert(task);
+            if (index == NO_TASK) {
+                continue;
+            }
+            if (!task.is_completed()) {
+                indexed.push_back(index);
+                available_.insert(index);
+            } else {
+                available_.erase(index);
+            }
+        }
+
+        // Build the index in one pass (bulk-loaded when the batch dominates the tree)
+        spatial_index_.insert(std::span<const TaskIndex>(indexed));
     }
 
     void CBBAAlgorithm::remove_task(const TaskID &id) {
-        tasks_.erase(id);
-        cbba_agent_.remove_from_bundle(id);
-        update_spatial_index();
+        TaskIndex task = task_ids().find(id);
+        if (!task_store_.contains(task)) {
+            return;
+        }
+
+        // Drop every piece of per-task state first: once the store lets go of the task,
+        // its handle may be recycled for a new one
+        spatial_index_.remove(task);
+        available_.erase(task);
+        cbba_agent_.reset_task(task);
+        consensus_resolver_.forget_task(task);
+        task_store_.remove(task);
     }
 
     void CBBAAlgorithm::mark_task_completed(const TaskID &id) {
-        auto it = tasks_.find(id);
-        if (it != tasks_.end()) {
-            it->second.set_completed(true);
-            cbba_agent_.remove_from_bundle(id);
+        TaskIndex task = task_ids().find(id);
+        Task *stored = task_store_.get(task);
+        if (stored) {
+            stored->set_completed(true);
+            spatial_index_.remove(task);
+            available_.erase(task);
+            cbba_agent_.remove_from_bundle(task);
         }
     }
 
@@ -59,11 +115,9 @@ namespace consens::cbba {
     }
 
     void CBBAAlgorithm::bundle_building_phase() {
-        // Get list of available tasks (not completed, not assigned to others with better bid)
-        std::vector<TaskID> available_tasks = get_available_tasks();
-
-        // Use bundle builder to select and add tasks
-        bundle_builder_.build_bundle(cbba_agent_, available_tasks);
+        // Use bundle builder to select and add tasks from the maintained availability set
+        // (tasks already in the bundle are skipped by the builder)
+        bundle_builder_.build_bundle(cbba_agent_, available_);
     }
 
     void CBBAAlgorithm::communication_phase() {
@@ -86,7 +140,7 @@ namespace consens::cbba {
             std::vector<CBBAMessage> messages;
             for (const auto &data : raw_messages) {
                 CBBAMessage msg;
-                if (msg.deserialize(data)) {
+                if (msg.deserialize(data, &task_store_)) {
                     messages.push_back(msg);
                 }
             }
@@ -96,57 +150,37 @@ namespace consens::cbba {
         }
     }
 
-    std::vector<TaskID> CBBAAlgorithm::get_available_tasks() const {
-        std::vector<TaskID> available;
-
-        for (const auto &[task_id, task] : tasks_) {
-            // Skip completed tasks
-            if (task.is_completed()) {
-                continue;
-            }
-
-            // Skip if already in our bundle
-            if (cbba_agent_.get_bundle().contains(task_id)) {
-                continue;
-            }
-
-            available.push_back(task_id);
-        }
-
-        return available;
-    }
-
     CBBAMessage CBBAAlgorithm::create_message() {
         CBBAMessage msg(agent_id_, current_time_);
 
         // Copy bundle and path from agent
-        const auto &bundle_tasks = cbba_agent_.get_bundle().get_tasks();
-        for (const auto &task_id : bundle_tasks) {
-            msg.bundle.add(task_id);
+        for (TaskIndex task : cbba_agent_.get_bundle().indices()) {
+            msg.bundle.add(task);
         }
 
-        const auto &path_tasks = cbba_agent_.get_path().get_tasks();
+        const auto &path_tasks = cbba_agent_.get_path().indices();
         for (size_t i = 0; i < path_tasks.size(); ++i) {
             msg.path.insert(path_tasks[i], i);
         }
 
         // Copy winning bids, winners, and timestamps
-        msg.winning_bids = cbba_agent_.get_winning_bids();
-        msg.winners = cbba_agent_.get_winners();
+        // Unassigned slots are skipped; receivers treat a missing entry as no winner
+        const auto &winners = cbba_agent_.get_winners();
+        std::vector<std::pair<uint32_t, Bid>> bids;
+        std::vector<std::pair<uint32_t, AgentHandle>> owners;
+        for (TaskIndex task = 0; task < winners.size(); ++task) {
+            if (winners[task] != NO_AGENT_INDEX) {
+                bids.emplace_back(task, cbba_agent_.get_winning_bid(task));
+                owners.emplace_back(task, AgentHandle(winners[task]));
+            }
+        }
+        msg.winning_bids.assign(std::move(bids));
+        msg.winners.assign(std::move(owners));
         msg.timestamps = cbba_agent_.get_timestamps();
 
         return msg;
     }
 
-    void CBBAAlgorithm::update_spatial_index() {
-        spatial_index_.clear();
-        for (const auto &[task_id, task] : tasks_) {
-            if (!task.is_completed()) {
-                spatial_index_.insert(task);
-            }
-        }
-    }
-
     std::vector<TaskID> CBBAAlgorithm::get_bundle() const { return cbba_agent_.get_bundle().get_tasks(); }
 
     std::vector<TaskID> CBBAAlgorithm::get_path() const { return cbba_agent_.get_path().get_tasks(); }
@@ -159,20 +193,36 @@ namespace consens::cbba {
         return path.front();
     }
 
+    std::vector<TaskStep> CBBAAlgorithm::get_path_steps() const {
+        const auto &path = cbba_agent_.get_path();
+        std::vector<TaskStep> steps;
+        steps.reserve(path.size());
+        for (size_t i = 0; i < path.size(); ++i) {
+            steps.push_back(TaskStep{path[i], path.direction_at(i)});
+        }
+        return steps;
+    }
+
+    std::optional<TaskStep> CBBAAlgorithm::get_next_step() const {
+        const auto &path = cbba_agent_.get_path();
+        if (path.empty()) {
+            return std::nullopt;
+        }
+        return TaskStep{path.front(), path.direction_at(0)};
+    }
+
     std::optional<Task> CBBAAlgorithm::get_task(const TaskID &id) const {
-        auto it = tasks_.find(id);
-        if (it != tasks_.end()) {
-            return it->second;
+        const Task *task = task_store_.get(task_ids().find(id));
+        if (task) {
+            return *task;
         }
         return std::nullopt;
     }
 
     std::vector<Task> CBBAAlgorithm::get_all_tasks() const {
         std::vector<Task> result;
-        result.reserve(tasks_.size());
-        for (const auto &[id, task] : tasks_) {
-            result.push_back(task);
-        }
+        result.reserve(task_store_.size());
+        task_store_.for_each([&](TaskIndex, const Task &task) { result.push_back(task); });
         return result;
     }
 
@@ -180,6 +230,12 @@ namespace consens::cbba {
 
     void CBBAAlgorithm::reset() {
         cbba_agent_ = CBBAAgent(agent_id_, config_.max_bundle_size);
+        cbba_agent_.update_pose(pose_);
+        cbba_agent_.update_velocity(velocity_);
+
+        // Neither a paused fill nor what neighbors sent before describes the new state
+        bundle_builder_.reset();
+        consensus_resolver_.forget_all();
         iteration_count_ = 0;
         current_time_ = 0.0;
     }
@@ -189,8 +245,8 @@ namespace consens::cbba {
         double total_score = 0.0;
         const auto &path = cbba_agent_.get_path();
 
-        for (const auto &task_id : path.get_tasks()) {
-            Score bid_score = cbba_agent_.get_local_bid(task_id);
+        for (TaskIndex task : path.indices()) {
+            Score bid_score = cbba_agent_.get_local_bid(task);
             if (bid_score > MIN_SCORE) {
                 total_score += bid_score;
             }
@@ -1,11 +1,42 @@
 #include "consens/cbba/consensus_resolver.hpp"
 
-#include <algorithm>
-#include <set>
-
 namespace consens::cbba {
 
+    namespace {
+
+        /**
+         * Merge-join a message's bids and winners, both sorted by task
+         * Calls visit(task, bid, winner) once per task with an entry in either; a missing side
+         * reads as an invalid bid or no winner
+         */
+        template <typename Visit> void for_each_entry(const CBBAMessage &msg, Visit &&visit) {
+            const Bid no_bid;
+            auto bid_it = msg.winning_bids.begin();
+            auto winner_it = msg.winners.begin();
+            while (bid_it != msg.winning_bids.end() || winner_it != msg.winners.end()) {
+                if (winner_it == msg.winners.end() ||
+                    (bid_it != msg.winning_bids.end() && bid_it->first < winner_it->first)) {
+                    visit(bid_it->first, bid_it->second, AgentHandle());
+                    ++bid_it;
+                } else if (bid_it == msg.winning_bids.end() || winner_it->first < bid_it->first) {
+                    visit(winner_it->first, no_bid, winner_it->second);
+                    ++winner_it;
+                } else {
+                    visit(bid_it->first, bid_it->second, winner_it->second);
+                    ++bid_it;
+                    ++winner_it;
+                }
+            }
+        }
+
+    } // namespace
+
     void ConsensusResolver::resolve_conflicts(CBBAAgent &agent, const std::vector<CBBAMessage> &neighbor_messages) {
+        if (mode_ == ConsensusMode::BATCHED) {
+            process_batch(agent, neighbor_messages);
+            return;
+        }
+
         // Process each neighbor's message
         for (const auto &msg : neighbor_messages) {
             process_message(agent, msg);
@@ -13,60 +44,143 @@ namespace consens::cbba {
     }
 
     void ConsensusResolver::process_message(CBBAAgent &agent, const CBBAMessage &msg) {
+        // A message without a sender (e.g. default-constructed) has no per-sender state to use
+        AgentIndex sender = agent_ids().intern(msg.sender_id);
+        if (sender == NO_AGENT_INDEX) {
+            return;
+        }
+
         // First, update timestamps for multi-hop information propagation
-        update_timestamps(agent, msg);
+        update_timestamps(agent, msg, sender);
 
-        // Get all tasks that either we or the neighbor know about
-        // Check conflicts for each task
-        std::set<TaskID> all_tasks;
+        // Only tasks the neighbor has an entry for can change anything: for any other task
+        // we either keep our winner or neither side has one (LEAVE)
+        for_each_entry(msg, [&](TaskIndex task, const Bid &bid, AgentHandle winner) {
+            // An empty task ID names no task
+            if (task == NO_TASK) {
+                return;
+            }
+            SeenTask &seen = seen_task(sender, task);
 
-        // Add tasks from our winning bids
-        for (const auto &[task_id, bid] : agent.get_winning_bids()) {
-            all_tasks.insert(task_id);
-        }
+            // An entry whose winner disagrees with its bid is always resolved in full
+            bool consistent = winner == bid.agent_id;
+            if (consistent && is_unchanged(seen, agent.get_winning_bid(task), bid)) {
+                return;
+            }
+
+            resolve_task_conflict(agent, task, bid, winner);
+            resolved_++;
 
-        // Add tasks from neighbor's winning bids
-        for (const auto &[task_id, bid] : msg.winning_bids) {
-            all_tasks.insert(task_id);
+            if (consistent) {
+                remember(seen, agent.get_winning_bid(task), bid);
+            } else {
+                seen = SeenTask();
+            }
+        });
+    }
+
+    void ConsensusResolver::process_batch(CBBAAgent &agent, const std::vector<CBBAMessage> &neighbor_messages) {
+        AgentHandle self = agent.get_handle();
+
+        // Reduce: fold every entry into the pending bid of its task, in message order, exactly as
+        // the agent's own bid would evolve if the messages were applied one after another
+        for (const auto &msg : neighbor_messages) {
+            // Same guards as process_message: no sender, no message; no task, no entry
+            AgentIndex sender = agent_ids().intern(msg.sender_id);
+            if (sender == NO_AGENT_INDEX) {
+                continue;
+            }
+            update_timestamps(agent, msg, sender);
+
+            for_each_entry(msg, [&](TaskIndex task, const Bid &bid, AgentHandle winner) {
+                if (task == NO_TASK) {
+                    return;
+                }
+                if (task >= pending_.size()) {
+                    pending_.resize(static_cast<size_t>(task) + 1);
+                }
+                PendingTask &pending = pending_[task];
+                if (!pending.touched) {
+                    pending.bid = agent.get_winning_bid(task);
+                    pending.touched = true;
+                    touched_.push_back(task);
+                }
+
+                SeenTask &seen = seen_task(sender, task);
+                bool consistent = winner == bid.agent_id;
+                if (consistent && is_unchanged(seen, pending.bid, bid)) {
+                    return;
+                }
+
+                Rule rule = select_rule(pending.bid, bid, winner, self);
+                resolved_++;
+                if (rule != Rule::LEAVE) {
+                    pending.bid = bid;
+                }
+                if (rule == Rule::RESET) {
+                    pending.lost = true;
+                }
+
+                if (consistent) {
+                    remember(seen, pending.bid, bid);
+                } else {
+                    seen = SeenTask();
+                }
+            });
         }
 
-        // Resolve conflict for each task
-        for (const TaskID &task_id : all_tasks) {
-            resolve_task_conflict(agent, msg, task_id);
+        // Apply: one write per changed task, and one reset per task lost along the way (the path is
+        // cut at the earliest lost task either way, so the order of resets does not matter)
+        for (TaskIndex task : touched_) {
+            PendingTask &pending = pending_[task];
+            if (pending.bid != agent.get_winning_bid(task)) {
+                apply_update_rule(agent, task, pending.bid);
+            }
+            if (pending.lost) {
+                apply_reset_rule(agent, task);
+            }
+            pending = PendingTask();
         }
+        touched_.clear();
     }
 
-    void ConsensusResolver::resolve_task_conflict(CBBAAgent &agent, const CBBAMessage &msg, const TaskID &task_id) {
-        // Get current information
-        Bid my_bid = agent.get_winning_bid(task_id);
-        AgentID my_winner = agent.get_winner(task_id);
+    void ConsensusResolver::resolve_task_conflict(CBBAAgent &agent, TaskIndex task, const Bid &neighbor_bid,
+                                                  AgentHandle neighbor_winner) {
+        // Get current information (an O(1) read of the agent's arrays)
+        Bid my_bid = agent.get_winning_bid(task);
+
+        switch (select_rule(my_bid, neighbor_bid, neighbor_winner, agent.get_handle())) {
+        case Rule::UPDATE:
+            apply_update_rule(agent, task, neighbor_bid);
+            break;
+        case Rule::RESET:
+            apply_update_rule(agent, task, neighbor_bid);
+            apply_reset_rule(agent, task);
+            break;
+        case Rule::LEAVE:
+            apply_leave_rule(agent);
+            break;
+        }
+    }
 
-        // Get neighbor's information
-        Bid neighbor_bid = msg.get_winning_bid(task_id);
-        AgentID neighbor_winner = msg.get_winner(task_id);
+    ConsensusResolver::Rule ConsensusResolver::select_rule(const Bid &my_bid, const Bid &neighbor_bid,
+                                                           AgentHandle neighbor_winner, AgentHandle self) {
+        AgentHandle my_winner = my_bid.agent_id;
 
         // CBBA Consensus Rules
         // The key decision: Should we update our information?
 
         // Case 1: Neighbor has info about a winner we don't know about
-        if (neighbor_winner != NO_AGENT && my_winner == NO_AGENT) {
+        if (neighbor_winner.is_valid() && !my_winner.is_valid()) {
             // UPDATE: Accept neighbor's assignment
-            apply_update_rule(agent, msg, task_id);
-            return;
+            return Rule::UPDATE;
         }
 
         // Case 2: We have info about a winner, neighbor doesn't
-        if (my_winner != NO_AGENT && neighbor_winner == NO_AGENT) {
-            // LEAVE: Keep our information
-            apply_leave_rule(agent);
-            return;
-        }
-
         // Case 3: Neither has a winner
-        if (my_winner == NO_AGENT && neighbor_winner == NO_AGENT) {
-            // LEAVE: Nothing to do
-            apply_leave_rule(agent);
-            return;
+        if (!neighbor_winner.is_valid()) {
+            // LEAVE: Keep our information (or nothing to do)
+            return Rule::LEAVE;
         }
 
         // Case 4: Both have winners - need to compare information freshness and quality
@@ -75,81 +189,48 @@ namespace consens::cbba {
         if (my_winner == neighbor_winner) {
             // Same winner - check if neighbor has newer/better info
             // Use bid timestamp to determine freshness
-            if (neighbor_bid.timestamp > my_bid.timestamp) {
-                // UPDATE: Neighbor has fresher information
-                apply_update_rule(agent, msg, task_id);
-                return;
-            } else {
-                // LEAVE: Our information is up to date
-                apply_leave_rule(agent);
-                return;
-            }
+            // UPDATE if neighbor has fresher information, LEAVE if ours is up to date
+            return neighbor_bid.timestamp > my_bid.timestamp ? Rule::UPDATE : Rule::LEAVE;
         }
 
         // Different winners - need to determine who should win
         // Compare based on bid timestamp and quality
-
-        // If one bid has newer timestamp, use that
-        if (neighbor_bid.timestamp > my_bid.timestamp) {
-            // Neighbor has newer info - UPDATE
-            apply_update_rule(agent, msg, task_id);
-
-            // RESET: If we lost this task, remove it from our bundle
-            if (my_winner == agent.get_id() && neighbor_winner != agent.get_id()) {
-                apply_reset_rule(agent, task_id);
-            }
-            return;
-        } else if (my_bid.timestamp > neighbor_bid.timestamp) {
-            // Our info is newer - LEAVE
-            apply_leave_rule(agent);
-            return;
+        // If one bid has newer timestamp, use that; on the same timestamp compare bids by score
+        // (and tie-break by agent ID)
+        bool neighbor_wins = neighbor_bid.timestamp > my_bid.timestamp ||
+                             (neighbor_bid.timestamp == my_bid.timestamp && neighbor_bid > my_bid);
+        if (!neighbor_wins) {
+            // Our info is newer, or our bid is better or equal - LEAVE
+            return Rule::LEAVE;
         }
 
-        // Same timestamp - compare bids by score (and tie-break by agent ID)
-        if (neighbor_bid > my_bid) {
-            // Neighbor has better bid - UPDATE
-            apply_update_rule(agent, msg, task_id);
-
-            // RESET: If we lost this task, remove it from our bundle
-            if (my_winner == agent.get_id() && neighbor_winner != agent.get_id()) {
-                apply_reset_rule(agent, task_id);
-            }
-            return;
-        } else {
-            // Our bid is better or equal - LEAVE
-            apply_leave_rule(agent);
-            return;
-        }
+        // Neighbor has newer info or a better bid - UPDATE
+        // RESET: If we lost this task, remove it from our bundle
+        return my_winner == self ? Rule::RESET : Rule::UPDATE;
     }
 
-    void ConsensusResolver::apply_update_rule(CBBAAgent &agent, const CBBAMessage &msg, const TaskID &task_id) {
+    void ConsensusResolver::apply_update_rule(CBBAAgent &agent, TaskIndex task, const Bid &neighbor_bid) {
         // Update our winning bid and winner with neighbor's information
-        Bid neighbor_bid = msg.get_winning_bid(task_id);
-        agent.update_winning_bid(task_id, neighbor_bid);
+        agent.update_winning_bid(task, neighbor_bid);
+        updates_++;
     }
 
-    void ConsensusResolver::apply_reset_rule(CBBAAgent &agent, const TaskID &task_id) {
+    void ConsensusResolver::apply_reset_rule(CBBAAgent &agent, TaskIndex task) {
         // Lost this task - remove from bundle and path
 
         // Find position in path
         const Path &path = agent.get_path();
-        size_t position = path.find_position(task_id);
+        size_t position = path.find_position(task);
 
         if (position < path.size()) {
             // Remove this task and all subsequent tasks from bundle and path
             // This is because subsequent tasks depend on completing this one first
 
-            // Get all tasks from this position onwards
-            std::vector<TaskID> tasks_to_remove;
-            for (size_t i = position; i < path.size(); ++i) {
-                tasks_to_remove.push_back(path[i]);
-            }
-
-            // Remove each task from bundle/path
+            // Remove each task from bundle/path, back to front so nothing is copied or shifted
             // NOTE: We DON'T call reset_task because we want to keep the winning bid information
             // that was set by apply_update_rule (the neighbor's better bid)
-            for (const TaskID &tid : tasks_to_remove) {
-                agent.remove_from_bundle(tid);
+            while (path.size() > position) {
+                agent.remove_from_bundle(path.index_at(path.size() - 1));
             }
         }
     }
@@ -160,26 +241,38 @@ namespace consens::cbba {
         (void)agent; // Suppress unused parameter warning
     }
 
-    void ConsensusResolver::update_timestamps(CBBAAgent &agent, const CBBAMessage &msg) {
+    void ConsensusResolver::update_timestamps(CBBAAgent &agent, const CBBAMessage &msg, AgentIndex sender) {
         // Update timestamp for the sender
-        agent.update_timestamp(msg.sender_id, msg.timestamp);
+        agent.update_timestamp(sender, msg.timestamp);
 
         // Multi-hop: propagate timestamps from neighbor's knowledge
         // This allows information to spread beyond direct neighbors
-        for (const auto &[other_agent_id, neighbor_ts] : msg.timestamps) {
-            // Check if neighbor has newer information about other_agent_id
-            if (has_newer_info(agent, msg.sender_id, other_agent_id, neighbor_ts)) {
-                // Update our timestamp for other_agent_id
-                agent.update_timestamp(other_agent_id, neighbor_ts);
+        // Both maps are sorted by agent, so this is a merge-join with no lookups
+        AgentTimestamps &timestamps = agent.get_timestamps();
+        auto mine = timestamps.begin();
+        for (const auto &[other_agent, neighbor_ts] : msg.timestamps) {
+            while (mine != timestamps.end() && mine->first < other_agent) {
+                ++mine;
+            }
+
+            bool known = mine != timestamps.end() && mine->first == other_agent;
+            Timestamp my_ts = known ? mine->second : 0.0;
+
+            // Check if neighbor has newer information about other_agent
+            if (!has_newer_info(my_ts, neighbor_ts)) {
+                continue;
+            }
+
+            // Update our timestamp for other_agent
+            if (known) {
+                mine->second = neighbor_ts;
+            } else {
+                mine = timestamps.insert(mine, other_agent, neighbor_ts);
             }
         }
     }
 
-    bool ConsensusResolver::has_newer_info(const CBBAAgent &agent, const AgentID &neighbor_id,
-                                           const AgentID &other_agent_id, Timestamp neighbor_ts) const {
-        // Get our current timestamp for other_agent_id
-        Timestamp my_ts = agent.get_timestamp(other_agent_id);
-
+    bool ConsensusResolver::has_newer_info(Timestamp my_ts, Timestamp neighbor_ts) const {
         // Neighbor has newer info if:
         // 1. Their timestamp for other_agent is newer than ours, OR
         // 2. We have no information (timestamp = 0) and they do
@@ -187,4 +280,38 @@ namespace consens::cbba {
         return neighbor_ts > my_ts;
     }
 
+    void ConsensusResolver::forget_task(TaskIndex task) {
+        for (std::vector<SeenTask> &seen : seen_) {
+            if (task < seen.size()) {
+                seen[task] = SeenTask();
+            }
+        }
+    }
+
+    ConsensusResolver::SeenTask &ConsensusResolver::seen_task(AgentIndex sender, TaskIndex task) {
+        if (sender >= seen_.size()) {
+            seen_.resize(static_cast<size_t>(sender) + 1);
+        }
+        std::vector<SeenTask> &seen = seen_[sender];
+        if (task >= seen.size()) {
+            seen.resize(static_cast<size_t>(task) + 1);
+        }
+        return seen[task];
+    }
+
+    bool ConsensusResolver::is_unchanged(const SeenTask &seen, const Bid &my_bid, const Bid &bid) {
+        return bid.agent_id.index() == seen.neighbor_winner && bid.score == seen.neighbor_score &&
+               bid.timestamp == seen.neighbor_timestamp && my_bid.agent_id.index() == seen.winner &&
+               my_bid.score == seen.score && my_bid.timestamp == seen.timestamp;
+    }
+
+    void ConsensusResolver::remember(SeenTask &seen, const Bid &my_bid, const Bid &bid) {
+        seen.neighbor_winner = bid.agent_id.index();
+        seen.neighbor_score = bid.score;
+        seen.neighbor_timestamp = bid.timestamp;
+        seen.winner = my_bid.agent_id.index();
+        seen.score = my_bid.score;
+        seen.timestamp = my_bid.timestamp;
+    }
+
 } // namespace consens::cbba
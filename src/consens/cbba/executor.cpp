@@ -0,0 +1,91 @@
+#include "consens/cbba/executor.hpp"
+
+#include <algorithm>
+
+namespace consens::cbba {
+
+    ThreadPool::ThreadPool(size_t concurrency)
+        : job_(nullptr), count_(0), next_(0), busy_(0), generation_(0), stopping_(false) {
+        if (concurrency == 0) {
+            concurrency = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        workers_.reserve(concurrency - 1);
+        for (size_t i = 1; i < concurrency; i++) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)> &job) {
+        if (count == 0) {
+            return;
+        }
+        if (workers_.empty() || count == 1) {
+            for (size_t i = 0; i < count; i++) {
+                job(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> submit(submit_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            busy_ = workers_.size();
+            generation_++;
+        }
+        wake_.notify_all();
+
+        drain(job, count);
+
+        // Every worker checks in, so none still holds `job` after we return
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+
+    void ThreadPool::worker_loop() {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)> *job;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) {
+                    return;
+                }
+                seen = generation_;
+                job = job_;
+                count = count_;
+            }
+
+            drain(*job, count);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::drain(const std::function<void(size_t)> &job, size_t count) {
+        for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next_.fetch_add(1, std::memory_order_relaxed)) {
+            job(i);
+        }
+    }
+
+} // namespace consens::cbba
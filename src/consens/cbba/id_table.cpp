@@ -0,0 +1,160 @@
+#include "consens/cbba/id_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+namespace consens::cbba {
+
+    namespace {
+
+        /**
+         * Order-preserving integer for the first 8 bytes of a string
+         * Bytes compare as unsigned, like std::string; shorter strings are zero-padded.
+         */
+        uint64_t prefix_key(const std::string &id) {
+            uint64_t key = 0;
+            size_t length = std::min<size_t>(id.size(), sizeof(key));
+            for (size_t i = 0; i < sizeof(key); ++i) {
+                uint8_t byte = i < length ? static_cast<uint8_t>(id[i]) : 0;
+                key = (key << 8) | byte;
+            }
+            return key;
+        }
+
+    } // namespace
+
+    IdTable::~IdTable() {
+        for (std::atomic<Entry *> &chunk : chunks_) {
+            delete[] chunk.load();
+        }
+    }
+
+    uint32_t IdTable::intern(const std::string &id) {
+        if (id.empty()) {
+            return INVALID_INDEX;
+        }
+
+        // Fast path: already interned
+        {
+            std::shared_lock lock(mutex_);
+            auto it = indices_.find(id);
+            if (it != indices_.end() && entry(it->second).pinned) {
+                return it->second;
+            }
+        }
+
+        std::unique_lock lock(mutex_);
+        uint32_t index = assign(id);
+        entry(index).pinned = true;
+        return index;
+    }
+
+    uint32_t IdTable::acquire(const std::string &id) {
+        if (id.empty()) {
+            return INVALID_INDEX;
+        }
+
+        std::unique_lock lock(mutex_);
+        uint32_t index = assign(id);
+        entry(index).refs++;
+        return index;
+    }
+
+    void IdTable::release(uint32_t index) {
+        if (index == INVALID_INDEX) {
+            return;
+        }
+
+        std::unique_lock lock(mutex_);
+        if (index >= size_.load(std::memory_order_relaxed) || entry(index).refs == 0) {
+            return;
+        }
+
+        Entry &released = entry(index);
+        if (--released.refs == 0 && !released.pinned) {
+            indices_.erase(released.name);
+            released.name.clear();
+            released.prefix = 0;
+            free_.push_back(index);
+        }
+    }
+
+    uint32_t IdTable::find(const std::string &id) const {
+        std::shared_lock lock(mutex_);
+        auto it = indices_.find(id);
+        if (it != indices_.end()) {
+            return it->second;
+        }
+        return INVALID_INDEX;
+    }
+
+    const std::string &IdTable::name(uint32_t index) const {
+        static const std::string empty;
+        if (index == INVALID_INDEX || index >= size_.load(std::memory_order_acquire)) {
+            return empty;
+        }
+        return entry(index).name;
+    }
+
+    bool IdTable::less(uint32_t a, uint32_t b) const {
+        uint32_t size = size_.load(std::memory_order_acquire);
+        const Entry *entry_a = a < size ? &entry(a) : nullptr;
+        const Entry *entry_b = b < size ? &entry(b) : nullptr;
+        uint64_t prefix_a = entry_a ? entry_a->prefix : 0;
+        uint64_t prefix_b = entry_b ? entry_b->prefix : 0;
+        if (prefix_a != prefix_b) {
+            return prefix_a < prefix_b;
+        }
+        return name(a) < name(b);
+    }
+
+    size_t IdTable::size() const { return size_.load(std::memory_order_acquire); }
+
+    uint32_t IdTable::assign(const std::string &id) {
+        auto it = indices_.find(id);
+        if (it != indices_.end()) {
+            return it->second;
+        }
+
+        uint32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            index = size_.load(std::memory_order_relaxed);
+            unsigned chunk = std::bit_width(index / FIRST_CHUNK + 1) - 1;
+            if (!chunks_[chunk].load(std::memory_order_relaxed)) {
+                chunks_[chunk].store(new Entry[static_cast<size_t>(FIRST_CHUNK) << chunk], std::memory_order_release);
+            }
+        }
+
+        Entry &assigned = entry(index);
+        assigned.name = id;
+        assigned.prefix = prefix_key(id);
+        indices_.emplace(id, index);
+
+        // Publish new handles only once their entry is written
+        if (index == size_.load(std::memory_order_relaxed)) {
+            size_.store(index + 1, std::memory_order_release);
+        }
+        return index;
+    }
+
+    IdTable::Entry &IdTable::entry(uint32_t index) const {
+        unsigned chunk = std::bit_width(index / FIRST_CHUNK + 1) - 1;
+        uint32_t first = FIRST_CHUNK * ((1u << chunk) - 1);
+        return chunks_[chunk].load(std::memory_order_acquire)[index - first];
+    }
+
+    IdTable &task_ids() {
+        static IdTable table;
+        return table;
+    }
+
+    IdTable &agent_ids() {
+        static IdTable table;
+        return table;
+    }
+
+} // namespace consens::cbba
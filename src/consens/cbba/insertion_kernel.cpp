@@ -0,0 +1,175 @@
+#include "consens/cbba/insertion_kernel.hpp"
+
+#include <cmath>
+
+// Keep every a * b + c as two roundings (no FMA contraction), so all instruction sets
+// produce the same costs and bids do not depend on which CPU computed them. CMake passes
+// -ffp-contract=off to every target so the scalar paths in the headers match; this keeps the
+// kernel itself safe when built some other way
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CONSENS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace consens::cbba {
+
+    namespace {
+
+        /**
+         * Arrays shared by all kernels for one slot
+         */
+        struct SlotView {
+            const InsertionBatch &batch;
+            const InsertionEdge &edge;
+            double velocity;
+            double *reach;
+            double *delay;
+        };
+
+        /**
+         * Scalar cost of one candidate; same operation order as BasicTaskScorer<Policy>::compute_insertion_cost
+         */
+        inline void cost_cell(const SlotView &slot, size_t c) {
+            const InsertionBatch &b = slot.batch;
+            const InsertionEdge &e = slot.edge;
+
+            double dx = e.prev.x - b.entry_x[c];
+            double dy = e.prev.y - b.entry_y[c];
+            double reach = std::sqrt(dx * dx + dy * dy) / slot.velocity + b.duration[c];
+
+            double nx = b.exit_x[c] - e.next.x;
+            double ny = b.exit_y[c] - e.next.y;
+            double onward = std::sqrt(nx * nx + ny * ny) / slot.velocity;
+
+            slot.reach[c] = reach;
+            slot.delay[c] = (reach + e.weight * onward) - e.bypass_time;
+        }
+
+        void costs_scalar(const SlotView &slot, size_t begin) {
+            for (size_t c = begin; c < slot.batch.size(); ++c) {
+                cost_cell(slot, c);
+            }
+        }
+
+#ifdef CONSENS_X86_SIMD
+        __attribute__((target("avx2"))) void costs_avx2(const SlotView &slot) {
+            const InsertionBatch &b = slot.batch;
+            const InsertionEdge &e = slot.edge;
+            size_t n = b.size();
+
+            __m256d velocity = _mm256_set1_pd(slot.velocity);
+            __m256d px = _mm256_set1_pd(e.prev.x);
+            __m256d py = _mm256_set1_pd(e.prev.y);
+            __m256d qx = _mm256_set1_pd(e.next.x);
+            __m256d qy = _mm256_set1_pd(e.next.y);
+            __m256d weight = _mm256_set1_pd(e.weight);
+            __m256d bypass = _mm256_set1_pd(e.bypass_time);
+
+            size_t c = 0;
+            for (; c + 4 <= n; c += 4) {
+                __m256d dx = _mm256_sub_pd(px, _mm256_loadu_pd(&b.entry_x[c]));
+                __m256d dy = _mm256_sub_pd(py, _mm256_loadu_pd(&b.entry_y[c]));
+                __m256d dist = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+                __m256d reach = _mm256_add_pd(_mm256_div_pd(dist, velocity), _mm256_loadu_pd(&b.duration[c]));
+
+                __m256d nx = _mm256_sub_pd(_mm256_loadu_pd(&b.exit_x[c]), qx);
+                __m256d ny = _mm256_sub_pd(_mm256_loadu_pd(&b.exit_y[c]), qy);
+                __m256d onward = _mm256_div_pd(
+                    _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(nx, nx), _mm256_mul_pd(ny, ny))), velocity);
+
+                _mm256_storeu_pd(&slot.reach[c], reach);
+                _mm256_storeu_pd(&slot.delay[c],
+                                 _mm256_sub_pd(_mm256_add_pd(reach, _mm256_mul_pd(weight, onward)), bypass));
+            }
+            costs_scalar(slot, c);
+        }
+
+        __attribute__((target("avx512f"))) void costs_avx512(const SlotView &slot) {
+            const InsertionBatch &b = slot.batch;
+            const InsertionEdge &e = slot.edge;
+            size_t n = b.size();
+
+            __m512d velocity = _mm512_set1_pd(slot.velocity);
+            __m512d px = _mm512_set1_pd(e.prev.x);
+            __m512d py = _mm512_set1_pd(e.prev.y);
+            __m512d qx = _mm512_set1_pd(e.next.x);
+            __m512d qy = _mm512_set1_pd(e.next.y);
+            __m512d weight = _mm512_set1_pd(e.weight);
+            __m512d bypass = _mm512_set1_pd(e.bypass_time);
+
+            // Masked loads/stores handle the tail without a scalar loop
+            for (size_t c = 0; c < n; c += 8) {
+                __mmask8 mask = n - c >= 8 ? __mmask8(0xFF) : __mmask8((1u << (n - c)) - 1);
+
+                __m512d dx = _mm512_sub_pd(px, _mm512_maskz_loadu_pd(mask, &b.entry_x[c]));
+                __m512d dy = _mm512_sub_pd(py, _mm512_maskz_loadu_pd(mask, &b.entry_y[c]));
+                __m512d dist = _mm512_maskz_sqrt_pd(mask, _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)));
+                __m512d reach =
+                    _mm512_add_pd(_mm512_div_pd(dist, velocity), _mm512_maskz_loadu_pd(mask, &b.duration[c]));
+
+                __m512d nx = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, &b.exit_x[c]), qx);
+                __m512d ny = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, &b.exit_y[c]), qy);
+                __m512d onward = _mm512_div_pd(
+                    _mm512_maskz_sqrt_pd(mask, _mm512_add_pd(_mm512_mul_pd(nx, nx), _mm512_mul_pd(ny, ny))), velocity);
+
+                _mm512_mask_storeu_pd(&slot.reach[c], mask, reach);
+                _mm512_mask_storeu_pd(&slot.delay[c], mask,
+                                      _mm512_sub_pd(_mm512_add_pd(reach, _mm512_mul_pd(weight, onward)), bypass));
+            }
+        }
+#endif
+
+    } // namespace
+
+    SimdLevel detect_simd_level() {
+        static const SimdLevel level = [] {
+#ifdef CONSENS_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return SimdLevel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return SimdLevel::AVX2;
+            }
+#endif
+            return SimdLevel::SCALAR;
+        }();
+        return level;
+    }
+
+    bool simd_supported(SimdLevel level) { return static_cast<int>(level) <= static_cast<int>(detect_simd_level()); }
+
+    void compute_insertion_costs(std::span<const InsertionEdge> edges, double velocity, InsertionBatch &batch,
+                                 SimdLevel level) {
+        size_t n = batch.size();
+        batch.reach.resize(edges.size() * n);
+        batch.delay.resize(edges.size() * n);
+        if (!simd_supported(level)) {
+            level = SimdLevel::SCALAR;
+        }
+
+        for (size_t j = 0; j < edges.size(); ++j) {
+            SlotView slot{batch, edges[j], velocity, batch.reach.data() + j * n, batch.delay.data() + j * n};
+            switch (level) {
+#ifdef CONSENS_X86_SIMD
+            case SimdLevel::AVX512:
+                costs_avx512(slot);
+                break;
+            case SimdLevel::AVX2:
+                costs_avx2(slot);
+                break;
+#endif
+            default:
+                costs_scalar(slot, 0);
+                break;
+            }
+        }
+    }
+
+} // namespace consens::cbba
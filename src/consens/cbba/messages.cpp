@@ -1,4 +1,5 @@
 #include "consens/cbba/messages.hpp"
+#include "consens/cbba/task_store.hpp"
 
 #include <cstring>
 
@@ -28,39 +29,39 @@ namespace consens::cbba {
             buffer_.insert(buffer_.end(), str.begin(), str.end());
         }
 
-        void write_task_ids(const std::vector<TaskID> &tasks) {
+        void write_task_ids(const std::vector<TaskIndex> &tasks) {
             write_uint32(static_cast<uint32_t>(tasks.size()));
-            for (const auto &task_id : tasks) {
-                write_string(task_id);
+            for (TaskIndex task : tasks) {
+                write_string(task_ids().name(task));
             }
         }
 
         void write_bid(const Bid &bid) {
-            write_string(bid.agent_id);
+            write_string(bid.agent_id.name());
             write_double(bid.score);
             write_double(bid.timestamp);
         }
 
         void write_task_bids(const TaskBids &bids) {
             write_uint32(static_cast<uint32_t>(bids.size()));
-            for (const auto &[task_id, bid] : bids) {
-                write_string(task_id);
+            for (const auto &[task, bid] : bids) {
+                write_string(task_ids().name(task));
                 write_bid(bid);
             }
         }
 
         void write_task_winners(const TaskWinners &winners) {
             write_uint32(static_cast<uint32_t>(winners.size()));
-            for (const auto &[task_id, agent_id] : winners) {
-                write_string(task_id);
-                write_string(agent_id);
+            for (const auto &[task, agent] : winners) {
+                write_string(task_ids().name(task));
+                write_string(agent.name());
             }
         }
 
         void write_agent_timestamps(const AgentTimestamps &timestamps) {
             write_uint32(static_cast<uint32_t>(timestamps.size()));
-            for (const auto &[agent_id, ts] : timestamps) {
-                write_string(agent_id);
+            for (const auto &[agent, ts] : timestamps) {
+                write_string(agent_ids().name(agent));
                 write_double(ts);
             }
         }
@@ -69,17 +70,37 @@ namespace consens::cbba {
     };
 
     // Helper class for binary deserialization
+    // Task IDs are looked up, never interned: entries naming a task this process does not know
+    // (or, with a store, a task the receiver does not hold) are dropped, since there is nothing
+    // to bid on. Agent IDs are interned, so senders, winners and timestamps of agents this
+    // process never met (e.g. multi-hop winners) are kept.
     class BinaryReader {
       private:
         const uint8_t *data_;
         size_t size_;
         size_t pos_;
+        const TaskStore *tasks_;
 
       public:
-        BinaryReader(const std::vector<uint8_t> &data) : data_(data.data()), size_(data.size()), pos_(0) {}
+        BinaryReader(const std::vector<uint8_t> &data, const TaskStore *tasks)
+            : data_(data.data()), size_(data.size()), pos_(0), tasks_(tasks) {}
+
+        TaskIndex find_task(const std::string &task_id) const {
+            TaskIndex task = task_ids().find(task_id);
+            if (tasks_ && !tasks_->contains(task)) {
+                return NO_TASK;
+            }
+            return task;
+        }
 
         bool has_data(size_t bytes) const { return pos_ + bytes <= size_; }
 
+        // A count read from the wire is only trusted once the remaining bytes could hold that
+        // many entries of at least `entry_bytes` each; this keeps reserve() bounded by the input.
+        bool can_hold(uint32_t count, size_t entry_bytes) const {
+            return static_cast<uint64_t>(count) * entry_bytes <= size_ - pos_;
+        }
+
         bool read_double(double &value) {
             if (!has_data(sizeof(double))) return false;
             std::memcpy(&value, data_ + pos_, sizeof(double));
@@ -103,21 +124,27 @@ namespace consens::cbba {
             return true;
         }
 
-        bool read_task_ids(std::vector<TaskID> &tasks) {
+        bool read_task_ids(std::vector<TaskIndex> &tasks) {
             uint32_t count;
             if (!read_uint32(count)) return false;
+            if (!can_hold(count, sizeof(uint32_t))) return false;
             tasks.clear();
             tasks.reserve(count);
             for (uint32_t i = 0; i < count; ++i) {
                 std::string task_id;
                 if (!read_string(task_id)) return false;
-                tasks.push_back(task_id);
+                TaskIndex task = find_task(task_id);
+                if (task != NO_TASK) {
+                    tasks.push_back(task);
+                }
             }
             return true;
         }
 
         bool read_bid(Bid &bid) {
-            if (!read_string(bid.agent_id)) return false;
+            std::string agent_id;
+            if (!read_string(agent_id)) return false;
+            bid.agent_id = AgentHandle(agent_id);
             if (!read_double(bid.score)) return false;
             if (!read_double(bid.timestamp)) return false;
             return true;
@@ -126,42 +153,60 @@ namespace consens::cbba {
         bool read_task_bids(TaskBids &bids) {
             uint32_t count;
             if (!read_uint32(count)) return false;
-            bids.clear();
+            if (!can_hold(count, 2 * sizeof(uint32_t) + 2 * sizeof(double))) return false;
+            std::vector<TaskBids::value_type> entries;
+            entries.reserve(count);
             for (uint32_t i = 0; i < count; ++i) {
                 std::string task_id;
                 Bid bid;
                 if (!read_string(task_id)) return false;
                 if (!read_bid(bid)) return false;
-                bids[task_id] = bid;
+                TaskIndex task = find_task(task_id);
+                if (task != NO_TASK) {
+                    entries.emplace_back(task, bid);
+                }
             }
+            bids.assign(std::move(entries));
             return true;
         }
 
         bool read_task_winners(TaskWinners &winners) {
             uint32_t count;
             if (!read_uint32(count)) return false;
-            winners.clear();
+            if (!can_hold(count, 2 * sizeof(uint32_t))) return false;
+            std::vector<TaskWinners::value_type> entries;
+            entries.reserve(count);
             for (uint32_t i = 0; i < count; ++i) {
                 std::string task_id;
                 std::string agent_id;
                 if (!read_string(task_id)) return false;
                 if (!read_string(agent_id)) return false;
-                winners[task_id] = agent_id;
+                TaskIndex task = find_task(task_id);
+                if (task != NO_TASK) {
+                    entries.emplace_back(task, AgentHandle(agent_id));
+                }
             }
+            winners.assign(std::move(entries));
             return true;
         }
 
         bool read_agent_timestamps(AgentTimestamps &timestamps) {
             uint32_t count;
             if (!read_uint32(count)) return false;
-            timestamps.clear();
+            if (!can_hold(count, sizeof(uint32_t) + sizeof(double))) return false;
+            std::vector<AgentTimestamps::value_type> entries;
+            entries.reserve(count);
             for (uint32_t i = 0; i < count; ++i) {
                 std::string agent_id;
                 double ts;
                 if (!read_string(agent_id)) return false;
                 if (!read_double(ts)) return false;
-                timestamps[agent_id] = ts;
+                AgentIndex agent = agent_ids().intern(agent_id);
+                if (agent != NO_AGENT_INDEX) {
+                    entries.emplace_back(agent, ts);
+                }
             }
+            timestamps.assign(std::move(entries));
             return true;
         }
     };
@@ -174,10 +219,10 @@ namespace consens::cbba {
         writer.write_double(timestamp);
 
         // Bundle (just task IDs)
-        writer.write_task_ids(bundle.get_tasks());
+        writer.write_task_ids(bundle.indices());
 
         // Path (just task IDs in order)
-        writer.write_task_ids(path.get_tasks());
+        writer.write_task_ids(path.indices());
 
         // Winning bids
         writer.write_task_bids(winning_bids);
@@ -191,26 +236,26 @@ namespace consens::cbba {
         return writer.get_buffer();
     }
 
-    bool CBBAMessage::deserialize(const std::vector<uint8_t> &data) {
-        BinaryReader reader(data);
+    bool CBBAMessage::deserialize(const std::vector<uint8_t> &data, const TaskStore *tasks) {
+        BinaryReader reader(data, tasks);
 
         // Message metadata
         if (!reader.read_string(sender_id)) return false;
         if (!reader.read_double(timestamp)) return false;
 
         // Bundle
-        std::vector<TaskID> bundle_tasks;
+        std::vector<TaskIndex> bundle_tasks;
         if (!reader.read_task_ids(bundle_tasks)) return false;
 
         // Clear existing bundle and add tasks
         // Bundle now has unlimited capacity by default
         bundle.clear();
-        for (const auto &task_id : bundle_tasks) {
-            bundle.add(task_id);
+        for (TaskIndex task : bundle_tasks) {
+            bundle.add(task);
         }
 
         // Path
-        std::vector<TaskID> path_tasks;
+        std::vector<TaskIndex> path_tasks;
         if (!reader.read_task_ids(path_tasks)) return false;
         path.clear();
         for (size_t i = 0; i < path_tasks.size(); ++i) {
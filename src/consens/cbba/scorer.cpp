@@ -1,169 +1,100 @@
 #include "consens/cbba/scorer.hpp"
 
-#include <cmath>
-#include <limits>
-
 namespace consens::cbba {
 
-    TaskScorer::TaskScorer(Metric metric, double lambda) : metric_(metric), lambda_(lambda) {}
-
-    Score TaskScorer::compute_marginal_gain(const CBBAAgent &agent, const Task &task, const Path &current_path,
-                                            size_t insertion_pos, const SpatialIndex &spatial_index) const {
-        // Create a temporary path with the task inserted
-        Path temp_path = current_path;
-        temp_path.insert(task.get_id(), insertion_pos);
+    template class BasicTaskScorer<RptPolicy>;
+    template class BasicTaskScorer<TdrPolicy>;
 
-        // Compute score of new path
-        Score new_score = evaluate_path(agent, temp_path, spatial_index);
+    TaskScorer::TaskScorer(Metric metric, double lambda) : lambda_(lambda) { set_metric(metric); }
 
-        // Compute score of current path
-        Score current_score = evaluate_path(agent, current_path, spatial_index);
+    Score TaskScorer::compute_marginal_gain(const CBBAAgent &agent, const Task &task, const Path &current_path,
+                                            size_t insertion_pos, const SpatialIndex &spatial_index,
+                                            Direction direction) const {
+        return std::visit(
+            [&](const auto &scorer) {
+                return scorer.compute_marginal_gain(agent, task, current_path, insertion_pos, spatial_index,
+                                                    direction);
+            },
+            scorer_);
+    }
 
-        // Marginal gain is the difference
-        return new_score - current_score;
+    Score TaskScorer::compute_marginal_gain(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                            size_t insertion_pos, const SpatialIndex &spatial_index,
+                                            Direction direction) const {
+        return std::visit(
+            [&](const auto &scorer) {
+                return scorer.compute_marginal_gain(agent, task, current_path, insertion_pos, spatial_index,
+                                                    direction);
+            },
+            scorer_);
     }
 
     Score TaskScorer::evaluate_path(const CBBAAgent &agent, const Path &path, const SpatialIndex &spatial_index) const {
-        if (metric_ == Metric::RPT) {
-            return compute_rpt_score(agent, path, spatial_index);
-        } else {
-            return compute_tdr_score(agent, path, spatial_index);
-        }
+        return std::visit([&](const auto &scorer) { return scorer.evaluate_path(agent, path, spatial_index); },
+                          scorer_);
     }
 
-    std::pair<Score, size_t> TaskScorer::find_optimal_insertion(const CBBAAgent &agent, const Task &task,
-                                                                const Path &current_path,
-                                                                const SpatialIndex &spatial_index) const {
-        Score best_score = MIN_SCORE;
-        size_t best_position = 0;
-
-        // Try inserting at each position
-        for (size_t pos = 0; pos <= current_path.size(); pos++) {
-            Score marginal_gain = compute_marginal_gain(agent, task, current_path, pos, spatial_index);
-
-            if (marginal_gain > best_score) {
-                best_score = marginal_gain;
-                best_position = pos;
-            }
-        }
-
-        return {best_score, best_position};
+    Insertion TaskScorer::find_optimal_insertion(const CBBAAgent &agent, const Task &task, const Path &current_path,
+                                                 const SpatialIndex &spatial_index) const {
+        return std::visit(
+            [&](const auto &scorer) { return scorer.find_optimal_insertion(agent, task, current_path, spatial_index); },
+            scorer_);
     }
 
-    double TaskScorer::compute_travel_time(const Point &from, const Point &to, double velocity) const {
-        if (velocity <= 0.0) {
-            return std::numeric_limits<double>::infinity();
-        }
-
-        double distance = from.distance_to(to);
-        return distance / velocity;
+    Insertion TaskScorer::find_optimal_insertion(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                                 const SpatialIndex &spatial_index) const {
+        return std::visit(
+            [&](const auto &scorer) { return scorer.find_optimal_insertion(agent, task, current_path, spatial_index); },
+            scorer_);
     }
 
-    double TaskScorer::compute_task_time(const Task &task) const {
-        // For now, just use the task's duration
-        // In the future, this could be more sophisticated
-        return task.get_duration();
+    Insertion TaskScorer::find_optimal_insertion(const CBBAAgent &agent, TaskIndex task, const Path &current_path,
+                                                 const PathProfile &profile,
+                                                 const SpatialIndex &spatial_index) const {
+        return std::visit(
+            [&](const auto &scorer) {
+                return scorer.find_optimal_insertion(agent, task, current_path, profile, spatial_index);
+            },
+            scorer_);
     }
 
-    Score TaskScorer::compute_rpt_score(const CBBAAgent &agent, const Path &path,
-                                        const SpatialIndex &spatial_index) const {
-        if (path.empty()) {
-            return 0.0;
-        }
-
-        double total_time = 0.0;
-        Point current_pos = agent.get_pose().position;
-        double velocity = agent.get_velocity();
-
-        // Default velocity if not set
-        if (velocity <= 0.0) {
-            velocity = 2.0; // 2 m/s default
-        }
-
-        // Compute time for entire path
-        for (size_t i = 0; i < path.size(); i++) {
-            const TaskID &task_id = path[i];
-
-            // Get task from spatial index
-            auto task_opt = spatial_index.get_task(task_id);
-            if (!task_opt) {
-                continue; // Skip if task not found
-            }
-
-            const Task &task = *task_opt;
-
-            // Travel time to task
-            Point task_pos = task.get_position();
-            double travel_time = compute_travel_time(current_pos, task_pos, velocity);
-            total_time += travel_time;
-
-            // Task execution time
-            double task_time = compute_task_time(task);
-            total_time += task_time;
-
-            // Update current position (end of task if geometric, center otherwise)
-            if (task.has_geometry()) {
-                current_pos = task.get_tail(); // End at tail of geometric task
-            } else {
-                current_pos = task_pos;
-            }
-        }
+    void TaskScorer::find_optimal_insertions(const PathProfile &profile, InsertionBatch &batch,
+                                             std::vector<Insertion> &out) const {
+        std::visit([&](const auto &scorer) { scorer.find_optimal_insertions(profile, batch, out); }, scorer_);
+    }
 
-        // RPT = -total_time (negative because we want to minimize time)
-        // Higher score is better in CBBA, so we return negative time
-        return -total_time;
+    Score TaskScorer::evaluate_splice(const PathProfile &profile, size_t first, size_t last,
+                                      std::span<const PathStep> steps, const SpatialIndex &spatial_index) const {
+        return std::visit(
+            [&](const auto &scorer) { return scorer.evaluate_splice(profile, first, last, steps, spatial_index); },
+            scorer_);
     }
 
-    Score TaskScorer::compute_tdr_score(const CBBAAgent &agent, const Path &path,
-                                        const SpatialIndex &spatial_index) const {
-        if (path.empty()) {
-            return 0.0;
-        }
+    void TaskScorer::compute_path_profile(const CBBAAgent &agent, const Path &path,
+                                          const SpatialIndex &spatial_index, PathProfile &profile) const {
+        std::visit([&](const auto &scorer) { scorer.compute_path_profile(agent, path, spatial_index, profile); },
+                   scorer_);
+    }
 
-        double total_reward = 0.0;
-        double cumulative_time = 0.0;
-        Point current_pos = agent.get_pose().position;
-        double velocity = agent.get_velocity();
+    PathBounds TaskScorer::compute_path_bounds(const CBBAAgent &agent, const Path &path,
+                                               const SpatialIndex &spatial_index) const {
+        return std::visit([&](const auto &scorer) { return scorer.compute_path_bounds(agent, path, spatial_index); },
+                          scorer_);
+    }
 
-        // Default velocity if not set
-        if (velocity <= 0.0) {
-            velocity = 2.0;
-        }
+    Score TaskScorer::marginal_gain_bound(const CBBAAgent &agent, const PathBounds &bounds, double distance,
+                                          double duration, double length) const {
+        return std::visit(
+            [&](const auto &scorer) { return scorer.marginal_gain_bound(agent, bounds, distance, duration, length); },
+            scorer_);
+    }
 
-        // Compute time-discounted reward
-        for (size_t i = 0; i < path.size(); i++) {
-            const TaskID &task_id = path[i];
-
-            // Get task from spatial index
-            auto task_opt = spatial_index.get_task(task_id);
-            if (!task_opt) {
-                continue;
-            }
-
-            const Task &task = *task_opt;
-
-            // Travel time to task
-            Point task_pos = task.get_position();
-            double travel_time = compute_travel_time(current_pos, task_pos, velocity);
-            cumulative_time += travel_time;
-
-            // Task execution time
-            double task_time = compute_task_time(task);
-            cumulative_time += task_time;
-
-            // Add discounted reward: lambda^t
-            double discount_factor = std::pow(lambda_, cumulative_time);
-            total_reward += discount_factor;
-
-            // Update current position
-            if (task.has_geometry()) {
-                current_pos = task.get_tail();
-            } else {
-                current_pos = task_pos;
-            }
+    void TaskScorer::set_metric(Metric metric) {
+        if (metric == Metric::RPT) {
+            scorer_.emplace<BasicTaskScorer<RptPolicy>>(RptPolicy{});
+        } else {
+            scorer_.emplace<BasicTaskScorer<TdrPolicy>>(TdrPolicy{lambda_});
         }
-
-        return total_reward;
     }
 
 } // namespace consens::cbba
@@ -0,0 +1,389 @@
+#include "consens/cbba/spatial_backend.hpp"
+
+#include <boost/iterator/function_output_iterator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace consens::cbba {
+
+    namespace {
+
+        // Node size of the default configuration, served by a compile-time R-tree
+        constexpr size_t DEFAULT_NODE_SIZE = SpatialIndexConfig{}.node_size;
+
+        using Candidate = std::pair<double, TaskIndex>; // (comparable distance, handle)
+        using CandidateHeap = std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>>;
+
+        /**
+         * Sort candidates closest first (ties by handle) and drop duplicates
+         */
+        void sort_candidates(std::vector<Candidate> &candidates) {
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        }
+
+        /**
+         * R-tree backend, parameterised by boost's split parameters
+         * Compile-time parameters (bgi::quadratic<N>) let boost fix the node layout; the
+         * run-time ones (bgi::dynamic_*) take any node size.
+         */
+        template <typename Params> class RTreeBackend : public SpatialBackend {
+          private:
+            using Tree = bgi::rtree<RTreeValue, Params>;
+
+            Params params_;
+            Tree tree_;
+
+          public:
+            explicit RTreeBackend(const Params &params) : params_(params), tree_(params) {}
+
+            void insert(const RTreeValue &value) override { tree_.insert(value); }
+
+            void insert_bulk(std::vector<RTreeValue> &values) override {
+                // Small batch into a large tree: regular inserts are cheaper than a full repack
+                if (values.size() < tree_.size()) {
+                    tree_.insert(values.begin(), values.end());
+                    return;
+                }
+
+                // Bulk-load: repack existing entries together with the new ones
+                values.insert(values.end(), tree_.begin(), tree_.end());
+                Tree packed(values.begin(), values.end(), params_);
+                tree_ = std::move(packed);
+            }
+
+            bool remove(const RTreeValue &value) override { return tree_.remove(value) > 0; }
+
+            void clear() override { tree_.clear(); }
+
+            size_t size() const override { return tree_.size(); }
+
+            void query_box(const BoostBox &box, std::vector<TaskIndex> &out) const override {
+                for (auto it = tree_.qbegin(bgi::intersects(box)); it != tree_.qend(); ++it) {
+                    out.push_back(it->second);
+                }
+            }
+
+            void visit_box(const BoostBox &box, TaskVisitor visit) const override {
+                // The visitor runs as a satisfies predicate inside the traversal and rejects
+                // every value, so nothing is ever copied to an output container
+                auto visit_and_reject = [&](const RTreeValue &value) {
+                    visit(value.second);
+                    return false;
+                };
+                tree_.query(bgi::intersects(box) && bgi::satisfies(visit_and_reject),
+                            boost::make_function_output_iterator([](const RTreeValue &) {}));
+            }
+
+            void query_nearest(const BoostPoint &point, size_t k, std::vector<TaskIndex> &out) const override {
+                // The iterator already yields values in distance order; sorting only makes the order
+                // of equal-distance handles deterministic
+                std::vector<Candidate> candidates;
+                candidates.reserve(k);
+                for (auto it = tree_.qbegin(bgi::nearest(point, k)); it != tree_.qend(); ++it) {
+                    candidates.emplace_back(bg::comparable_distance(point, it->first), it->second);
+                }
+
+                sort_candidates(candidates);
+                for (const auto &candidate : candidates) {
+                    out.push_back(candidate.second);
+                }
+            }
+
+            void visit_nearest(const BoostPoint &point, NearestVisitor visit) const override {
+                if (tree_.empty()) {
+                    return;
+                }
+
+                // Asking for every value makes the query iterator an incremental best-first traversal
+                for (auto it = tree_.qbegin(bgi::nearest(point, tree_.size())); it != tree_.qend(); ++it) {
+                    if (!visit(it->second, bg::distance(point, it->first))) {
+                        return;
+                    }
+                }
+            }
+        };
+
+        /**
+         * Hashed uniform grid backend
+         * Each entry is stored in every cell its box overlaps. Box queries visit only the
+         * overlapped cells; nearest queries expand square rings of cells around the point.
+         */
+        class GridBackend : public SpatialBackend {
+          private:
+            double cell_size_;
+            std::unordered_map<uint64_t, std::vector<RTreeValue>> cells_;
+            size_t count_;
+
+            // Occupied cell range (empty if max < min), bounds ring expansion and box scans;
+            // recomputed when a removal empties a cell on its edge
+            int32_t min_cx_, min_cy_, max_cx_, max_cy_;
+
+            int32_t cell_coord(double v) const { return static_cast<int32_t>(std::floor(v / cell_size_)); }
+
+            static uint64_t cell_key(int32_t cx, int32_t cy) {
+                return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+            }
+
+            /**
+             * Recompute the occupied cell range from the non-empty cells
+             */
+            void recompute_bounds() {
+                min_cx_ = min_cy_ = 0;
+                max_cx_ = max_cy_ = -1;
+                bool first = true;
+                for (const auto &[key, entries] : cells_) {
+                    int32_t cx = static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+                    int32_t cy = static_cast<int32_t>(static_cast<uint32_t>(key));
+                    if (first) {
+                        min_cx_ = max_cx_ = cx;
+                        min_cy_ = max_cy_ = cy;
+                        first = false;
+                    }
+                    min_cx_ = std::min(min_cx_, cx);
+                    min_cy_ = std::min(min_cy_, cy);
+                    max_cx_ = std::max(max_cx_, cx);
+                    max_cy_ = std::max(max_cy_, cy);
+                }
+            }
+
+            /**
+             * Visit every cell a box overlaps, optionally clipped to the occupied cell range
+             */
+            template <typename Fn> void for_each_cell(const BoostBox &box, bool clip, Fn &&fn) const {
+                int32_t x0 = cell_coord(box.min_corner().get<0>());
+                int32_t y0 = cell_coord(box.min_corner().get<1>());
+                int32_t x1 = cell_coord(box.max_corner().get<0>());
+                int32_t y1 = cell_coord(box.max_corner().get<1>());
+                if (clip) {
+                    x0 = std::max(x0, min_cx_);
+                    y0 = std::max(y0, min_cy_);
+                    x1 = std::min(x1, max_cx_);
+                    y1 = std::min(y1, max_cy_);
+                }
+                for (int32_t cx = x0; cx <= x1; ++cx) {
+                    for (int32_t cy = y0; cy <= y1; ++cy) {
+                        fn(cx, cy);
+                    }
+                }
+            }
+
+            /**
+             * Push entries of a cell onto the nearest-search heap
+             * An entry overlapping several cells is only taken from its cell closest to the
+             * query cell (cx, cy), so each entry is pushed exactly once per search
+             */
+            void scan_cell(int32_t cell_x, int32_t cell_y, int32_t cx, int32_t cy, const BoostPoint &point,
+                           CandidateHeap &heap) const {
+                auto it = cells_.find(cell_key(cell_x, cell_y));
+                if (it == cells_.end()) {
+                    return;
+                }
+                for (const auto &value : it->second) {
+                    int32_t x0 = cell_coord(value.first.min_corner().get<0>());
+                    int32_t y0 = cell_coord(value.first.min_corner().get<1>());
+                    int32_t x1 = cell_coord(value.first.max_corner().get<0>());
+                    int32_t y1 = cell_coord(value.first.max_corner().get<1>());
+                    if (std::clamp(cx, x0, x1) == cell_x && std::clamp(cy, y0, y1) == cell_y) {
+                        heap.emplace(bg::comparable_distance(point, value.first), value.second);
+                    }
+                }
+            }
+
+          public:
+            explicit GridBackend(double cell_size)
+                : cell_size_(cell_size > 0.0 ? cell_size : 1.0), count_(0), min_cx_(0), min_cy_(0), max_cx_(-1),
+                  max_cy_(-1) {}
+
+            void insert(const RTreeValue &value) override {
+                for_each_cell(value.first, false, [&](int32_t cx, int32_t cy) {
+                    cells_[cell_key(cx, cy)].push_back(value);
+                    if (max_cx_ < min_cx_) {
+                        min_cx_ = max_cx_ = cx;
+                        min_cy_ = max_cy_ = cy;
+                    }
+                    min_cx_ = std::min(min_cx_, cx);
+                    min_cy_ = std::min(min_cy_, cy);
+                    max_cx_ = std::max(max_cx_, cx);
+                    max_cy_ = std::max(max_cy_, cy);
+                });
+                count_++;
+            }
+
+            void insert_bulk(std::vector<RTreeValue> &values) override {
+                for (const auto &value : values) {
+                    insert(value);
+                }
+            }
+
+            bool remove(const RTreeValue &value) override {
+                bool found = false;
+                bool edge_emptied = false;
+                for_each_cell(value.first, false, [&](int32_t cx, int32_t cy) {
+                    auto it = cells_.find(cell_key(cx, cy));
+                    if (it == cells_.end()) {
+                        return;
+                    }
+                    auto &entries = it->second;
+                    auto entry = std::find_if(entries.begin(), entries.end(), [&](const RTreeValue &v) {
+                        return v.second == value.second && bg::equals(v.first, value.first);
+                    });
+                    if (entry != entries.end()) {
+                        *entry = entries.back();
+                        entries.pop_back();
+                        found = true;
+                    }
+                    if (entries.empty()) {
+                        cells_.erase(it);
+                        edge_emptied = edge_emptied || cx == min_cx_ || cx == max_cx_ || cy == min_cy_ || cy == max_cy_;
+                    }
+                });
+                if (found) {
+                    count_--;
+                }
+                if (count_ == 0) {
+                    clear();
+                } else if (edge_emptied) {
+                    recompute_bounds();
+                }
+                return found;
+            }
+
+            void clear() override {
+                cells_.clear();
+                count_ = 0;
+                min_cx_ = min_cy_ = 0;
+                max_cx_ = max_cy_ = -1;
+            }
+
+            size_t size() const override { return count_; }
+
+            void query_box(const BoostBox &box, std::vector<TaskIndex> &out) const override {
+                auto collect = [&](TaskIndex task) { out.push_back(task); };
+                visit_box(box, collect);
+            }
+
+            void visit_box(const BoostBox &box, TaskVisitor visit) const override {
+                for_each_cell(box, true, [&](int32_t cx, int32_t cy) {
+                    auto it = cells_.find(cell_key(cx, cy));
+                    if (it == cells_.end()) {
+                        return;
+                    }
+                    for (const auto &value : it->second) {
+                        if (!bg::intersects(value.first, box)) {
+                            continue;
+                        }
+
+                        // Report each entry once: only from the cell holding the lower-left
+                        // corner of the entry/query overlap
+                        double rx = std::max(value.first.min_corner().get<0>(), box.min_corner().get<0>());
+                        double ry = std::max(value.first.min_corner().get<1>(), box.min_corner().get<1>());
+                        if (cell_coord(rx) == cx && cell_coord(ry) == cy) {
+                            visit(value.second);
+                        }
+                    }
+                });
+            }
+
+            void query_nearest(const BoostPoint &point, size_t k, std::vector<TaskIndex> &out) const override {
+                if (k == 0) {
+                    return;
+                }
+
+                size_t found = 0;
+                auto collect = [&](TaskIndex task, double) {
+                    out.push_back(task);
+                    return ++found < k;
+                };
+                visit_nearest(point, collect);
+            }
+
+            void visit_nearest(const BoostPoint &point, NearestVisitor visit) const override {
+                if (count_ == 0) {
+                    return;
+                }
+
+                double px = point.get<0>();
+                double py = point.get<1>();
+                int32_t cx = cell_coord(px);
+                int32_t cy = cell_coord(py);
+
+                // Rings from the first one that reaches the occupied cells to the one covering them all
+                int64_t min_ring = std::max({int64_t{min_cx_} - cx, int64_t{cx} - max_cx_, int64_t{min_cy_} - cy,
+                                             int64_t{cy} - max_cy_, int64_t{0}});
+                int64_t max_ring = std::max({int64_t{cx} - min_cx_, int64_t{max_cx_} - cx, int64_t{cy} - min_cy_,
+                                             int64_t{max_cy_} - cy, int64_t{0}});
+
+                CandidateHeap heap;
+
+                // Scan the parts of ring r that lie in the occupied range: rows cy -/+ r over
+                // [cx - r, cx + r], then columns cx -/+ r between them
+                auto scan_ring = [&](int64_t r) {
+                    int64_t x0 = std::max<int64_t>(cx - r, min_cx_), x1 = std::min<int64_t>(cx + r, max_cx_);
+                    for (int64_t y : {int64_t{cy} - r, int64_t{cy} + r}) {
+                        if (y >= min_cy_ && y <= max_cy_) {
+                            for (int64_t x = x0; x <= x1; ++x) {
+                                scan_cell(static_cast<int32_t>(x), static_cast<int32_t>(y), cx, cy, point, heap);
+                            }
+                        }
+                        if (r == 0) {
+                            return;
+                        }
+                    }
+                    int64_t y0 = std::max<int64_t>(cy - r + 1, min_cy_), y1 = std::min<int64_t>(cy + r - 1, max_cy_);
+                    for (int64_t x : {int64_t{cx} - r, int64_t{cx} + r}) {
+                        if (x >= min_cx_ && x <= max_cx_) {
+                            for (int64_t y = y0; y <= y1; ++y) {
+                                scan_cell(static_cast<int32_t>(x), static_cast<int32_t>(y), cx, cy, point, heap);
+                            }
+                        }
+                    }
+                };
+
+                for (int64_t r = min_ring; r <= max_ring; ++r) {
+                    scan_ring(r);
+
+                    // Anything outside the visited square is at least `guard` away, so every
+                    // pending entry closer than that is final
+                    double guard = std::min({px - (cx - r) * cell_size_, (cx + r + 1) * cell_size_ - px,
+                                             py - (cy - r) * cell_size_, (cy + r + 1) * cell_size_ - py});
+                    double guard_sq = r == max_ring ? std::numeric_limits<double>::infinity() : guard * guard;
+                    while (!heap.empty() && heap.top().first <= guard_sq) {
+                        Candidate next = heap.top();
+                        heap.pop();
+                        if (!visit(next.second, std::sqrt(next.first))) {
+                            return;
+                        }
+                    }
+                }
+            }
+        };
+
+    } // namespace
+
+    std::unique_ptr<SpatialBackend> make_spatial_backend(const SpatialIndexConfig &config) {
+        size_t node_size = std::max<size_t>(config.node_size, 4);
+
+        switch (config.type) {
+        case SpatialIndexType::LINEAR:
+            return std::make_unique<RTreeBackend<bgi::dynamic_linear>>(bgi::dynamic_linear(node_size));
+        case SpatialIndexType::RSTAR:
+            return std::make_unique<RTreeBackend<bgi::dynamic_rstar>>(bgi::dynamic_rstar(node_size));
+        case SpatialIndexType::GRID:
+            return std::make_unique<GridBackend>(config.grid_cell_size);
+        case SpatialIndexType::QUADRATIC:
+        default:
+            if (node_size == DEFAULT_NODE_SIZE) {
+                return std::make_unique<RTreeBackend<bgi::quadratic<DEFAULT_NODE_SIZE>>>(
+                    bgi::quadratic<DEFAULT_NODE_SIZE>());
+            }
+            return std::make_unique<RTreeBackend<bgi::dynamic_quadratic>>(bgi::dynamic_quadratic(node_size));
+        }
+    }
+
+} // namespace consens::cbba
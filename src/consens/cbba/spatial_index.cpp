@@ -4,42 +4,129 @@
 
 namespace consens::cbba {
 
-    SpatialIndex::SpatialIndex() : rtree_(std::make_unique<RTree>()) {}
+    SpatialIndex::SpatialIndex(const SpatialIndexConfig &config)
+        : owned_store_(std::make_unique<TaskStore>()), store_(owned_store_.get()),
+          backend_(make_spatial_backend(config)), count_(0), revision_(0) {}
+
+    SpatialIndex::SpatialIndex(TaskStore &store, const SpatialIndexConfig &config)
+        : store_(&store), backend_(make_spatial_backend(config)), count_(0), revision_(0) {}
 
     SpatialIndex::~SpatialIndex() = default;
 
     void SpatialIndex::insert(const Task &task) {
-        // Store task in map
-        tasks_[task.get_id()] = task;
+        TaskIndex index = task_ids().find(task.get_id());
+
+        // Drop the old index entry while the store still holds the old geometry
+        if (is_indexed(index)) {
+            backend_->remove(std::make_pair(task_to_boost_box(*store_->get(index)), index));
+            indexed_[index] = 0;
+            count_--;
+        }
+
+        index = store_->insert(task);
+        insert(index);
+    }
+
+    void SpatialIndex::insert(TaskIndex task) {
+        const Task *stored = store_->get(task);
+        if (!stored || is_indexed(task)) {
+            return;
+        }
+
+        if (task >= indexed_.size()) {
+            indexed_.resize(static_cast<size_t>(task) + 1, 0);
+        }
+
+        // Insert into backend
+        backend_->insert(std::make_pair(task_to_boost_box(*stored), task));
+        indexed_[task] = 1;
+        count_++;
+        revision_++;
+        set_task_revision(task);
+    }
 
-        // Get pointer to the TaskID in the map (stable across inserts)
-        const TaskID *id_ptr = &tasks_.find(task.get_id())->first;
+    void SpatialIndex::insert(std::span<const Task> tasks) {
+        std::vector<TaskIndex> indices;
+        indices.reserve(tasks.size());
+
+        for (const Task &task : tasks) {
+            TaskIndex index = task_ids().find(task.get_id());
+
+            // Drop the old index entry while the store still holds the old geometry
+            if (is_indexed(index)) {
+                backend_->remove(std::make_pair(task_to_boost_box(*store_->get(index)), index));
+                indexed_[index] = 0;
+                count_--;
+            }
+
+            indices.push_back(store_->insert(task));
+        }
+
+        insert(std::span<const TaskIndex>(indices));
+    }
+
+    void SpatialIndex::insert(std::span<const TaskIndex> tasks) {
+        std::vector<RTreeValue> values;
+        values.reserve(tasks.size());
+
+        for (TaskIndex task : tasks) {
+            const Task *stored = store_->get(task);
+            if (!stored || is_indexed(task)) {
+                continue;
+            }
+
+            if (task >= indexed_.size()) {
+                indexed_.resize(static_cast<size_t>(task) + 1, 0);
+            }
+            indexed_[task] = 1;
+            count_++;
+            values.emplace_back(task_to_boost_box(*stored), task);
+        }
 
-        // Insert into R-tree
-        BoostBox box = task_to_boost_box(task);
-        rtree_->insert(std::make_pair(box, id_ptr));
+        if (!values.empty()) {
+            backend_->insert_bulk(values);
+            revision_++;
+            for (const RTreeValue &value : values) {
+                set_task_revision(value.second);
+            }
+        }
     }
 
-    void SpatialIndex::remove(const TaskID &task_id) {
-        auto it = tasks_.find(task_id);
-        if (it == tasks_.end()) {
+    void SpatialIndex::remove(TaskIndex task) {
+        if (!is_indexed(task)) {
             return;
         }
 
-        // Remove from R-tree
-        const TaskID *id_ptr = &it->first;
-        BoostBox box = task_to_boost_box(it->second);
+        // Remove from backend
+        backend_->remove(std::make_pair(task_to_boost_box(*store_->get(task)), task));
+        indexed_[task] = 0;
+        count_--;
+        revision_++;
+        set_task_revision(task);
+
+        if (owned_store_) {
+            store_->remove(task);
+        }
+    }
 
-        // Remove all entries with this ID
-        rtree_->remove(std::make_pair(box, id_ptr));
+    void SpatialIndex::remove(const TaskID &task_id) { remove(task_ids().find(task_id)); }
 
-        // Remove from map
-        tasks_.erase(it);
+    void SpatialIndex::set_task_revision(TaskIndex task) {
+        if (task >= task_revisions_.size()) {
+            task_revisions_.resize(static_cast<size_t>(task) + 1, 0);
+        }
+        task_revisions_[task] = revision_;
     }
 
     void SpatialIndex::clear() {
-        rtree_->clear();
-        tasks_.clear();
+        backend_->clear();
+        indexed_.clear();
+        count_ = 0;
+        revision_++;
+
+        if (owned_store_) {
+            store_->clear();
+        }
     }
 
     std::vector<TaskID> SpatialIndex::query_nearest(const Point &position, size_t k) const {
@@ -47,88 +134,94 @@ namespace consens::cbba {
         BoostPoint query_point = to_boost_point(position);
 
         // Query k nearest neighbors
-        std::vector<RTreeValue> nearest;
-        rtree_->query(bgi::nearest(query_point, k), std::back_inserter(nearest));
+        std::vector<TaskIndex> nearest;
+        backend_->query_nearest(query_point, k, nearest);
 
         // Extract task IDs
         result.reserve(nearest.size());
-        for (const auto &value : nearest) {
-            result.push_back(*value.second);
+        for (TaskIndex task : nearest) {
+            result.push_back(task_ids().name(task));
         }
 
         return result;
     }
 
     std::vector<TaskID> SpatialIndex::query_radius(const Point &position, double radius) const {
-        std::vector<TaskID> result;
-        BoostPoint query_point = to_boost_point(position);
-
-        // Create a bounding box for the radius query
-        BoostBox query_box(BoostPoint(position.x - radius, position.y - radius),
-                           BoostPoint(position.x + radius, position.y + radius));
+        std::vector<TaskIndex> found;
+        query_radius(position, radius, found);
 
-        // Query all tasks intersecting the box
-        std::vector<RTreeValue> candidates;
-        rtree_->query(bgi::intersects(query_box), std::back_inserter(candidates));
-
-        // Filter by actual distance
-        result.reserve(candidates.size());
-        for (const auto &value : candidates) {
-            const Task &task = tasks_.at(*value.second);
-            double dist = position.distance_to(task.get_position());
-            if (dist <= radius) {
-                result.push_back(*value.second);
-            }
+        std::vector<TaskID> result;
+        result.reserve(found.size());
+        for (TaskIndex task : found) {
+            result.push_back(task_ids().name(task));
         }
 
         return result;
     }
 
+    void SpatialIndex::query_radius(const Point &position, double radius, std::vector<TaskIndex> &out) const {
+        out.clear();
+        visit_radius(position, radius, [&](TaskIndex task, double) { out.push_back(task); });
+    }
+
+    void SpatialIndex::query_radius(const Point &position, double radius, std::vector<TaskDistance> &out) const {
+        out.clear();
+        visit_radius(position, radius, [&](TaskIndex task, double dist) { out.emplace_back(task, dist); });
+    }
+
     std::vector<TaskID> SpatialIndex::query_box(const BoundingBox &bbox) const {
         std::vector<TaskID> result;
         BoostBox query_box = to_boost_box(bbox);
 
         // Query all tasks intersecting the box
-        std::vector<RTreeValue> found;
-        rtree_->query(bgi::intersects(query_box), std::back_inserter(found));
+        std::vector<TaskIndex> found;
+        backend_->query_box(query_box, found);
 
         // Extract task IDs
         result.reserve(found.size());
-        for (const auto &value : found) {
-            result.push_back(*value.second);
+        for (TaskIndex task : found) {
+            result.push_back(task_ids().name(task));
         }
 
         return result;
     }
 
-    std::optional<Task> SpatialIndex::get_task(const TaskID &id) const {
-        auto it = tasks_.find(id);
-        if (it != tasks_.end()) {
-            return it->second;
+    std::optional<Task> SpatialIndex::get_task(TaskIndex task) const {
+        const Task *found = find_task(task);
+        if (found) {
+            return *found;
         }
         return std::nullopt;
     }
 
-    bool SpatialIndex::has_task(const TaskID &id) const { return tasks_.find(id) != tasks_.end(); }
+    std::optional<Task> SpatialIndex::get_task(const TaskID &id) const { return get_task(task_ids().find(id)); }
+
+    bool SpatialIndex::has_task(TaskIndex task) const { return is_indexed(task); }
 
-    size_t SpatialIndex::size() const { return tasks_.size(); }
+    bool SpatialIndex::has_task(const TaskID &id) const { return has_task(task_ids().find(id)); }
 
-    bool SpatialIndex::empty() const { return tasks_.empty(); }
+    size_t SpatialIndex::size() const { return count_; }
+
+    bool SpatialIndex::empty() const { return count_ == 0; }
 
     std::vector<TaskID> SpatialIndex::get_all_task_ids() const {
         std::vector<TaskID> result;
-        result.reserve(tasks_.size());
-        for (const auto &[id, task] : tasks_) {
-            result.push_back(id);
+        result.reserve(count_);
+        for (TaskIndex task = 0; task < indexed_.size(); ++task) {
+            if (indexed_[task]) {
+                result.push_back(task_ids().name(task));
+            }
         }
         return result;
     }
 
     std::vector<Task> SpatialIndex::get_all_tasks() const {
         std::vector<Task> result;
-        result.reserve(tasks_.size());
-        for (const auto &[id, task] : tasks_) {
-            result.push_back(task);
+        result.reserve(count_);
+        for (TaskIndex task = 0; task < indexed_.size(); ++task) {
+            if (indexed_[task]) {
+                result.push_back(*store_->get(task));
+            }
         }
         return result;
     }
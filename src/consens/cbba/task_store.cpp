@@ -0,0 +1,52 @@
+#include "consens/cbba/task_store.hpp"
+
+namespace consens::cbba {
+
+    TaskIndex TaskStore::insert(const Task &task) {
+        // Replacing a stored task keeps its reference; a new one takes one
+        TaskIndex index = task_ids().find(task.get_id());
+        if (!contains(index)) {
+            index = task_ids().acquire(task.get_id());
+        }
+        if (index == NO_TASK) {
+            return NO_TASK;
+        }
+
+        if (index >= present_.size()) {
+            size_t size = static_cast<size_t>(index) + 1;
+            tasks_.resize(size);
+            present_.resize(size, 0);
+        }
+
+        tasks_[index] = task;
+        if (!present_[index]) {
+            present_[index] = 1;
+            count_++;
+        }
+        return index;
+    }
+
+    bool TaskStore::remove(TaskIndex task) {
+        if (!contains(task)) {
+            return false;
+        }
+
+        tasks_[task] = Task();
+        present_[task] = 0;
+        count_--;
+        task_ids().release(task);
+        return true;
+    }
+
+    void TaskStore::clear() {
+        for (TaskIndex i = 0; i < present_.size(); ++i) {
+            if (present_[i]) {
+                task_ids().release(i);
+            }
+        }
+        tasks_.clear();
+        present_.clear();
+        count_ = 0;
+    }
+
+} // namespace consens::cbba
@@ -0,0 +1,140 @@
+#include "consens/cbba/travel_cost.hpp"
+
+#include <algorithm>
+
+namespace consens::cbba {
+
+    TravelCostCache::TravelCostCache(std::shared_ptr<const TravelCostModel> model, const SpatialIndex &spatial_index,
+                                     size_t capacity)
+        : model_(std::move(model)), spatial_index_(&spatial_index), capacity_(std::max<size_t>(capacity, 1)),
+          head_(NONE), tail_(NONE), origin_generation_(1), hits_(0), misses_(0) {
+        legs_.reserve(std::min(capacity_, DEFAULT_TRAVEL_CACHE_CAPACITY));
+        slots_.reserve(std::min(capacity_, DEFAULT_TRAVEL_CACHE_CAPACITY));
+    }
+
+    double TravelCostCache::distance(TaskIndex from, Direction from_direction, const Point &from_point, TaskIndex to,
+                                     Direction to_direction, const Point &to_point) {
+        if (to >= CACHED_TASKS || (from != NO_TASK && from >= CACHED_TASKS)) {
+            misses_++;
+            return model_->distance(from_point, to_point);
+        }
+
+        uint64_t to_revision = spatial_index_->task_revision(to);
+        if (from == NO_TASK) {
+            return origin_distance(from_point, end(to, to_direction), to_point, to_revision);
+        }
+
+        uint64_t from_revision = spatial_index_->task_revision(from);
+        uint64_t key = (static_cast<uint64_t>(end(from, from_direction)) << 32) | end(to, to_direction);
+
+        auto it = slots_.find(key);
+        if (it != slots_.end()) {
+            Leg &leg = legs_[it->second];
+            touch(it->second);
+            if (leg.from_revision == from_revision && leg.to_revision == to_revision) {
+                hits_++;
+                return leg.distance;
+            }
+
+            // One of the tasks changed since: recompute in place
+            misses_++;
+            leg.distance = model_->distance(from_point, to_point);
+            leg.from_revision = from_revision;
+            leg.to_revision = to_revision;
+            return leg.distance;
+        }
+
+        misses_++;
+        double distance = model_->distance(from_point, to_point);
+
+        // Reuse the least recently used leg once full
+        uint32_t index;
+        if (legs_.size() < capacity_) {
+            index = static_cast<uint32_t>(legs_.size());
+            legs_.push_back(Leg{});
+        } else {
+            index = tail_;
+            unlink(index);
+            slots_.erase(legs_[index].key);
+        }
+
+        legs_[index] = Leg{key, from_revision, to_revision, distance, NONE, NONE};
+        slots_.emplace(key, index);
+        touch(index);
+        return distance;
+    }
+
+    void TravelCostCache::clear() {
+        legs_.clear();
+        slots_.clear();
+        head_ = NONE;
+        tail_ = NONE;
+        drop_origin_legs();
+    }
+
+    double TravelCostCache::origin_distance(const Point &origin, uint32_t to_end, const Point &to_point,
+                                            uint64_t to_revision) {
+        if (origin.x != origin_.x || origin.y != origin_.y) {
+            drop_origin_legs();
+            origin_ = origin;
+        }
+
+        if (to_end >= origin_legs_.size()) {
+            origin_legs_.resize(static_cast<size_t>(to_end) + 1, OriginLeg{0.0, 0, 0});
+        }
+
+        OriginLeg &leg = origin_legs_[to_end];
+        if (leg.generation == origin_generation_ && leg.revision == to_revision) {
+            hits_++;
+            return leg.distance;
+        }
+
+        misses_++;
+        leg = OriginLeg{model_->distance(origin, to_point), to_revision, origin_generation_};
+        return leg.distance;
+    }
+
+    void TravelCostCache::drop_origin_legs() {
+        // Generation 0 marks never-written entries; reset them all on wrap-around
+        if (++origin_generation_ == 0) {
+            std::fill(origin_legs_.begin(), origin_legs_.end(), OriginLeg{0.0, 0, 0});
+            origin_generation_ = 1;
+        }
+    }
+
+    void TravelCostCache::touch(uint32_t index) {
+        if (head_ == index) {
+            return;
+        }
+        if (legs_[index].prev != NONE) {
+            unlink(index); // Linked and not the head
+        }
+
+        legs_[index].prev = NONE;
+        legs_[index].next = head_;
+        if (head_ != NONE) {
+            legs_[head_].prev = index;
+        }
+        head_ = index;
+        if (tail_ == NONE) {
+            tail_ = index;
+        }
+    }
+
+    void TravelCostCache::unlink(uint32_t index) {
+        Leg &leg = legs_[index];
+        if (leg.prev != NONE) {
+            legs_[leg.prev].next = leg.next;
+        } else if (head_ == index) {
+            head_ = leg.next;
+        }
+        if (leg.next != NONE) {
+            legs_[leg.next].prev = leg.prev;
+        } else if (tail_ == index) {
+            tail_ = leg.prev;
+        }
+        leg.prev = NONE;
+        leg.next = NONE;
+    }
+
+} // namespace consens::cbba
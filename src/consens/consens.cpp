@@ -18,9 +18,10 @@ namespace consens {
       public:
         explicit Impl(const Config &config) : config_(config) {
             // Default: create CBBA algorithm
-            cbba::CBBAConfig cbba_config;
+            cbba::CBBAConfig cbba_config = config.cbba;
             cbba_config.max_bundle_size = config.max_bundle_size;
             cbba_config.spatial_query_radius = config.spatial_query_radius;
+            cbba_config.enable_logging = config.enable_logging;
 
             auto cbba_alg =
                 new cbba::CBBAAlgorithm(config.agent_id, cbba_config, config.send_message, config.receive_messages);
@@ -67,6 +68,12 @@ namespace consens {
             }
         }
 
+        void add_tasks(std::span<const Task> tasks) {
+            if (algorithm_) {
+                algorithm_->add_tasks(tasks);
+            }
+        }
+
         void remove_task(const TaskID &id) {
             if (algorithm_) {
                 algorithm_->remove_task(id);
@@ -112,6 +119,20 @@ namespace consens {
             return std::nullopt;
         }
 
+        std::vector<TaskStep> get_path_steps() const {
+            if (algorithm_) {
+                return algorithm_->get_path_steps();
+            }
+            return {};
+        }
+
+        std::optional<TaskStep> get_next_step() const {
+            if (algorithm_) {
+                return algorithm_->get_next_step();
+            }
+            return std::nullopt;
+        }
+
         std::optional<Task> get_task(const TaskID &id) const {
             if (algorithm_) {
                 return algorithm_->get_task(id);
@@ -218,6 +239,8 @@ namespace consens {
 
     void Consens::add_task(const Task &task) { impl_->add_task(task); }
 
+    void Consens::add_tasks(std::span<const Task> tasks) { impl_->add_tasks(tasks); }
+
     void Consens::remove_task(const TaskID &id) { impl_->remove_task(id); }
 
     void Consens::mark_task_completed(const TaskID &id) { impl_->mark_task_completed(id); }
@@ -232,6 +255,10 @@ namespace consens {
 
     std::optional<TaskID> Consens::get_next_task() const { return impl_->get_next_task(); }
 
+    std::vector<TaskStep> Consens::get_path_steps() const { return impl_->get_path_steps(); }
+
+    std::optional<TaskStep> Consens::get_next_step() const { return impl_->get_next_step(); }
+
     std::optional<Task> Consens::get_task(const TaskID &id) const { return impl_->get_task(id); }
 
     std::vector<Task> Consens::get_all_tasks() const { return impl_->get_all_tasks(); }
@@ -1,5 +1,7 @@
 #include "consens/task.hpp"
 
+#include <algorithm>
+
 namespace consens {
 
     Task::Task(const TaskID &id, const Point &position, double duration)
@@ -21,6 +23,24 @@ namespace consens {
         return 0.0;
     }
 
+    double Task::distance_to(const Point &point) const {
+        if (!has_geometry_) {
+            return position_.distance_to(point);
+        }
+
+        // Project onto the head-tail segment and clamp to its ends
+        double dx = tail_.x - head_.x;
+        double dy = tail_.y - head_.y;
+        double length_sq = dx * dx + dy * dy;
+        if (length_sq <= 0.0) {
+            return head_.distance_to(point);
+        }
+
+        double t = ((point.x - head_.x) * dx + (point.y - head_.y) * dy) / length_sq;
+        t = std::clamp(t, 0.0, 1.0);
+        return Point(head_.x + t * dx, head_.y + t * dy).distance_to(point);
+    }
+
     void Task::compute_bbox() {
         if (has_geometry_) {
             // Bounding box from head to tail with small padding
@@ -0,0 +1,204 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/bundle.hpp>
+#include <consens/cbba/task_set.hpp>
+
+using namespace consens::cbba;
+
+TEST_CASE("Bundle - Membership") {
+    Bundle bundle(3);
+
+    bundle.add("bundle_a");
+    bundle.add("bundle_b");
+    bundle.add("bundle_a"); // Duplicate ignored
+
+    CHECK(bundle.size() == 2);
+    CHECK(bundle.contains("bundle_a"));
+    CHECK(bundle.contains("bundle_b"));
+    CHECK_FALSE(bundle.contains("bundle_c"));
+    CHECK_FALSE(bundle.contains(NO_TASK));
+
+    SUBCASE("Remove clears membership") {
+        bundle.remove("bundle_a");
+        CHECK_FALSE(bundle.contains("bundle_a"));
+        CHECK(bundle.get_tasks() == std::vector<TaskID>{"bundle_b"});
+    }
+
+    SUBCASE("Remove keeps insertion order of the rest") {
+        bundle.add("bundle_c");
+        bundle.remove("bundle_b");
+        CHECK(bundle.get_tasks() == std::vector<TaskID>{"bundle_a", "bundle_c"});
+        bundle.remove("bundle_c");
+        bundle.add("bundle_b");
+        CHECK(bundle.get_tasks() == std::vector<TaskID>{"bundle_a", "bundle_b"});
+        CHECK(bundle.contains("bundle_b"));
+        CHECK_FALSE(bundle.contains("bundle_c"));
+    }
+
+    SUBCASE("Capacity is respected") {
+        bundle.add("bundle_c");
+        bundle.add("bundle_d");
+        CHECK(bundle.is_full());
+        CHECK_FALSE(bundle.contains("bundle_d"));
+    }
+
+    SUBCASE("Clear") {
+        bundle.clear();
+        CHECK(bundle.empty());
+        CHECK_FALSE(bundle.contains("bundle_a"));
+    }
+}
+
+TEST_CASE("Path - Positions") {
+    Path path;
+    path.insert("path_a", 0);
+    path.insert("path_c", 1);
+    path.insert("path_b", 1);
+
+    CHECK(path.get_tasks() == std::vector<TaskID>{"path_a", "path_b", "path_c"});
+    CHECK(path.find_position("path_a") == 0);
+    CHECK(path.find_position("path_b") == 1);
+    CHECK(path.find_position("path_c") == 2);
+    CHECK(path.find_position("path_missing") == path.size());
+
+    SUBCASE("Duplicate insert is ignored") {
+        path.insert("path_a", 2);
+        CHECK(path.size() == 3);
+        CHECK(path.find_position("path_a") == 0);
+    }
+
+    SUBCASE("Remove shifts later positions") {
+        path.remove("path_a");
+        CHECK_FALSE(path.contains("path_a"));
+        CHECK(path.find_position("path_b") == 0);
+        CHECK(path.find_position("path_c") == 1);
+    }
+
+    SUBCASE("Remove from position") {
+        path.remove_from(1);
+        CHECK(path.size() == 1);
+        CHECK(path.contains("path_a"));
+        CHECK_FALSE(path.contains("path_b"));
+        CHECK_FALSE(path.contains("path_c"));
+
+        path.insert("path_c", 0);
+        CHECK(path.find_position("path_c") == 0);
+        CHECK(path.find_position("path_a") == 1);
+    }
+}
+
+TEST_CASE("Path - Directions Follow Their Tasks") {
+    Path path;
+    path.insert("dir_a", 0);
+    path.insert("dir_c", 1, Direction::REVERSE);
+    path.insert("dir_b", 1);
+
+    CHECK(path.direction_at(0) == Direction::FORWARD);
+    CHECK(path.direction_at(1) == Direction::FORWARD);
+    CHECK(path.direction_at(2) == Direction::REVERSE);
+    CHECK(path.get_direction("dir_c") == Direction::REVERSE);
+    CHECK(path.get_direction("dir_missing") == Direction::FORWARD);
+
+    path.remove("dir_b");
+    CHECK(path.direction_at(1) == Direction::REVERSE);
+
+    path.insert("dir_d", 0, Direction::REVERSE);
+    path.remove_from(2);
+    CHECK(path.size() == 2);
+    CHECK(path.direction_at(0) == Direction::REVERSE);
+    CHECK(path.direction_at(1) == Direction::FORWARD);
+    CHECK(path.get_direction("dir_c") == Direction::FORWARD); // No longer in the path
+}
+
+TEST_CASE("Path - Version Tracks Mutations") {
+    Path path;
+    uint64_t initial = path.version();
+
+    path.insert("version_a", 0);
+    uint64_t after_insert = path.version();
+    CHECK(after_insert != initial);
+
+    path.insert("version_a", 0); // Duplicate, no change
+    CHECK(path.version() == after_insert);
+
+    Path copy = path;
+    CHECK(copy.version() == path.version());
+
+    copy.remove("version_a");
+    CHECK(copy.version() != path.version());
+
+    path.remove("version_missing"); // Missing, no change
+    CHECK(path.version() == after_insert);
+
+    path.clear();
+    CHECK(path.version() != after_insert);
+}
+
+TEST_CASE("Path - Reverse And Rotate") {
+    Path path;
+    for (const char *id : {"move_a", "move_b", "move_c", "move_d", "move_e"}) {
+        path.insert(id, path.size());
+    }
+    path.insert("move_f", path.size(), Direction::REVERSE);
+    uint64_t before = path.version();
+
+    // 2-opt: order and directions of the run flip
+    path.reverse(1, 4);
+    CHECK(path.get_tasks() == std::vector<TaskID>{"move_a", "move_d", "move_c", "move_b", "move_e", "move_f"});
+    CHECK(path.get_direction("move_c") == Direction::REVERSE);
+    CHECK(path.find_position("move_b") == 3);
+    CHECK(path.version() != before);
+
+    path.reverse(5, 6);
+    CHECK(path.get_direction("move_f") == Direction::FORWARD);
+
+    // Or-opt: move_e goes to the front, then move_a and move_d to the back
+    path.rotate(0, 4, 5);
+    CHECK(path.get_tasks() == std::vector<TaskID>{"move_e", "move_a", "move_d", "move_c", "move_b", "move_f"});
+    path.rotate(1, 3, 6);
+    CHECK(path.get_tasks() == std::vector<TaskID>{"move_e", "move_c", "move_b", "move_f", "move_a", "move_d"});
+    for (size_t i = 0; i < path.size(); i++) {
+        CHECK(path.find_position(path.index_at(i)) == i);
+    }
+    CHECK(path.get_direction("move_c") == Direction::REVERSE);
+
+    // Empty ranges are no-ops
+    uint64_t after = path.version();
+    path.reverse(3, 3);
+    path.rotate(2, 2, 5);
+    path.rotate(2, 5, 5);
+    CHECK(path.version() == after);
+}
+
+TEST_CASE("TaskSet - Bitset Membership") {
+    TaskSet set;
+    CHECK(set.empty());
+
+    set.insert(3);
+    set.insert(64);
+    set.insert(200);
+    set.insert(3); // Duplicate ignored
+    set.insert(NO_TASK);
+
+    CHECK(set.size() == 3);
+    CHECK(set.contains(3));
+    CHECK(set.contains(64));
+    CHECK(set.contains(200));
+    CHECK_FALSE(set.contains(4));
+    CHECK_FALSE(set.contains(100000)); // Beyond storage
+    CHECK_FALSE(set.contains(NO_TASK));
+
+    std::vector<TaskIndex> visited;
+    set.for_each([&](TaskIndex task) { visited.push_back(task); });
+    CHECK(visited == std::vector<TaskIndex>{3, 64, 200});
+
+    set.erase(64);
+    set.erase(65); // Missing, no-op
+    CHECK(set.size() == 2);
+    CHECK_FALSE(set.contains(64));
+
+    set.clear();
+    CHECK(set.empty());
+    CHECK_FALSE(set.contains(3));
+}
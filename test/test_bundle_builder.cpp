@@ -6,6 +6,14 @@
 #include <consens/cbba/spatial_index.hpp>
 #include <consens/task.hpp>
 
+#include "test_policies.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using consens::cbba::test::FuelPolicy;
+
 TEST_CASE("BundleBuilder - Basic Setup") {
     consens::cbba::SpatialIndex spatial_index;
     consens::cbba::BundleBuilder builder(&spatial_index);
@@ -93,6 +101,43 @@ TEST_CASE("BundleBuilder - FULLBUNDLE Mode") {
     }
 }
 
+TEST_CASE("BundleBuilder - Rows Are Driven Serpentine") {
+    using namespace consens::cbba;
+
+    // Four parallel rows, all drawn bottom to top
+    SpatialIndex spatial_index;
+    std::vector<TaskIndex> available;
+    for (int i = 0; i < 4; i++) {
+        std::string id = "serp_" + std::to_string(i);
+        spatial_index.insert(consens::Task(id, consens::Point(i * 5.0, 0.0), consens::Point(i * 5.0, 30.0), 10.0));
+        available.push_back(task_ids().find(id));
+    }
+
+    for (BundleMode mode : {BundleMode::ADD, BundleMode::FULLBUNDLE}) {
+        CBBAAgent agent("robot_serp", 4);
+        agent.update_pose(consens::Pose(0.0, -5.0, 0.0));
+        agent.update_velocity(1.0);
+
+        BundleBuilder builder(&spatial_index, Metric::RPT, 100.0f, mode);
+        for (int step = 0; step < 4; step++) {
+            builder.build_bundle(agent, available);
+        }
+
+        // Each row is entered at the end where the previous one finished
+        const Path &path = agent.get_path();
+        REQUIRE(path.size() == 4);
+        CHECK(path.indices() == available);
+        CHECK(path.direction_at(0) == consens::Direction::FORWARD);
+        CHECK(path.direction_at(1) == consens::Direction::REVERSE);
+        CHECK(path.direction_at(2) == consens::Direction::FORWARD);
+        CHECK(path.direction_at(3) == consens::Direction::REVERSE);
+
+        // 5m to the first row, 5m between rows, 4 x 10s of work
+        TaskScorer scorer(Metric::RPT);
+        CHECK(scorer.evaluate_path(agent, path, spatial_index) == doctest::Approx(-60.0));
+    }
+}
+
 TEST_CASE("BundleBuilder - Spatial Filtering") {
     consens::cbba::SpatialIndex spatial_index;
     consens::cbba::BundleBuilder builder(&spatial_index, consens::cbba::Metric::RPT, 30.0f,
@@ -264,3 +309,477 @@ TEST_CASE("BundleBuilder - Bundle Already Full") {
         CHECK(agent.get_bundle().size() == size_before);
     }
 }
+
+TEST_CASE("BundleBuilder - Early Exit Matches Exhaustive Search") {
+    using namespace consens::cbba;
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        BundleBuilder builder(&spatial_index, metric, 150.0f, BundleMode::ADD);
+        TaskScorer scorer(metric);
+
+        // Deterministic mix of point tasks and rows scattered around the agent
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 60; i++) {
+            double x = std::fmod(i * 37.0, 200.0) - 100.0;
+            double y = std::fmod(i * 53.0, 200.0) - 100.0;
+            std::string id = "exit_" + std::to_string(static_cast<int>(metric)) + "_" + std::to_string(i);
+            if (i % 4 == 0) {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), consens::Point(x, y + 40.0), 8.0));
+            } else {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), 2.0 + i % 5));
+            }
+            available.push_back(task_ids().find(id));
+        }
+
+        CBBAAgent agent("robot_exit", 8);
+        agent.update_pose(consens::Pose(5.0, -3.0, 0.0));
+        agent.update_velocity(1.5);
+
+        for (int step = 0; step < 8; step++) {
+            // Reference: score every available task within radius
+            TaskIndex expected = NO_TASK;
+            Score expected_score = MIN_SCORE;
+            for (TaskIndex task : available) {
+                const consens::Task *candidate = spatial_index.find_task(task);
+                if (agent.get_bundle().contains(task) ||
+                    candidate->distance_to(agent.get_pose().position) > 150.0) {
+                    continue;
+                }
+                Score score = scorer.find_optimal_insertion(agent, task, agent.get_path(), spatial_index).score;
+                if (score > expected_score || (score == expected_score && task < expected)) {
+                    expected_score = score;
+                    expected = task;
+                }
+            }
+
+            REQUIRE(expected != NO_TASK);
+            builder.build_bundle(agent, available);
+            CHECK(agent.get_bundle().size() == static_cast<size_t>(step + 1));
+            CHECK(agent.get_bundle().contains(expected));
+        }
+    }
+}
+
+TEST_CASE("BundleBuilder - Bid Cache Reuses Scores Across Ticks") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    BundleBuilder builder(&spatial_index, Metric::RPT, 100.0f, BundleMode::ADD, 1.0);
+
+    std::vector<TaskIndex> available;
+    for (int i = 0; i < 5; i++) {
+        std::string id = "cache_" + std::to_string(i);
+        spatial_index.insert(consens::Task(id, consens::Point(10.0 * (i + 1), 0.0), 5.0));
+        available.push_back(task_ids().find(id));
+    }
+
+    CBBAAgent agent("robot_cache", 5);
+    agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+    agent.update_velocity(2.0);
+
+    // A rival holds every task, so ticks pick a best task but never bid and the path stays put
+    for (TaskIndex task : available) {
+        agent.update_winning_bid(task, Bid("robot_rival", 100.0, 1.0));
+    }
+
+    const BidCache &cache = builder.get_bid_cache();
+    builder.build_bundle(agent, available);
+    size_t scored = cache.misses();
+    CHECK(scored > 0);
+    CHECK(cache.hits() == 0);
+    CHECK(agent.get_bundle().empty());
+
+    SUBCASE("Steady-state tick is served from the cache") {
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() == scored);
+        CHECK(cache.hits() > 0);
+    }
+
+    SUBCASE("Motion within epsilon keeps entries") {
+        agent.update_pose(consens::Pose(0.5, 0.0, 0.0));
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() == scored);
+    }
+
+    SUBCASE("Motion beyond epsilon drops entries") {
+        agent.update_pose(consens::Pose(5.0, 0.0, 0.0));
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() > scored);
+    }
+
+    SUBCASE("Velocity change drops entries") {
+        agent.update_velocity(3.0);
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() > scored);
+    }
+
+    SUBCASE("Task geometry change drops only that task's entry") {
+        spatial_index.insert(consens::Task("cache_0", consens::Point(12.0, 1.0), 5.0));
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() == scored + 1);
+        CHECK(cache.hits() > 0);
+    }
+
+    SUBCASE("Adding and removing other tasks keeps entries") {
+        spatial_index.insert(consens::Task("cache_far", consens::Point(0.0, 500.0), 5.0));
+        spatial_index.remove("cache_far");
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() == scored);
+    }
+
+    SUBCASE("Path change drops entries") {
+        agent.insert_in_path(available[4], 0);
+        builder.build_bundle(agent, available);
+        CHECK(cache.misses() > scored);
+    }
+}
+
+TEST_CASE("BundleBuilder - Early Exit Keeps Rows Along The Route") {
+    using namespace consens::cbba;
+
+    // Driving a row is work, not travel: a row parallel to the leg towards the next path task
+    // shortens that leg, so its insertion delay is negative although many point tasks are nearer
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        std::string prefix = "route_" + std::to_string(static_cast<int>(metric)) + "_";
+        spatial_index.insert(consens::Task(prefix + "goal", consens::Point(0.0, 200.0), 0.0));
+
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 40; i++) {
+            std::string id = prefix + std::to_string(i);
+            spatial_index.insert(consens::Task(id, consens::Point(0.1 * (i % 8), -0.1 * (i / 8)), 0.0));
+            available.push_back(task_ids().find(id));
+        }
+        std::string row = prefix + "row";
+        spatial_index.insert(consens::Task(row, consens::Point(8.0, 0.0), consens::Point(8.0, 200.0), 10.0));
+        available.push_back(task_ids().find(row));
+
+        CBBAAgent agent("robot_route", 5);
+        agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+        agent.update_velocity(2.0);
+        agent.add_to_bundle(prefix + "goal", 1.0, SIZE_MAX);
+
+        // Reference: score every available task
+        TaskScorer scorer(metric);
+        TaskIndex expected = NO_TASK;
+        Score expected_score = MIN_SCORE;
+        for (TaskIndex task : available) {
+            Score score = scorer.find_optimal_insertion(agent, task, agent.get_path(), spatial_index).score;
+            if (score > expected_score || (score == expected_score && task < expected)) {
+                expected_score = score;
+                expected = task;
+            }
+        }
+        if (metric == Metric::RPT) {
+            CHECK(expected == task_ids().find(row));
+        }
+
+        CBBAAgent full = agent;
+        BundleBuilder builder(&spatial_index, metric, 500.0f, BundleMode::ADD);
+        builder.build_bundle(agent, available);
+        CHECK(agent.get_bundle().contains(expected));
+
+        // FULLBUNDLE picks the same tasks as repeated ADD
+        for (int step = 1; step < 4; step++) {
+            builder.build_bundle(agent, available);
+        }
+        BundleBuilder lazy(&spatial_index, metric, 500.0f, BundleMode::FULLBUNDLE);
+        lazy.build_bundle(full, available);
+        CHECK(full.get_path().indices() == agent.get_path().indices());
+    }
+}
+
+TEST_CASE("BundleBuilder - Lazy Full Bundle Matches Repeated Add") {
+    using namespace consens::cbba;
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        std::string prefix = "lazy_" + std::to_string(static_cast<int>(metric)) + "_";
+
+        // Point tasks and rows around the agent, a few of them out of radius
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 80; i++) {
+            double x = std::fmod(i * 41.0, 240.0) - 120.0;
+            double y = std::fmod(i * 59.0, 240.0) - 120.0;
+            std::string id = prefix + std::to_string(i);
+            if (i % 5 == 0) {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), consens::Point(x + 10.0, y + 35.0), 6.0));
+            } else {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), 1.0 + i % 3));
+            }
+            available.push_back(task_ids().find(id));
+        }
+
+        // A rival outbids one task, which ends greedy filling once it becomes the best pick
+        CBBAAgent full("robot_lazy_full", 12);
+        CBBAAgent incremental("robot_lazy_add", 12);
+        for (CBBAAgent *agent : {&full, &incremental}) {
+            agent->update_pose(consens::Pose(-4.0, 7.0, 0.0));
+            agent->update_velocity(1.2);
+            agent->update_winning_bid(available[33], Bid("robot_rival", 100.0, 1.0));
+        }
+
+        BundleBuilder lazy(&spatial_index, metric, 110.0f, BundleMode::FULLBUNDLE);
+        lazy.build_bundle(full, available);
+
+        BundleBuilder greedy(&spatial_index, metric, 110.0f, BundleMode::ADD);
+        for (size_t step = 0; step < 12; step++) {
+            greedy.build_bundle(incremental, available);
+        }
+
+        CHECK(full.get_bundle().size() > 1);
+        CHECK(full.get_path().indices() == incremental.get_path().indices());
+        for (TaskIndex task : full.get_path().indices()) {
+            CHECK(full.get_local_bid(task) == doctest::Approx(incremental.get_local_bid(task)));
+        }
+    }
+}
+
+TEST_CASE("BundleBuilder - Budgeted Full Bundle Resumes Across Calls") {
+    using namespace consens::cbba;
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        std::string prefix = "anytime_" + std::to_string(static_cast<int>(metric)) + "_";
+
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 150; i++) {
+            double x = std::fmod(i * 43.0, 200.0) - 100.0;
+            double y = std::fmod(i * 71.0, 200.0) - 100.0;
+            std::string id = prefix + std::to_string(i);
+            if (i % 6 == 0) {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), consens::Point(x + 25.0, y), 4.0));
+            } else {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), 1.0 + i % 4));
+            }
+            available.push_back(task_ids().find(id));
+        }
+
+        CBBAAgent expected("robot_anytime", 20);
+        CBBAAgent actual("robot_anytime", 20);
+        CBBAAgent interrupted("robot_anytime", 20);
+        for (CBBAAgent *agent : {&expected, &actual, &interrupted}) {
+            agent->update_pose(consens::Pose(3.0, -6.0, 0.0));
+            agent->update_velocity(1.5);
+        }
+
+        BundleBuilder unbudgeted(&spatial_index, metric, 150.0f, BundleMode::FULLBUNDLE);
+        unbudgeted.build_bundle(expected, available);
+        CHECK_FALSE(unbudgeted.is_building());
+        REQUIRE(expected.get_bundle().is_full());
+
+        // A one microsecond budget pauses after (almost) every step; resuming gives the same bundle
+        BundleBuilder budgeted(&spatial_index, metric, 150.0f, BundleMode::FULLBUNDLE);
+        budgeted.set_build_budget(std::chrono::microseconds(1));
+        CHECK(budgeted.get_build_budget() == std::chrono::microseconds(1));
+        size_t calls = 0;
+        do {
+            budgeted.build_bundle(actual, available);
+            calls++;
+        } while (budgeted.is_building() && calls < 100000);
+
+        CHECK(calls > 1);
+        CHECK(actual.get_path().indices() == expected.get_path().indices());
+        for (TaskIndex task : expected.get_path().indices()) {
+            CHECK(actual.get_local_bid(task) == expected.get_local_bid(task));
+        }
+
+        // A path change from outside (here a consensus-style reset) restarts the fill
+        BundleBuilder restarted(&spatial_index, metric, 150.0f, BundleMode::FULLBUNDLE);
+        restarted.set_build_budget(std::chrono::microseconds(1));
+        while (interrupted.get_bundle().size() < 3) {
+            restarted.build_bundle(interrupted, available);
+        }
+        TaskIndex lost = interrupted.get_bundle().indices().front();
+        interrupted.remove_from_bundle(lost);
+        available.erase(std::find(available.begin(), available.end(), lost));
+        calls = 0;
+        do {
+            restarted.build_bundle(interrupted, available);
+            calls++;
+        } while (restarted.is_building() && calls < 100000);
+
+        CHECK(interrupted.get_bundle().is_full());
+        CHECK_FALSE(interrupted.get_bundle().contains(lost));
+    }
+}
+
+TEST_CASE("BundleBuilder - Reset Drops A Paused Fill") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    std::vector<TaskIndex> available;
+    for (int i = 0; i < 120; i++) {
+        std::string id = "reset_fill_" + std::to_string(i);
+        spatial_index.insert(
+            consens::Task(id, consens::Point(std::fmod(i * 37.0, 160.0) - 80.0, std::fmod(i * 59.0, 160.0) - 80.0),
+                          1.0 + i % 3));
+        available.push_back(task_ids().find(id));
+    }
+
+    CBBAAgent expected("robot_reset_fill", 15);
+    CBBAAgent agent("robot_reset_fill", 15);
+    for (CBBAAgent *a : {&expected, &agent}) {
+        a->update_pose(consens::Pose(4.0, 7.0, 0.0));
+        a->update_velocity(1.5);
+    }
+
+    BundleBuilder unbudgeted(&spatial_index, Metric::TDR, 150.0f, BundleMode::FULLBUNDLE);
+    unbudgeted.build_bundle(expected, available);
+
+    BundleBuilder builder(&spatial_index, Metric::TDR, 150.0f, BundleMode::FULLBUNDLE);
+    builder.set_build_budget(std::chrono::microseconds(1));
+    builder.build_bundle(agent, available);
+    REQUIRE(builder.is_building());
+
+    builder.reset();
+    CHECK_FALSE(builder.is_building());
+
+    // The next call starts a new fill, which still ends with the unbudgeted bundle
+    size_t calls = 0;
+    do {
+        builder.build_bundle(agent, available);
+        calls++;
+    } while (builder.is_building() && calls < 100000);
+    CHECK(agent.get_path().indices() == expected.get_path().indices());
+}
+
+TEST_CASE("BundleBuilder - Budgeted Full Bundle Restarts When The Agent Moves") {
+    using namespace consens::cbba;
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        std::string prefix = "moving_" + std::to_string(static_cast<int>(metric)) + "_";
+
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 150; i++) {
+            double x = std::fmod(i * 43.0, 200.0) - 100.0;
+            double y = std::fmod(i * 71.0, 200.0) - 100.0;
+            std::string id = prefix + std::to_string(i);
+            if (i % 6 == 0) {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), consens::Point(x + 25.0, y), 4.0));
+            } else {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), 1.0 + i % 4));
+            }
+            available.push_back(task_ids().find(id));
+        }
+
+        CBBAAgent moving("robot_moving", 20);
+        moving.update_pose(consens::Pose(-80.0, -80.0, 0.0));
+        moving.update_velocity(1.5);
+
+        BundleBuilder budgeted(&spatial_index, metric, 300.0f, BundleMode::FULLBUNDLE);
+        budgeted.set_build_budget(std::chrono::microseconds(1));
+        while (moving.get_bundle().size() < 2) {
+            budgeted.build_bundle(moving, available);
+        }
+        REQUIRE(budgeted.is_building());
+
+        // Move across the map between calls; every call still makes progress
+        for (int step = 1; step <= 3 && budgeted.is_building(); step++) {
+            size_t before = moving.get_bundle().size();
+            moving.update_pose(consens::Pose(-80.0 + 50.0 * step, -80.0 + 40.0 * step, 0.0));
+            budgeted.build_bundle(moving, available);
+            CHECK(moving.get_bundle().size() > before);
+        }
+        moving.update_pose(consens::Pose(90.0, 70.0, 0.0));
+
+        // From here the paused fill must equal an unbudgeted fill from the same state and pose
+        CBBAAgent expected = moving;
+        BundleBuilder unbudgeted(&spatial_index, metric, 300.0f, BundleMode::FULLBUNDLE);
+        unbudgeted.build_bundle(expected, available);
+        REQUIRE(expected.get_bundle().is_full());
+
+        size_t calls = 0;
+        do {
+            budgeted.build_bundle(moving, available);
+            calls++;
+        } while (budgeted.is_building() && calls < 100000);
+
+        CHECK(moving.get_path().indices() == expected.get_path().indices());
+        for (TaskIndex task : expected.get_path().indices()) {
+            CHECK(moving.get_local_bid(task) == expected.get_local_bid(task));
+        }
+
+        // Drift 0.9 pose_epsilon per call: no single step leaves the tolerance, but the drift
+        // adds up, so the fill restarts every second call (from where it started, not where it
+        // last paused). Stop moving at the 10th step, which must restart the fill again. The
+        // radius is small, so a fill that kept its start would not even see the same tasks
+        const double epsilon = 5.0;
+        CBBAAgent drifting("robot_drifting", 40);
+        drifting.update_pose(consens::Pose(-80.0, -80.0, 0.0));
+        drifting.update_velocity(1.5);
+
+        BundleBuilder drifting_builder(&spatial_index, metric, 60.0f, BundleMode::FULLBUNDLE, epsilon);
+        drifting_builder.set_build_budget(std::chrono::microseconds(1));
+        drifting_builder.build_bundle(drifting, available);
+        REQUIRE(drifting_builder.is_building());
+
+        consens::Point fill_start(-80.0, -80.0);
+        CBBAAgent drift_expected = drifting;
+        for (int step = 1; step <= 10; step++) {
+            consens::Point position(-80.0 + 0.9 * epsilon * step, -80.0);
+            drifting.update_pose(consens::Pose(position, 0.0));
+            if (position.distance_to(fill_start) > epsilon) {
+                fill_start = position;
+                drift_expected = drifting;
+            }
+            drifting_builder.build_bundle(drifting, available);
+            REQUIRE(drifting_builder.is_building());
+        }
+        REQUIRE(fill_start.x == doctest::Approx(-80.0 + 0.9 * epsilon * 10));
+
+        calls = 0;
+        do {
+            drifting_builder.build_bundle(drifting, available);
+            calls++;
+        } while (drifting_builder.is_building() && calls < 100000);
+
+        BundleBuilder drift_unbudgeted(&spatial_index, metric, 60.0f, BundleMode::FULLBUNDLE, epsilon);
+        drift_unbudgeted.build_bundle(drift_expected, available);
+        CHECK(drifting.get_path().indices() == drift_expected.get_path().indices());
+        for (TaskIndex task : drift_expected.get_path().indices()) {
+            CHECK(drifting.get_local_bid(task) == drift_expected.get_local_bid(task));
+        }
+    }
+}
+
+TEST_CASE("BundleBuilder - Custom Policy") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    std::vector<TaskIndex> available;
+    for (int i = 0; i < 40; i++) {
+        double x = std::fmod(i * 37.0, 160.0) - 80.0;
+        double y = std::fmod(i * 23.0, 160.0) - 80.0;
+        std::string id = "fuel_" + std::to_string(i);
+        spatial_index.insert(consens::Task(id, consens::Point(x, y), 10.0 * (i % 4)));
+        available.push_back(task_ids().find(id));
+    }
+
+    CBBAAgent full("robot_fuel_full", 8);
+    CBBAAgent incremental("robot_fuel_add", 8);
+    for (CBBAAgent *agent : {&full, &incremental}) {
+        agent->update_pose(consens::Pose(5.0, -5.0, 0.0));
+        agent->update_velocity(1.5);
+    }
+
+    // Durations are free under this policy, so picks follow travel only
+    BasicBundleBuilder<FuelPolicy> lazy(&spatial_index, FuelPolicy{1.0}, 120.0f, BundleMode::FULLBUNDLE);
+    lazy.build_bundle(full, available);
+
+    BasicBundleBuilder<FuelPolicy> greedy(&spatial_index, FuelPolicy{1.0}, 120.0f, BundleMode::ADD);
+    for (size_t step = 0; step < 8; step++) {
+        greedy.build_bundle(incremental, available);
+    }
+
+    CHECK(full.get_bundle().is_full());
+    CHECK(full.get_path().indices() == incremental.get_path().indices());
+
+    Score total = 0.0;
+    for (TaskIndex task : full.get_bundle().indices()) {
+        total += full.get_local_bid(task);
+    }
+    CHECK(total == doctest::Approx(lazy.get_scorer().evaluate_path(full, full.get_path(), spatial_index)));
+}
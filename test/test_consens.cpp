@@ -0,0 +1,299 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/executor.hpp>
+#include <consens/cbba/id_table.hpp>
+#include <consens/cbba/travel_cost.hpp>
+#include <consens/consens.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+    class CountingCostModel : public consens::cbba::TravelCostModel {
+      public:
+        mutable std::atomic<size_t> calls{0};
+
+        double distance(const consens::Point &from, const consens::Point &to) const override {
+            calls++;
+            return from.distance_to(to);
+        }
+    };
+
+    class CountingExecutor : public consens::cbba::Executor {
+      public:
+        size_t calls = 0;
+
+        size_t concurrency() const override { return 2; }
+
+        void parallel_for(size_t count, const std::function<void(size_t)> &job) override {
+            calls++;
+            for (size_t i = 0; i < count; i++) {
+                job(i);
+            }
+        }
+    };
+
+} // namespace
+
+TEST_CASE("Consens - Agents Reach Consensus Without Registering Neighbors") {
+    // Three agents in a line: a <-> b <-> c. a and c only hear of each other through b, and
+    // nobody calls update_neighbors
+    const std::vector<std::string> names = {"e2e_a", "e2e_b", "e2e_c"};
+    const std::vector<std::vector<size_t>> links = {{1}, {0, 2}, {1}};
+    std::vector<std::vector<std::vector<uint8_t>>> inboxes(names.size());
+
+    std::vector<std::unique_ptr<consens::Consens>> agents;
+    for (size_t i = 0; i < names.size(); i++) {
+        consens::Consens::Config config;
+        config.agent_id = names[i];
+        config.spatial_query_radius = 500.0f;
+        config.enable_logging = false;
+        config.send_message = [&, i](const std::vector<uint8_t> &data) {
+            for (size_t j : links[i]) {
+                inboxes[j].push_back(data);
+            }
+        };
+        config.receive_messages = [&, i]() {
+            std::vector<std::vector<uint8_t>> received;
+            received.swap(inboxes[i]);
+            return received;
+        };
+        agents.push_back(std::make_unique<consens::Consens>(config));
+        agents.back()->update_pose(-60.0 + 60.0 * i, 0.0, 0.0);
+        agents.back()->update_velocity(1.0);
+    }
+
+    std::set<consens::TaskID> tasks;
+    for (int t = 0; t < 12; t++) {
+        consens::TaskID id = "e2e_task_" + std::to_string(t);
+        tasks.insert(id);
+        for (auto &agent : agents) {
+            agent->add_task(id, consens::Point(-80.0 + 15.0 * t, (t % 3) * 10.0), 5.0);
+        }
+    }
+
+    for (int tick = 0; tick < 100; tick++) {
+        for (auto &agent : agents) {
+            agent->tick(1.0f);
+        }
+    }
+
+    // Every task is claimed by exactly one agent
+    std::multiset<consens::TaskID> claimed;
+    for (auto &agent : agents) {
+        CHECK_FALSE(agent->get_bundle().empty());
+        for (const consens::TaskID &task : agent->get_bundle()) {
+            claimed.insert(task);
+        }
+    }
+    CHECK(claimed.size() == tasks.size());
+    CHECK(std::set<consens::TaskID>(claimed.begin(), claimed.end()) == tasks);
+}
+
+TEST_CASE("Consens - Removed Tasks Give Their Handles Back") {
+    std::vector<std::vector<uint8_t>> to_a;
+    std::vector<std::vector<uint8_t>> to_b;
+    auto make_agent = [](const consens::AgentID &id, std::vector<std::vector<uint8_t>> &outbox,
+                         std::vector<std::vector<uint8_t>> &inbox) {
+        consens::Consens::Config config;
+        config.agent_id = id;
+        config.spatial_query_radius = 500.0f;
+        config.enable_logging = false;
+        config.send_message = [&outbox](const std::vector<uint8_t> &data) { outbox.push_back(data); };
+        config.receive_messages = [&inbox]() {
+            std::vector<std::vector<uint8_t>> received;
+            received.swap(inbox);
+            return received;
+        };
+        return std::make_unique<consens::Consens>(config);
+    };
+    auto a = make_agent("churn_a", to_b, to_a);
+    auto b = make_agent("churn_b", to_a, to_b);
+    a->update_pose(0.0, 0.0, 0.0);
+    b->update_pose(50.0, 0.0, 0.0);
+    a->update_velocity(1.0);
+    b->update_velocity(1.0);
+
+    auto run = [&](int ticks) {
+        for (int i = 0; i < ticks; i++) {
+            a->tick(1.0f);
+            b->tick(1.0f);
+        }
+    };
+
+    // Tasks come and go; one agent drops each task a few ticks before the other, while the
+    // other still talks about it
+    size_t table_size = 0;
+    for (int round = 0; round < 200; round++) {
+        for (int t = 0; t < 3; t++) {
+            consens::TaskID id = "churn_" + std::to_string(round) + "_" + std::to_string(t);
+            a->add_task(id, consens::Point(10.0 * t, 5.0), 2.0);
+            b->add_task(id, consens::Point(10.0 * t, 5.0), 2.0);
+        }
+        run(4);
+
+        // Every live task is claimed exactly once: nothing is left over from recycled handles
+        std::vector<consens::TaskID> claimed = a->get_bundle();
+        for (const consens::TaskID &task : b->get_bundle()) {
+            claimed.push_back(task);
+        }
+        std::sort(claimed.begin(), claimed.end());
+        CHECK(claimed.size() == 3);
+        CHECK(std::unique(claimed.begin(), claimed.end()) == claimed.end());
+
+        for (int t = 0; t < 3; t++) {
+            a->remove_task("churn_" + std::to_string(round) + "_" + std::to_string(t));
+        }
+        run(2);
+        for (int t = 0; t < 3; t++) {
+            b->remove_task("churn_" + std::to_string(round) + "_" + std::to_string(t));
+        }
+        CHECK(a->get_bundle().empty());
+        CHECK(b->get_bundle().empty());
+
+        if (round == 0) {
+            table_size = consens::cbba::task_ids().size();
+        }
+    }
+
+    // 600 tasks went through, but the table only ever held one round of them
+    CHECK(consens::cbba::task_ids().size() == table_size);
+}
+
+TEST_CASE("Consens - CBBA Settings Reach The Algorithm") {
+    auto make_agent = [](const consens::AgentID &id, const consens::cbba::CBBAConfig &cbba) {
+        consens::Consens::Config config;
+        config.agent_id = id;
+        config.spatial_query_radius = 500.0f;
+        config.enable_logging = false;
+        config.cbba = cbba;
+        config.send_message = [](const std::vector<uint8_t> &) {};
+        config.receive_messages = []() { return std::vector<std::vector<uint8_t>>(); };
+        auto agent = std::make_unique<consens::Consens>(config);
+        agent->update_pose(0.0, 0.0, 0.0);
+        agent->update_velocity(1.0);
+        for (int t = 0; t < 40; t++) {
+            agent->add_task(id + "_task_" + std::to_string(t), consens::Point(5.0 * t, (t % 4) * 5.0), 1.0);
+        }
+        return agent;
+    };
+
+    SUBCASE("Defaults add one task per tick") {
+        auto agent = make_agent("settings_default", consens::cbba::CBBAConfig());
+        agent->tick(1.0f);
+        CHECK(agent->get_bundle().size() == 1);
+    }
+
+    SUBCASE("Bundle mode and executor") {
+        auto executor = std::make_shared<CountingExecutor>();
+        consens::cbba::CBBAConfig cbba;
+        cbba.bundle_mode = consens::cbba::BundleMode::FULLBUNDLE;
+        cbba.consensus_mode = consens::cbba::ConsensusMode::BATCHED;
+        cbba.executor = executor;
+        auto agent = make_agent("settings_full", cbba);
+        agent->tick(1.0f);
+        CHECK(agent->get_bundle().size() > 1);
+        CHECK(executor->calls > 0);
+    }
+
+    SUBCASE("Travel cost model") {
+        auto model = std::make_shared<CountingCostModel>();
+        consens::cbba::CBBAConfig cbba;
+        cbba.travel_cost_model = model;
+        auto agent = make_agent("settings_travel", cbba);
+        agent->tick(1.0f);
+        CHECK(agent->get_bundle().size() == 1);
+        CHECK(model->calls > 0);
+    }
+
+    SUBCASE("Top-level fields win over the CBBA ones") {
+        consens::cbba::CBBAConfig cbba;
+        cbba.bundle_mode = consens::cbba::BundleMode::FULLBUNDLE;
+        cbba.max_bundle_size = 100;
+        consens::Consens::Config config;
+        config.agent_id = "settings_capped";
+        config.max_bundle_size = 3;
+        config.enable_logging = false;
+        config.cbba = cbba;
+        config.send_message = [](const std::vector<uint8_t> &) {};
+        config.receive_messages = []() { return std::vector<std::vector<uint8_t>>(); };
+        consens::Consens agent(config);
+        agent.update_velocity(1.0);
+        for (int t = 0; t < 10; t++) {
+            agent.add_task("settings_capped_task_" + std::to_string(t), consens::Point(5.0 * t, 0.0), 1.0);
+        }
+        agent.tick(1.0f);
+        CHECK(agent.get_bundle().size() == 3);
+    }
+}
+
+TEST_CASE("Consens - Path Steps Report The Driving Direction") {
+    consens::Consens::Config config;
+    config.agent_id = "steps_robot";
+    config.enable_logging = false;
+    config.send_message = [](const std::vector<uint8_t> &) {};
+    config.receive_messages = []() { return std::vector<std::vector<uint8_t>>(); };
+    consens::Consens agent(config);
+    agent.update_pose(0.0, 0.0, 0.0);
+    agent.update_velocity(1.0);
+
+    CHECK(agent.get_path_steps().empty());
+    CHECK_FALSE(agent.get_next_step().has_value());
+
+    // Row whose tail is next to the agent: driven tail -> head
+    agent.add_task("steps_row", consens::Point(0.0, 50.0), consens::Point(0.0, 2.0), 5.0);
+    agent.tick(1.0f);
+
+    std::vector<consens::TaskStep> steps = agent.get_path_steps();
+    REQUIRE(steps.size() == 1);
+    CHECK(steps[0] == consens::TaskStep{"steps_row", consens::Direction::REVERSE});
+    CHECK(agent.get_next_step() == steps.front());
+    CHECK(agent.get_next_task() == std::optional<consens::TaskID>("steps_row"));
+}
+
+TEST_CASE("Consens - Reset In The Middle Of A Fill Starts Over") {
+    auto make_agent = [](std::chrono::microseconds budget) {
+        consens::cbba::CBBAConfig cbba;
+        cbba.bundle_mode = consens::cbba::BundleMode::FULLBUNDLE;
+        cbba.bundle_build_budget = budget;
+        consens::Consens::Config config;
+        config.agent_id = "reset_robot";
+        config.max_bundle_size = 12;
+        config.spatial_query_radius = 500.0f;
+        config.enable_logging = false;
+        config.cbba = cbba;
+        config.send_message = [](const std::vector<uint8_t> &) {};
+        config.receive_messages = []() { return std::vector<std::vector<uint8_t>>(); };
+        auto agent = std::make_unique<consens::Consens>(config);
+        agent->update_pose(30.0, -20.0, 0.0);
+        agent->update_velocity(1.5);
+        for (int t = 0; t < 100; t++) {
+            agent->add_task("reset_task_" + std::to_string(t), consens::Point(7.0 * (t % 10), 9.0 * (t / 10)), 1.0);
+        }
+        return agent;
+    };
+
+    auto expected = make_agent(std::chrono::microseconds(0));
+    expected->tick(1.0f);
+    REQUIRE(expected->get_bundle().size() == 12);
+
+    // A one microsecond budget leaves the fill paused after the first tick
+    auto agent = make_agent(std::chrono::microseconds(1));
+    agent->tick(1.0f);
+    REQUIRE(agent->get_bundle().size() < 12);
+    agent->reset();
+    CHECK(agent->get_bundle().empty());
+
+    // The fill restarts from the agent's pose and velocity and ends with the same path
+    for (int tick = 0; tick < 10000 && agent->get_bundle().size() < 12; tick++) {
+        agent->tick(1.0f);
+    }
+    CHECK(agent->get_path() == expected->get_path());
+}
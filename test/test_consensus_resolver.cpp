@@ -5,6 +5,10 @@
 #include <consens/cbba/consensus_resolver.hpp>
 #include <consens/cbba/messages.hpp>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 using namespace consens::cbba;
 
 TEST_CASE("ConsensusResolver - Basic Setup") {
@@ -281,3 +285,193 @@ TEST_CASE("ConsensusResolver - Unassigned Task") {
         CHECK(winner_bid.score == doctest::Approx(50.0));
     }
 }
+
+TEST_CASE("ConsensusResolver - Unchanged Entries Are Skipped") {
+    ConsensusResolver resolver;
+    CBBAAgent agent1("robot_1", 5);
+    agent1.add_to_bundle("task_1", 80.0, 0);
+    agent1.update_winning_bid("task_1", Bid("robot_1", 80.0, 1.0));
+
+    CBBAMessage msg("robot_2", 2.0);
+    msg.winning_bids["task_1"] = Bid("robot_2", 50.0, 1.0); // Loses to our bid
+    msg.winners["task_1"] = "robot_2";
+    msg.winning_bids["task_2"] = Bid("robot_2", 60.0, 2.0);
+    msg.winners["task_2"] = "robot_2";
+    msg.winning_bids["task_3"] = Bid("robot_3", 70.0, 2.0);
+    msg.winners["task_3"] = "robot_3";
+    msg.timestamps["robot_2"] = 2.0;
+
+    std::vector<CBBAMessage> messages = {msg};
+    resolver.resolve_conflicts(agent1, messages);
+    CHECK(resolver.resolved() == 3);
+    CHECK(agent1.get_winning_bid("task_2").agent_id == "robot_2");
+
+    SUBCASE("Resending the same state resolves nothing") {
+        resolver.resolve_conflicts(agent1, messages);
+        CHECK(resolver.resolved() == 3);
+        CHECK(agent1.get_winning_bid("task_1").agent_id == "robot_1");
+        CHECK(agent1.get_bundle().contains("task_1"));
+    }
+
+    SUBCASE("A changed neighbor entry is resolved again") {
+        messages[0].winning_bids["task_1"] = Bid("robot_2", 90.0, 1.0);
+        resolver.resolve_conflicts(agent1, messages);
+        CHECK(resolver.resolved() == 4);
+        CHECK(agent1.get_winning_bid("task_1").agent_id == "robot_2");
+        CHECK_FALSE(agent1.get_bundle().contains("task_1"));
+    }
+
+    SUBCASE("A changed local entry is resolved again") {
+        // Forgetting task_2 makes the neighbor's unchanged entry news again
+        agent1.reset_task("task_2");
+        resolver.resolve_conflicts(agent1, messages);
+        CHECK(resolver.resolved() == 4);
+        CHECK(agent1.get_winning_bid("task_2").agent_id == "robot_2");
+    }
+
+    SUBCASE("Forgetting every sender resolves everything again") {
+        resolver.forget_all();
+        resolver.resolve_conflicts(agent1, messages);
+        CHECK(resolver.resolved() == 6);
+    }
+
+    SUBCASE("Entries are remembered per sender") {
+        CBBAMessage relay = msg;
+        relay.sender_id = "robot_3";
+        std::vector<CBBAMessage> relayed = {relay};
+        resolver.resolve_conflicts(agent1, relayed);
+        CHECK(resolver.resolved() == 6);
+    }
+}
+
+TEST_CASE("ConsensusResolver - Messages Without Sender Or Task IDs") {
+    ConsensusMode mode = ConsensusMode::SEQUENTIAL;
+    SUBCASE("Sequential") { mode = ConsensusMode::SEQUENTIAL; }
+    SUBCASE("Batched") { mode = ConsensusMode::BATCHED; }
+
+    ConsensusResolver resolver(mode);
+    CBBAAgent agent1("robot_1", 5);
+    agent1.add_to_bundle("task_1", 50.0, 0);
+
+    // Default-constructed: no sender at all
+    CBBAMessage anonymous;
+    anonymous.winning_bids["task_1"] = Bid("robot_2", 100.0, 2.0);
+    anonymous.winners["task_1"] = "robot_2";
+
+    // Named sender, but one entry has an empty task ID
+    CBBAMessage blank("robot_2", 2.0);
+    blank.winning_bids[""] = Bid("robot_2", 100.0, 2.0);
+    blank.winners[""] = "robot_2";
+    blank.winning_bids["task_2"] = Bid("robot_2", 60.0, 2.0);
+    blank.winners["task_2"] = "robot_2";
+
+    std::vector<CBBAMessage> messages = {anonymous, blank};
+    resolver.resolve_conflicts(agent1, messages);
+
+    // The anonymous message is dropped, the blank entry skipped, the rest resolved
+    CHECK(resolver.resolved() == 1);
+    CHECK(agent1.get_bundle().contains("task_1"));
+    CHECK(agent1.get_winning_bid("task_1").agent_id == "robot_1");
+    CHECK(agent1.get_winning_bid("task_2").agent_id == "robot_2");
+}
+
+TEST_CASE("ConsensusResolver - Batched Mode Applies A Contested Task Once") {
+    // robot_1 holds task_1 and task_2; five neighbors keep outbidding each other on task_1
+    auto make_agent = []() {
+        CBBAAgent agent("robot_1", 5);
+        agent.add_to_bundle("task_1", 50.0, 0);
+        agent.add_to_bundle("task_2", 40.0, 1);
+        agent.update_winning_bid("task_1", Bid("robot_1", 50.0, 1.0));
+        agent.update_winning_bid("task_2", Bid("robot_1", 40.0, 1.0));
+        return agent;
+    };
+
+    std::vector<CBBAMessage> messages;
+    for (int k = 2; k <= 6; k++) {
+        std::string sender = "robot_" + std::to_string(k);
+        CBBAMessage msg(sender, static_cast<double>(k));
+        msg.winning_bids["task_1"] = Bid(sender, 50.0 + 10.0 * k, 1.0);
+        msg.winners["task_1"] = sender;
+        msg.timestamps[sender] = static_cast<double>(k);
+        messages.push_back(msg);
+    }
+
+    CBBAAgent sequential = make_agent();
+    ConsensusResolver one_by_one;
+    one_by_one.resolve_conflicts(sequential, messages);
+
+    CBBAAgent batched = make_agent();
+    ConsensusResolver reducer(ConsensusMode::BATCHED);
+    reducer.resolve_conflicts(batched, messages);
+
+    // Same outcome: robot_6 wins, and the lost task takes the rest of the path with it
+    CHECK(batched.get_winning_bid("task_1") == sequential.get_winning_bid("task_1"));
+    CHECK(batched.get_winning_bid("task_1").agent_id == "robot_6");
+    CHECK(batched.get_bundle().empty());
+    CHECK(batched.get_path().empty());
+    CHECK(batched.get_timestamp("robot_6") == doctest::Approx(6.0));
+
+    // ...but with one write instead of one per neighbor
+    CHECK(one_by_one.updates() == 5);
+    CHECK(reducer.updates() == 1);
+}
+
+TEST_CASE("ConsensusResolver - Batched Mode Matches Sequential Mode") {
+    // Deterministic pseudo-random rounds: agents and neighbors bid on a handful of tasks
+    uint32_t state = 12345;
+    auto next = [&state](uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    };
+
+    std::vector<std::string> tasks;
+    for (int t = 0; t < 6; t++) {
+        tasks.push_back("batch_task_" + std::to_string(t));
+    }
+
+    ConsensusResolver one_by_one;
+    ConsensusResolver reducer(ConsensusMode::BATCHED);
+    CBBAAgent sequential("robot_1", 6);
+    CBBAAgent batched("robot_1", 6);
+
+    for (int round = 0; round < 40; round++) {
+        // Claim whatever is free or stale, in both copies alike
+        for (const auto &task : tasks) {
+            if (next(3) == 0 && !sequential.get_bundle().contains(task)) {
+                Score score = 10.0 * next(6);
+                Timestamp ts = static_cast<double>(next(4));
+                for (CBBAAgent *agent : {&sequential, &batched}) {
+                    agent->add_to_bundle(task, score, SIZE_MAX);
+                    agent->update_winning_bid(task, Bid("robot_1", score, ts));
+                }
+            }
+        }
+
+        // Neighbors echo each other (and us) with coarse scores and timestamps, so ties happen
+        std::vector<CBBAMessage> messages;
+        for (int m = 0; m < 5; m++) {
+            std::string sender = "robot_" + std::to_string(2 + next(4));
+            CBBAMessage msg(sender, static_cast<double>(round));
+            for (const auto &task : tasks) {
+                if (next(2) == 0) {
+                    std::string winner = "robot_" + std::to_string(1 + next(5));
+                    msg.winning_bids[task] = Bid(winner, 10.0 * next(6), static_cast<double>(next(4)));
+                    msg.winners[task] = winner;
+                }
+            }
+            msg.timestamps[sender] = static_cast<double>(round);
+            messages.push_back(msg);
+        }
+
+        one_by_one.resolve_conflicts(sequential, messages);
+        reducer.resolve_conflicts(batched, messages);
+
+        for (const auto &task : tasks) {
+            CHECK(batched.get_winning_bid(task) == sequential.get_winning_bid(task));
+        }
+        CHECK(batched.get_bundle().get_tasks() == sequential.get_bundle().get_tasks());
+        CHECK(batched.get_path().get_tasks() == sequential.get_path().get_tasks());
+        CHECK(batched.get_timestamps() == sequential.get_timestamps());
+    }
+    CHECK(reducer.updates() <= one_by_one.updates());
+}
@@ -0,0 +1,164 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/bundle_builder.hpp>
+#include <consens/cbba/cbba_agent.hpp>
+#include <consens/cbba/executor.hpp>
+#include <consens/cbba/spatial_index.hpp>
+#include <consens/cbba/travel_cost.hpp>
+#include <consens/task.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * Lattice of point tasks and rows around the origin: mirrored tasks tie exactly
+     */
+    std::vector<consens::cbba::TaskIndex> make_lattice(consens::cbba::SpatialIndex &spatial_index,
+                                                       const std::string &prefix) {
+        using namespace consens::cbba;
+
+        std::vector<TaskIndex> available;
+        for (int i = -12; i <= 12; i++) {
+            for (int j = -12; j <= 12; j++) {
+                if (i == 0 && j == 0) {
+                    continue;
+                }
+                std::string id = prefix + std::to_string(i) + "_" + std::to_string(j);
+                double x = i * 8.0;
+                double y = j * 8.0;
+                if ((i + j) % 7 == 0) {
+                    spatial_index.insert(consens::Task(id, consens::Point(x, y), consens::Point(x, y + 6.0), 4.0));
+                } else {
+                    spatial_index.insert(consens::Task(id, consens::Point(x, y), 2.0));
+                }
+                available.push_back(task_ids().find(id));
+            }
+        }
+        return available;
+    }
+
+    /**
+     * Build one bundle and return the agent
+     */
+    consens::cbba::CBBAAgent build(consens::cbba::BundleBuilder &builder,
+                                   const std::vector<consens::cbba::TaskIndex> &available, size_t steps) {
+        using namespace consens::cbba;
+
+        CBBAAgent agent("robot_executor", 25);
+        agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+        agent.update_velocity(1.5);
+        for (size_t step = 0; step < steps; step++) {
+            builder.build_bundle(agent, available);
+        }
+        return agent;
+    }
+
+} // namespace
+
+TEST_CASE("ThreadPool - Runs Every Job Once") {
+    using namespace consens::cbba;
+
+    for (size_t threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        CHECK(pool.concurrency() == threads);
+
+        for (size_t count : {0, 1, 3, 100, 1000}) {
+            std::vector<std::atomic<int>> runs(count);
+            pool.parallel_for(count, [&](size_t i) { runs[i]++; });
+            for (size_t i = 0; i < count; i++) {
+                CHECK(runs[i] == 1);
+            }
+        }
+    }
+
+    ThreadPool hardware;
+    CHECK(hardware.concurrency() >= 1);
+}
+
+TEST_CASE("ThreadPool - Shared By Several Callers") {
+    using namespace consens::cbba;
+
+    ThreadPool pool(3);
+    std::atomic<size_t> total{0};
+
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; c++) {
+        callers.emplace_back([&] {
+            for (int round = 0; round < 50; round++) {
+                pool.parallel_for(20, [&](size_t i) { total += i; });
+            }
+        });
+    }
+    for (auto &caller : callers) {
+        caller.join();
+    }
+
+    CHECK(total == 4 * 50 * (19 * 20 / 2));
+}
+
+TEST_CASE("BundleBuilder - Parallel Scoring Matches Serial") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    std::vector<TaskIndex> available = make_lattice(spatial_index, "exec_");
+
+    // Uneven pool sizes split batches into slices of different lengths
+    for (size_t threads : {2, 3, 8}) {
+        ThreadPool pool(threads);
+
+        for (Metric metric : {Metric::RPT, Metric::TDR}) {
+            for (BundleMode mode : {BundleMode::ADD, BundleMode::FULLBUNDLE}) {
+                size_t steps = mode == BundleMode::ADD ? 25 : 1;
+
+                BundleBuilder serial(&spatial_index, metric, 150.0f, mode);
+                BundleBuilder parallel(&spatial_index, metric, 150.0f, mode);
+                parallel.set_executor(&pool);
+                CHECK(parallel.get_executor() == &pool);
+
+                CBBAAgent expected = build(serial, available, steps);
+                CBBAAgent actual = build(parallel, available, steps);
+
+                REQUIRE(expected.get_bundle().size() == 25);
+                CHECK(actual.get_path().indices() == expected.get_path().indices());
+                for (size_t i = 0; i < expected.get_path().size(); i++) {
+                    TaskIndex task = expected.get_path().index_at(i);
+                    CHECK(actual.get_local_bid(task) == expected.get_local_bid(task));
+                    CHECK(actual.get_path().direction_at(i) == expected.get_path().direction_at(i));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("BundleBuilder - Executor Survives Settings Changes") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    std::vector<TaskIndex> available = make_lattice(spatial_index, "exec_settings_");
+    ThreadPool pool(4);
+
+    BundleBuilder builder(&spatial_index, Metric::RPT, 150.0f, BundleMode::FULLBUNDLE);
+    builder.set_executor(&pool);
+    builder.set_metric(Metric::TDR);
+    CHECK(builder.get_executor() == &pool);
+
+    // A travel cost model keeps scoring serial; results still match a builder without executor
+    auto model = std::make_shared<EuclideanCostModel>();
+    builder.set_travel_cost_model(model);
+    BundleBuilder serial(&spatial_index, Metric::TDR, 150.0f, BundleMode::FULLBUNDLE);
+    serial.set_travel_cost_model(model);
+
+    CBBAAgent expected = build(serial, available, 1);
+    CBBAAgent actual = build(builder, available, 1);
+    CHECK(actual.get_path().indices() == expected.get_path().indices());
+    CHECK(builder.get_travel_costs()->misses() > 0);
+
+    builder.set_executor(nullptr);
+    CHECK(builder.get_executor() == nullptr);
+}
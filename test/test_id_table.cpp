@@ -0,0 +1,248 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/bid.hpp>
+#include <consens/cbba/cbba_agent.hpp>
+#include <consens/cbba/id_table.hpp>
+#include <consens/cbba/index_map.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace consens::cbba;
+
+TEST_CASE("IdTable - Interning") {
+    IdTable table;
+
+    SUBCASE("Handles are dense and stable") {
+        uint32_t a = table.intern("task_a");
+        uint32_t b = table.intern("task_b");
+        uint32_t c = table.intern("task_c");
+
+        CHECK(a == 0);
+        CHECK(b == 1);
+        CHECK(c == 2);
+        CHECK(table.size() == 3);
+
+        // Interning again returns the same handle
+        CHECK(table.intern("task_b") == b);
+        CHECK(table.size() == 3);
+    }
+
+    SUBCASE("Find does not intern") {
+        CHECK(table.find("missing") == INVALID_INDEX);
+        CHECK(table.size() == 0);
+
+        uint32_t a = table.intern("task_a");
+        CHECK(table.find("task_a") == a);
+    }
+
+    SUBCASE("Name lookup") {
+        uint32_t a = table.intern("task_a");
+        CHECK(table.name(a) == "task_a");
+        CHECK(table.name(INVALID_INDEX).empty());
+    }
+
+    SUBCASE("Empty ID maps to invalid handle") {
+        CHECK(table.intern("") == INVALID_INDEX);
+        CHECK(table.size() == 0);
+    }
+}
+
+TEST_CASE("IdTable - Acquired Handles Are Recycled") {
+    IdTable table;
+
+    SUBCASE("Last release frees the handle for the next new ID") {
+        uint32_t a = table.acquire("task_a");
+        CHECK(table.acquire("task_a") == a);
+
+        table.release(a);
+        CHECK(table.find("task_a") == a);
+
+        table.release(a);
+        CHECK(table.find("task_a") == INVALID_INDEX);
+        CHECK(table.name(a).empty());
+
+        uint32_t b = table.acquire("task_b");
+        CHECK(b == a);
+        CHECK(table.name(b) == "task_b");
+        CHECK(table.size() == 1);
+    }
+
+    SUBCASE("Interned handles are never recycled") {
+        uint32_t a = table.intern("task_a");
+        CHECK(table.acquire("task_a") == a);
+        table.release(a);
+        CHECK(table.find("task_a") == a);
+
+        uint32_t b = table.acquire("task_b");
+        CHECK(table.intern("task_b") == b);
+        table.release(b);
+        CHECK(table.find("task_b") == b);
+        CHECK(table.acquire("task_c") == 2);
+    }
+
+    SUBCASE("Unbalanced releases are ignored") {
+        uint32_t a = table.intern("task_a");
+        table.release(a);
+        table.release(INVALID_INDEX);
+        table.release(17);
+        CHECK(table.find("task_a") == a);
+        CHECK(table.acquire("") == INVALID_INDEX);
+    }
+}
+
+TEST_CASE("CBBAAgent - Only Tasks Added By ID Hold Their Handle") {
+    CBBAAgent agent("robot_held", 5);
+
+    SUBCASE("Unknown IDs are not interned") {
+        agent.reset_task("held_unknown");
+        agent.update_winning_bid("held_unknown", Bid("robot_held", 1.0, 1.0));
+        agent.set_local_bid("held_unknown", 1.0);
+        agent.insert_in_path("held_unknown", 0);
+        agent.update_timestamp("robot_held_unknown", 1.0);
+
+        CHECK(task_ids().find("held_unknown") == INVALID_INDEX);
+        CHECK(agent_ids().find("robot_held_unknown") == INVALID_INDEX);
+        CHECK(agent.get_path().empty());
+        CHECK(agent.get_state_size() == 0);
+    }
+
+    SUBCASE("Reset releases the handle, once every copy did") {
+        agent.add_to_bundle("held_task", 5.0);
+        agent.add_to_bundle("held_task", 5.0); // Already held
+        uint32_t task = task_ids().find("held_task");
+        REQUIRE(task != INVALID_INDEX);
+
+        {
+            CBBAAgent copy = agent;
+            agent.reset_task("held_task");
+            CHECK(task_ids().find("held_task") == task);
+            CHECK(copy.get_bundle().contains(task));
+        }
+        CHECK(task_ids().find("held_task") == INVALID_INDEX);
+    }
+
+    SUBCASE("Removal from the bundle keeps the handle until reset") {
+        agent.add_to_bundle("held_removed", 5.0);
+        uint32_t task = task_ids().find("held_removed");
+        REQUIRE(task != INVALID_INDEX);
+
+        agent.remove_from_bundle("held_removed");
+        CHECK_FALSE(agent.get_bundle().contains(task));
+        CHECK(task_ids().find("held_removed") == task);
+
+        agent.reset_task("held_removed");
+        CHECK(task_ids().find("held_removed") == INVALID_INDEX);
+    }
+}
+
+TEST_CASE("AgentHandle - Conversions") {
+    AgentHandle none;
+    AgentHandle robot("robot_1");
+
+    CHECK_FALSE(none.is_valid());
+    CHECK(none.name() == NO_AGENT);
+    CHECK(AgentHandle(NO_AGENT) == none);
+
+    CHECK(robot.is_valid());
+    CHECK(robot == "robot_1");
+    CHECK(robot == std::string("robot_1"));
+    CHECK(robot == AgentHandle("robot_1"));
+    CHECK(robot != AgentHandle("robot_2"));
+}
+
+TEST_CASE("Bid - Tie Breaking Uses Agent Names") {
+    // Intern in reverse order so handle order disagrees with name order
+    AgentHandle late("robot_tie_b");
+    AgentHandle early("robot_tie_a");
+
+    Bid bid_a(early, 10.0, 1.0);
+    Bid bid_b(late, 10.0, 1.0);
+
+    CHECK(bid_a > bid_b);
+    CHECK_FALSE(bid_b > bid_a);
+}
+
+TEST_CASE("IdTable - Order Matches String Order") {
+    IdTable table;
+    std::vector<std::string> ids = {"robot_101", "robot_100", "robot_10", "robot_1", "r",
+                                    "robot_1\xff", "robot_2", "Robot_3", "robot_100_b"};
+    std::vector<uint32_t> handles;
+    for (const std::string &id : ids) {
+        handles.push_back(table.intern(id));
+    }
+
+    // Includes IDs that only differ after their first 8 bytes, and one that is a prefix of another
+    for (size_t i = 0; i < ids.size(); i++) {
+        for (size_t j = 0; j < ids.size(); j++) {
+            CHECK(table.less(handles[i], handles[j]) == (ids[i] < ids[j]));
+        }
+        CHECK(table.less(INVALID_INDEX, handles[i]));
+        CHECK_FALSE(table.less(handles[i], INVALID_INDEX));
+    }
+    CHECK_FALSE(table.less(INVALID_INDEX, INVALID_INDEX));
+
+    // Handles past the first chunk resolve like the first ones
+    for (int i = 0; i < 1000; i++) {
+        table.intern("bulk_" + std::to_string(i));
+    }
+    CHECK(table.name(table.find("bulk_999")) == "bulk_999");
+    CHECK(table.less(table.find("bulk_10"), table.find("bulk_9")));
+}
+
+TEST_CASE("Bid - Tie Breaking Past The Precomputed Prefix") {
+    AgentHandle late("robot_tie_long_b");
+    AgentHandle early("robot_tie_long_a");
+
+    CHECK(Bid(early, 10.0, 1.0) > Bid(late, 10.0, 1.0));
+    CHECK_FALSE(Bid(late, 10.0, 1.0) > Bid(early, 10.0, 1.0));
+    CHECK(Bid(late, 11.0, 1.0) > Bid(early, 10.0, 1.0));
+}
+
+TEST_CASE("IndexMap - Sorted Flat Storage") {
+    TaskScores scores;
+
+    scores[5] = 50.0;
+    scores[1] = 10.0;
+    scores[3] = 30.0;
+
+    SUBCASE("Iteration is ordered by handle") {
+        std::vector<uint32_t> keys;
+        for (const auto &[index, score] : scores) {
+            keys.push_back(index);
+        }
+        CHECK(keys == std::vector<uint32_t>{1, 3, 5});
+    }
+
+    SUBCASE("Find and erase") {
+        REQUIRE(scores.find(3) != nullptr);
+        CHECK(*scores.find(3) == doctest::Approx(30.0));
+        CHECK(scores.find(4) == nullptr);
+
+        scores.erase(3);
+        CHECK(scores.size() == 2);
+        CHECK_FALSE(scores.contains(3));
+    }
+
+    SUBCASE("Assign sorts and deduplicates") {
+        scores.assign({{7, 1.0}, {2, 2.0}, {7, 3.0}});
+        CHECK(scores.size() == 2);
+        CHECK(scores.begin()->first == 2);
+        CHECK(*scores.find(7) == doctest::Approx(3.0));
+    }
+
+    SUBCASE("Insert at a sorted position") {
+        auto it = scores.insert(scores.begin() + 1, 2, 20.0);
+        CHECK(it->first == 2);
+        CHECK(scores.size() == 4);
+        CHECK(*scores.find(2) == doctest::Approx(20.0));
+        CHECK(*scores.find(3) == doctest::Approx(30.0));
+    }
+
+    SUBCASE("String keys go through the task table") {
+        scores["index_map_task"] = 42.0;
+        REQUIRE(scores.find(std::string("index_map_task")) != nullptr);
+        CHECK(*scores.find(task_ids().find("index_map_task")) == doctest::Approx(42.0));
+    }
+}
@@ -0,0 +1,112 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/cbba_agent.hpp>
+#include <consens/cbba/insertion_kernel.hpp>
+#include <consens/cbba/scorer.hpp>
+#include <consens/cbba/spatial_index.hpp>
+#include <consens/task.hpp>
+
+#include <cmath>
+#include <string>
+
+using namespace consens::cbba;
+
+namespace {
+
+    /**
+     * Deterministic mix of point tasks and rows
+     */
+    consens::Task make_task(const std::string &prefix, int i) {
+        double x = std::fmod(i * 37.0, 200.0) - 100.0;
+        double y = std::fmod(i * 53.0, 200.0) - 100.0;
+        std::string id = prefix + std::to_string(i);
+        if (i % 3 == 0) {
+            return consens::Task(id, consens::Point(x, y), consens::Point(x + 5.0, y + 30.0), 8.0);
+        }
+        return consens::Task(id, consens::Point(x, y), 1.0 + i % 4);
+    }
+
+} // namespace
+
+TEST_CASE("InsertionKernel - SIMD Levels Match Scalar") {
+    std::vector<InsertionEdge> edges;
+    for (int j = 0; j < 6; j++) {
+        consens::Point prev(j * 11.0 - 20.0, j * 7.0);
+        consens::Point next(j * 13.0, 40.0 - j * 9.0);
+        edges.push_back(InsertionEdge{prev, next, 1.0, prev.distance_to(next) / 1.5});
+    }
+    edges.push_back(InsertionEdge{consens::Point(3.0, 4.0), consens::Point(3.0, 4.0), 0.0, 0.0});
+
+    // 19 candidates: exercises full vectors and the tail for both widths
+    InsertionBatch batch;
+    for (int i = 0; i < 19; i++) {
+        batch.add(static_cast<TaskIndex>(i), make_task("kernel_", i));
+    }
+
+    compute_insertion_costs(edges, 1.5, batch, SimdLevel::SCALAR);
+    std::vector<double> reach = batch.reach;
+    std::vector<double> delay = batch.delay;
+    REQUIRE(reach.size() == edges.size() * batch.size());
+
+    // Spot-check one cell against the definition
+    const consens::Point entry(batch.entry_x[2], batch.entry_y[2]);
+    const consens::Point exit(batch.exit_x[2], batch.exit_y[2]);
+    double expected_reach = edges[1].prev.distance_to(entry) / 1.5 + batch.duration[2];
+    CHECK(reach[1 * batch.size() + 2] == doctest::Approx(expected_reach));
+    CHECK(delay[1 * batch.size() + 2] ==
+          doctest::Approx(expected_reach + exit.distance_to(edges[1].next) / 1.5 - edges[1].bypass_time));
+    CHECK(delay[6 * batch.size() + 2] == doctest::Approx(reach[6 * batch.size() + 2])); // Append slot
+
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (!simd_supported(level)) {
+            continue;
+        }
+        compute_insertion_costs(edges, 1.5, batch, level);
+        for (size_t i = 0; i < reach.size(); i++) {
+            CHECK(batch.reach[i] == reach[i]); // Bit-identical across instruction sets
+            CHECK(batch.delay[i] == delay[i]);
+        }
+    }
+}
+
+TEST_CASE("InsertionKernel - Batch Scoring Matches Per-Task Scoring") {
+    SpatialIndex spatial_index;
+    for (int i = 0; i < 40; i++) {
+        spatial_index.insert(make_task("batch_", i));
+    }
+
+    CBBAAgent agent("robot_batch", 10);
+    agent.update_pose(consens::Pose(5.0, -3.0, 0.0));
+    agent.update_velocity(1.5);
+    for (int i = 0; i < 6; i++) {
+        agent.insert_in_path("batch_" + std::to_string(i * 5), static_cast<size_t>(i));
+    }
+    agent.insert_in_path("batch_unknown", 2); // Not in the index, skipped by the profile
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        TaskScorer scorer(metric);
+        PathProfile profile;
+        scorer.compute_path_profile(agent, agent.get_path(), spatial_index, profile);
+
+        InsertionBatch batch;
+        for (int i = 0; i < 40; i++) {
+            TaskIndex task = task_ids().find("batch_" + std::to_string(i));
+            if (!agent.get_path().contains(task)) {
+                batch.add(task, *spatial_index.find_task(task));
+            }
+        }
+
+        std::vector<Insertion> results;
+        scorer.find_optimal_insertions(profile, batch, results);
+        REQUIRE(results.size() == batch.size());
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            auto expected =
+                scorer.find_optimal_insertion(agent, batch.tasks[i], agent.get_path(), profile, spatial_index);
+            CHECK(results[i].score == doctest::Approx(expected.score));
+            CHECK(results[i].position == expected.position);
+            CHECK(results[i].direction == expected.direction);
+        }
+    }
+}
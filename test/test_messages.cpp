@@ -3,6 +3,10 @@
 
 #include <consens/cbba/messages.hpp>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 using namespace consens::cbba;
 
 TEST_CASE("CBBAMessage - Empty Message Serialization") {
@@ -312,3 +316,137 @@ TEST_CASE("CBBAMessage - Large Message") {
     CHECK(msg2.get_winning_bid("task_10").score == doctest::Approx(100.0));
     CHECK(msg2.get_timestamp("robot_5") == doctest::Approx(25.0));
 }
+
+TEST_CASE("CBBAMessage - Unknown Tasks Are Dropped, Unknown Agents Are Kept") {
+    // Hand-built wire data naming tasks and agents this process has never seen
+    std::vector<uint8_t> data;
+    auto put_u32 = [&data](uint32_t value) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(value));
+    };
+    auto put_double = [&data](double value) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(value));
+    };
+    auto put_string = [&](const std::string &str) {
+        put_u32(static_cast<uint32_t>(str.size()));
+        data.insert(data.end(), str.begin(), str.end());
+    };
+
+    task_ids().intern("wire_known_task");
+    task_ids().intern("wire_other_task");
+    agent_ids().intern("wire_known_agent");
+    size_t task_count = task_ids().size();
+
+    put_string("wire_stranger");
+    put_double(1.0);
+    put_u32(2); // Bundle
+    put_string("wire_known_task");
+    put_string("wire_unknown_task");
+    put_u32(1); // Path
+    put_string("wire_unknown_task");
+    put_u32(3); // Winning bids
+    put_string("wire_known_task");
+    put_string("wire_known_agent");
+    put_double(10.0);
+    put_double(1.0);
+    put_string("wire_unknown_task");
+    put_string("wire_known_agent");
+    put_double(20.0);
+    put_double(1.0);
+    put_string("wire_other_task");
+    put_string("wire_unknown_agent");
+    put_double(30.0);
+    put_double(1.0);
+    put_u32(3); // Winners
+    put_string("wire_known_task");
+    put_string("wire_known_agent");
+    put_string("wire_other_task");
+    put_string("wire_unknown_agent");
+    put_string("wire_unknown_task");
+    put_string("wire_unknown_agent");
+    put_u32(2); // Timestamps
+    put_string("wire_known_agent");
+    put_double(1.0);
+    put_string("wire_unknown_agent");
+    put_double(2.0);
+
+    CBBAMessage msg;
+    REQUIRE(msg.deserialize(data));
+
+    // Entries naming unknown tasks are dropped, and no task was added to the table
+    CHECK(msg.sender_id == "wire_stranger");
+    CHECK(msg.bundle.get_tasks() == std::vector<TaskID>{"wire_known_task"});
+    CHECK(msg.path.empty());
+    CHECK(msg.winning_bids.size() == 2);
+    CHECK(msg.get_winning_bid("wire_known_task").score == doctest::Approx(10.0));
+    CHECK(msg.winners.size() == 2);
+    CHECK(task_ids().size() == task_count);
+    CHECK(task_ids().find("wire_unknown_task") == INVALID_INDEX);
+
+    // Agents this process never met (e.g. multi-hop winners) are kept
+    CHECK(msg.get_winning_bid("wire_other_task").agent_id == "wire_unknown_agent");
+    CHECK(msg.get_winner("wire_other_task") == "wire_unknown_agent");
+    CHECK(msg.timestamps.size() == 2);
+    CHECK(msg.get_timestamp("wire_unknown_agent") == doctest::Approx(2.0));
+}
+
+TEST_CASE("CBBAMessage - Oversized Counts Are Rejected") {
+    std::vector<uint8_t> data;
+    auto put_u32 = [&data](uint32_t value) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(value));
+    };
+    auto put_double = [&data](double value) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(value));
+    };
+    auto put_string = [&](const std::string &str) {
+        put_u32(static_cast<uint32_t>(str.size()));
+        data.insert(data.end(), str.begin(), str.end());
+    };
+
+    put_string("r");
+    put_double(1.0);
+
+    CBBAMessage msg;
+
+    SUBCASE("Bundle count larger than the payload") {
+        put_u32(0xFFFFFFFF);
+        CHECK_FALSE(msg.deserialize(data));
+    }
+
+    SUBCASE("Bid count larger than the payload") {
+        put_u32(0); // Bundle
+        put_u32(0); // Path
+        put_u32(0xFFFFFFFF);
+        CHECK_FALSE(msg.deserialize(data));
+    }
+
+    SUBCASE("Winner count larger than the payload") {
+        put_u32(0); // Bundle
+        put_u32(0); // Path
+        put_u32(0); // Bids
+        put_u32(0xFFFFFFFF);
+        CHECK_FALSE(msg.deserialize(data));
+    }
+
+    SUBCASE("Timestamp count larger than the payload") {
+        put_u32(0); // Bundle
+        put_u32(0); // Path
+        put_u32(0); // Bids
+        put_u32(0); // Winners
+        put_u32(0xFFFFFFFF);
+        CHECK_FALSE(msg.deserialize(data));
+    }
+
+    SUBCASE("Count that fits but entries that are truncated") {
+        put_u32(0); // Bundle
+        put_u32(0); // Path
+        put_u32(1); // Bids
+        put_string("task");
+        put_string("agent");
+        put_double(10.0);
+        CHECK_FALSE(msg.deserialize(data));
+    }
+}
@@ -0,0 +1,182 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/bundle_builder.hpp>
+#include <consens/cbba/cbba_agent.hpp>
+#include <consens/cbba/path_improver.hpp>
+#include <consens/cbba/scorer.hpp>
+#include <consens/cbba/spatial_index.hpp>
+#include <consens/task.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using namespace std::chrono_literals;
+
+    /**
+     * Agent at the origin with its path given in order (bids 1, 2, ...)
+     */
+    consens::cbba::CBBAAgent make_agent(const std::vector<std::string> &path,
+                                        consens::Direction direction = consens::Direction::FORWARD) {
+        consens::cbba::CBBAAgent agent("robot_improver", 20);
+        agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+        agent.update_velocity(2.0);
+        for (size_t i = 0; i < path.size(); i++) {
+            agent.add_to_bundle(path[i], static_cast<double>(i + 1), SIZE_MAX, direction);
+        }
+        return agent;
+    }
+
+} // namespace
+
+TEST_CASE("TaskScorer - Splice Evaluation Matches Full Path") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    spatial_index.insert(consens::Task("splice_a", consens::Point(10.0, 0.0), 3.0));
+    spatial_index.insert(consens::Task("splice_b", consens::Point(10.0, 20.0), consens::Point(30.0, 20.0), 5.0));
+    spatial_index.insert(consens::Task("splice_c", consens::Point(40.0, 5.0), 2.0));
+    spatial_index.insert(consens::Task("splice_d", consens::Point(-5.0, 25.0), consens::Point(-5.0, 45.0), 4.0));
+    spatial_index.insert(consens::Task("splice_e", consens::Point(20.0, -10.0), 1.0));
+
+    CBBAAgent agent = make_agent({"splice_a", "splice_b", "splice_c", "splice_d", "splice_e"});
+    const Path &path = agent.get_path();
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        TaskScorer scorer(metric);
+        PathProfile profile;
+        scorer.compute_path_profile(agent, path, spatial_index, profile);
+        CHECK(profile.score.back() == doctest::Approx(scorer.evaluate_path(agent, path, spatial_index)));
+
+        // Replace [first, last) by the run reversed, and check against the reordered path
+        for (size_t first = 0; first < path.size(); first++) {
+            for (size_t last = first + 1; last <= path.size(); last++) {
+                std::vector<PathStep> steps;
+                for (size_t i = last; i-- > first;) {
+                    steps.push_back(PathStep{path.index_at(i), consens::opposite(path.direction_at(i))});
+                }
+                Path reversed = path;
+                reversed.reverse(first, last);
+
+                CHECK(scorer.evaluate_splice(profile, first, last, steps, spatial_index) ==
+                      doctest::Approx(scorer.evaluate_path(agent, reversed, spatial_index)));
+            }
+        }
+
+        // Fewer steps than replaced tasks scores a removal
+        Path removed = path;
+        removed.remove(path.index_at(2));
+        std::vector<PathStep> none;
+        CHECK(scorer.evaluate_splice(profile, 2, 3, none, spatial_index) ==
+              doctest::Approx(scorer.evaluate_path(agent, removed, spatial_index)));
+    }
+}
+
+TEST_CASE("PathImprover - Untangles A Path") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    for (int i = 1; i <= 6; i++) {
+        spatial_index.insert(consens::Task("line_" + std::to_string(i), consens::Point(10.0 * i, 0.0), 1.0));
+    }
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        CBBAAgent agent = make_agent({"line_4", "line_1", "line_6", "line_2", "line_5", "line_3"});
+        std::vector<TaskIndex> bundle = agent.get_bundle().indices();
+        std::vector<Score> bids = agent.get_local_bids();
+
+        BundleBuilder builder(&spatial_index, metric);
+        builder.set_path_improvement_budget(1s);
+        TaskScorer scorer(metric);
+        Score before = scorer.evaluate_path(agent, agent.get_path(), spatial_index);
+
+        // Nothing is available, so the build only reorders the path
+        builder.build_bundle(agent, std::vector<TaskIndex>{});
+
+        CHECK(agent.get_path().get_tasks() ==
+              std::vector<TaskID>{"line_1", "line_2", "line_3", "line_4", "line_5", "line_6"});
+        CHECK(scorer.evaluate_path(agent, agent.get_path(), spatial_index) > before);
+        CHECK(builder.get_path_improver().moves() > 0);
+
+        // Reordering only: bundle order and every bid stay as published
+        CHECK(agent.get_bundle().indices() == bundle);
+        CHECK(agent.get_local_bids() == bids);
+
+        // A settled path is not searched again (and keeps its version)
+        uint64_t version = agent.get_path().version();
+        size_t moves = builder.get_path_improver().moves();
+        builder.build_bundle(agent, std::vector<TaskIndex>{});
+        CHECK(agent.get_path().version() == version);
+        CHECK(builder.get_path_improver().moves() == moves);
+    }
+}
+
+TEST_CASE("PathImprover - Flips And Moves Rows") {
+    using namespace consens::cbba;
+
+    // Two rows up the y axis, both entered from the far end
+    SpatialIndex spatial_index;
+    spatial_index.insert(consens::Task("row_1", consens::Point(0.0, 10.0), consens::Point(0.0, 30.0), 5.0));
+    spatial_index.insert(consens::Task("row_2", consens::Point(0.0, 40.0), consens::Point(0.0, 60.0), 5.0));
+    CBBAAgent agent = make_agent({"row_2", "row_1"}, consens::Direction::REVERSE);
+
+    PathImprover improver(1s);
+    BasicTaskScorer<RptPolicy> scorer;
+    CHECK(improver.improve(agent, scorer, spatial_index) > 0);
+
+    CHECK(agent.get_path().get_tasks() == std::vector<TaskID>{"row_1", "row_2"});
+    CHECK(agent.get_path().get_direction("row_1") == consens::Direction::FORWARD);
+    CHECK(agent.get_path().get_direction("row_2") == consens::Direction::FORWARD);
+    CHECK(scorer.evaluate_path(agent, agent.get_path(), spatial_index) == doctest::Approx(-20.0));
+}
+
+TEST_CASE("PathImprover - Disabled And Budgeted") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    std::vector<TaskIndex> available;
+    for (int i = 0; i < 60; i++) {
+        std::string id = "field_" + std::to_string(i);
+        double x = std::fmod(i * 97.31, 180.0) - 90.0;
+        double y = std::fmod(i * i * 13.77, 180.0) - 90.0;
+        spatial_index.insert(consens::Task(id, consens::Point(x, y), 1.0));
+        available.push_back(task_ids().find(id));
+    }
+
+    // Disabled by default: the greedy path is kept
+    BundleBuilder greedy(&spatial_index, Metric::RPT, 500.0f, BundleMode::FULLBUNDLE);
+    CHECK_FALSE(greedy.get_path_improver().enabled());
+    CBBAAgent expected("robot_field", 40);
+    greedy.build_bundle(expected, available);
+    CHECK(greedy.get_path_improver().moves() == 0);
+
+    // Improving keeps the bundle and its bids, and never makes the path worse
+    BundleBuilder improving(&spatial_index, Metric::RPT, 500.0f, BundleMode::FULLBUNDLE);
+    improving.set_path_improvement_budget(1s);
+    improving.set_metric(Metric::TDR);
+    improving.set_metric(Metric::RPT);
+    CHECK(improving.get_path_improver().get_budget() == std::chrono::microseconds(1s));
+    CBBAAgent actual("robot_field", 40);
+    improving.build_bundle(actual, available);
+
+    TaskScorer scorer(Metric::RPT);
+    CHECK(actual.get_bundle().indices() == expected.get_bundle().indices());
+    CHECK(actual.get_local_bids() == expected.get_local_bids());
+    CHECK(scorer.evaluate_path(actual, actual.get_path(), spatial_index) >
+          scorer.evaluate_path(expected, expected.get_path(), spatial_index));
+
+    // A tiny budget stops early and retries on the next build
+    CBBAAgent rushed("robot_field", 40);
+    PathImprover improver(1us);
+    BasicTaskScorer<RptPolicy> rpt;
+    greedy.build_bundle(rushed, available);
+    Score greedy_score = rpt.evaluate_path(rushed, rushed.get_path(), spatial_index);
+    for (int run = 0; run < 3; run++) {
+        improver.improve(rushed, rpt, spatial_index);
+    }
+    CHECK(rpt.evaluate_path(rushed, rushed.get_path(), spatial_index) >= greedy_score);
+}
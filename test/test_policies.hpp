@@ -0,0 +1,18 @@
+#pragma once
+
+#include <consens/cbba/scoring_policy.hpp>
+
+namespace consens::cbba::test {
+
+    /**
+     * Fuel burned while driving: every second of travel costs burn_rate, working is free
+     */
+    struct FuelPolicy {
+        double burn_rate = 0.5;
+
+        Score add_task(Score score, double, double travel, double) const { return score - burn_rate * travel; }
+
+        Score slot_gain(const InsertionCost &cost) const { return -burn_rate * (cost.delay - cost.duration); }
+    };
+
+} // namespace consens::cbba::test
@@ -6,6 +6,13 @@
 #include <consens/cbba/spatial_index.hpp>
 #include <consens/task.hpp>
 
+#include "test_policies.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using consens::cbba::test::FuelPolicy;
+
 TEST_CASE("TaskScorer - Basic Setup") {
     consens::cbba::TaskScorer scorer(consens::cbba::Metric::RPT);
 
@@ -165,11 +172,13 @@ TEST_CASE("TaskScorer - Find Optimal Insertion") {
         auto task_opt = spatial_index.get_task("task_mid");
         REQUIRE(task_opt.has_value());
 
-        auto [best_score, best_pos] = scorer.find_optimal_insertion(agent, *task_opt, path, spatial_index);
+        auto [best_score, best_pos, best_direction] =
+            scorer.find_optimal_insertion(agent, *task_opt, path, spatial_index);
 
         // Best position should be in the middle (position 1)
         CHECK(best_pos == 1);
         CHECK(best_score > consens::cbba::MIN_SCORE);
+        CHECK(best_direction == consens::Direction::FORWARD); // Point task
     }
 }
 
@@ -193,10 +202,30 @@ TEST_CASE("TaskScorer - Geometric Tasks") {
     SUBCASE("Evaluate geometric task") {
         auto score = scorer.evaluate_path(agent, path, spatial_index);
 
-        // Travel to center: sqrt(10^2 + 10^2) ≈ 14.14m, time ≈ 7.07s
+        // Travel to head: 10m, time 5s
         // Task time: 10s
-        // Total: ~17.07s, RPT = ~-17.07s
-        CHECK(score == doctest::Approx(-17.07).epsilon(0.01));
+        // Total: 15s, RPT = -15s
+        CHECK(score == doctest::Approx(-15.0));
+    }
+
+    SUBCASE("Evaluate reversed row") {
+        consens::cbba::Path reversed;
+        reversed.insert("row_1", 0, consens::Direction::REVERSE);
+
+        // Travel to tail: sqrt(10^2 + 20^2) ≈ 22.36m, time ≈ 11.18s, plus 10s of work
+        CHECK(scorer.evaluate_path(agent, reversed, spatial_index) == doctest::Approx(-21.18).epsilon(0.01));
+    }
+
+    SUBCASE("Row is entered from the nearer end") {
+        consens::cbba::Path empty;
+        agent.update_pose(consens::Pose(0.0, 25.0, 0.0));
+
+        // Tail is sqrt(10^2 + 5^2) ≈ 11.18m away, head ≈ 26.93m
+        auto best = scorer.find_optimal_insertion(agent, row, empty, spatial_index);
+        CHECK(best.direction == consens::Direction::REVERSE);
+        CHECK(best.score == doctest::Approx(-15.59).epsilon(0.01));
+        CHECK(scorer.compute_marginal_gain(agent, row, empty, 0, spatial_index, consens::Direction::FORWARD) <
+              best.score);
     }
 }
 
@@ -238,3 +267,183 @@ TEST_CASE("TaskScorer - TDR Metric") {
         CHECK(score1 > score2);
     }
 }
+
+TEST_CASE("TaskScorer - Incremental Insertion Matches Path Evaluation") {
+    using namespace consens::cbba;
+
+    CBBAAgent agent("robot_1", 10);
+    SpatialIndex spatial_index;
+
+    agent.update_pose(consens::Pose(3.0, -4.0, 0.0));
+    agent.update_velocity(1.5);
+
+    // Path mixing point tasks, rows and a handle the index does not know about
+    spatial_index.insert(consens::Task("inc_a", consens::Point(10.0, 0.0), 4.0));
+    spatial_index.insert(consens::Task("inc_b", consens::Point(20.0, 5.0), consens::Point(20.0, 25.0), 12.0));
+    spatial_index.insert(consens::Task("inc_c", consens::Point(-5.0, 30.0), 2.0));
+
+    Path path;
+    path.insert("inc_a", 0);
+    path.insert("inc_missing", 1);
+    path.insert("inc_b", 2);
+    path.insert("inc_c", 3);
+
+    spatial_index.insert(consens::Task("inc_near", consens::Point(15.0, 2.0), 3.0));
+    spatial_index.insert(consens::Task("inc_row", consens::Point(-5.0, 28.0), consens::Point(10.0, 28.0), 6.0));
+    spatial_index.insert(consens::Task("inc_far", consens::Point(80.0, -60.0), 1.0));
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        TaskScorer scorer(metric, 0.97);
+        Score current = scorer.evaluate_path(agent, path, spatial_index);
+
+        PathProfile profile;
+        scorer.compute_path_profile(agent, path, spatial_index, profile);
+        CHECK(profile.slots() == 4);
+
+        for (const char *id : {"inc_near", "inc_row", "inc_far"}) {
+            TaskIndex task = task_ids().find(id);
+
+            // Reference: copy the path, insert, evaluate the whole thing (both ways round)
+            Score best_reference = MIN_SCORE;
+            for (Direction direction : {Direction::FORWARD, Direction::REVERSE}) {
+                for (size_t pos = 0; pos <= path.size(); pos++) {
+                    Path inserted = path;
+                    inserted.insert(task, pos, direction);
+                    Score reference = scorer.evaluate_path(agent, inserted, spatial_index) - current;
+                    best_reference = std::max(best_reference, reference);
+
+                    CHECK(scorer.compute_marginal_gain(agent, task, path, pos, spatial_index, direction) ==
+                          doctest::Approx(reference));
+                }
+            }
+
+            auto [best_score, best_pos, best_direction] =
+                scorer.find_optimal_insertion(agent, task, path, spatial_index);
+            CHECK(best_score == doctest::Approx(best_reference));
+            CHECK(scorer.compute_marginal_gain(agent, task, path, best_pos, spatial_index, best_direction) ==
+                  doctest::Approx(best_reference));
+
+            auto [profile_score, profile_pos, profile_direction] =
+                scorer.find_optimal_insertion(agent, task, path, profile, spatial_index);
+            CHECK(profile_score == doctest::Approx(best_score));
+            CHECK(profile_pos == best_pos);
+            CHECK(profile_direction == best_direction);
+        }
+
+        // Unknown task gains nothing
+        Insertion unknown = scorer.find_optimal_insertion(agent, task_ids().intern("inc_unknown"), path, spatial_index);
+        CHECK(unknown.score == 0.0);
+        CHECK(unknown.position == 0);
+    }
+}
+
+TEST_CASE("TaskScorer - Kept Profile Follows Its Inputs") {
+    using namespace consens::cbba;
+
+    BasicTaskScorer<TdrPolicy> scorer(TdrPolicy{0.95});
+    CBBAAgent agent("robot_1", 10);
+    SpatialIndex spatial_index;
+    agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+    agent.update_velocity(2.0);
+
+    spatial_index.insert(consens::Task("kept_a", consens::Point(10.0, 0.0), 4.0));
+    spatial_index.insert(consens::Task("kept_b", consens::Point(30.0, 10.0), 2.0));
+    spatial_index.insert(consens::Task("kept_new", consens::Point(20.0, 5.0), 3.0));
+    TaskIndex task = task_ids().find("kept_new");
+
+    Path path;
+    path.insert("kept_a", 0);
+    path.insert("kept_b", 1);
+
+    // Each call must agree with a profile built from scratch
+    auto check_matches_fresh = [&]() {
+        PathProfile fresh;
+        scorer.compute_path_profile(agent, path, spatial_index, fresh);
+        Insertion expected = scorer.find_optimal_insertion(agent, task, path, fresh, spatial_index);
+        Insertion kept = scorer.find_optimal_insertion(agent, task, path, spatial_index);
+        CHECK(kept.score == doctest::Approx(expected.score));
+        CHECK(kept.position == expected.position);
+        CHECK(scorer.compute_marginal_gain(agent, task, path, expected.position, spatial_index) ==
+              doctest::Approx(expected.score));
+    };
+
+    check_matches_fresh();
+    check_matches_fresh();
+
+    SUBCASE("Path change") {
+        path.remove("kept_a");
+        check_matches_fresh();
+    }
+
+    SUBCASE("Agent motion") {
+        agent.update_pose(consens::Pose(25.0, 5.0, 0.0));
+        check_matches_fresh();
+        agent.update_velocity(0.5);
+        check_matches_fresh();
+    }
+
+    SUBCASE("Path task moved in the index") {
+        spatial_index.insert(consens::Task("kept_b", consens::Point(-30.0, 10.0), 2.0));
+        check_matches_fresh();
+    }
+}
+
+TEST_CASE("TaskScorer - Custom Policy") {
+    using namespace consens::cbba;
+
+    static_assert(ScoringPolicy<FuelPolicy> && LocalScoringPolicy<FuelPolicy>);
+    static_assert(LocalScoringPolicy<RptPolicy> && !LocalScoringPolicy<TdrPolicy>);
+
+    CBBAAgent agent("robot_1", 10);
+    SpatialIndex spatial_index;
+    agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+    agent.update_velocity(2.0);
+
+    spatial_index.insert(consens::Task("fuel_a", consens::Point(10.0, 0.0), 5.0));
+    spatial_index.insert(consens::Task("fuel_b", consens::Point(10.0, 20.0), 15.0));
+    spatial_index.insert(consens::Task("fuel_c", consens::Point(12.0, 8.0), 40.0));
+
+    Path path;
+    path.insert("fuel_a", 0);
+    path.insert("fuel_b", 1);
+
+    BasicTaskScorer<FuelPolicy> scorer(FuelPolicy{2.0});
+
+    // Only travel burns fuel: 10 m + 20 m at 2 m/s, at 2 units per second
+    Score current = scorer.evaluate_path(agent, path, spatial_index);
+    CHECK(current == doctest::Approx(-30.0));
+
+    // Long task between a and b costs its detour only
+    TaskIndex task = task_ids().find("fuel_c");
+    Score best_reference = MIN_SCORE;
+    for (size_t pos = 0; pos <= path.size(); pos++) {
+        Path inserted = path;
+        inserted.insert(task, pos);
+        Score reference = scorer.evaluate_path(agent, inserted, spatial_index) - current;
+        best_reference = std::max(best_reference, reference);
+        CHECK(scorer.compute_marginal_gain(agent, task, path, pos, spatial_index) == doctest::Approx(reference));
+    }
+
+    Insertion best = scorer.find_optimal_insertion(agent, task, path, spatial_index);
+    CHECK(best.score == doctest::Approx(best_reference));
+    CHECK(best.position == 1);
+
+    PathProfile profile;
+    scorer.compute_path_profile(agent, path, spatial_index, profile);
+    Insertion profile_best = scorer.find_optimal_insertion(agent, task, path, profile, spatial_index);
+    CHECK(profile_best.score == doctest::Approx(best.score));
+    CHECK(profile_best.position == best.position);
+
+    // No gain_bound: nothing can be pruned
+    PathBounds bounds = scorer.compute_path_bounds(agent, path, spatial_index);
+    CHECK(std::isinf(scorer.marginal_gain_bound(agent, bounds, 1000.0)));
+
+    // Built-in policies score exactly like the Metric wrapper
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        TaskScorer wrapped(metric, 0.9);
+        Score expected = metric == Metric::RPT
+                             ? BasicTaskScorer<RptPolicy>().evaluate_path(agent, path, spatial_index)
+                             : BasicTaskScorer<TdrPolicy>(TdrPolicy{0.9}).evaluate_path(agent, path, spatial_index);
+        CHECK(wrapped.evaluate_path(agent, path, spatial_index) == expected);
+    }
+}
@@ -4,6 +4,8 @@
 #include <consens/cbba/spatial_index.hpp>
 #include <consens/task.hpp>
 
+#include <algorithm>
+
 TEST_CASE("SpatialIndex - Basic Operations") {
     consens::cbba::SpatialIndex index;
 
@@ -261,3 +263,161 @@ TEST_CASE("SpatialIndex - Get All") {
         }
     }
 }
+
+TEST_CASE("SpatialIndex - Shared Task Store") {
+    consens::cbba::TaskStore store;
+    consens::cbba::SpatialIndex index(store);
+
+    consens::cbba::TaskIndex near = store.insert(consens::Task("store_near", consens::Point(1.0, 0.0), 1.0));
+    consens::cbba::TaskIndex far = store.insert(consens::Task("store_far", consens::Point(50.0, 0.0), 1.0));
+
+    SUBCASE("Only explicitly indexed tasks are visible") {
+        index.insert(near);
+
+        CHECK(index.size() == 1);
+        CHECK(index.has_task(near));
+        CHECK_FALSE(index.has_task(far));
+        CHECK(index.query_radius(consens::Point(0.0, 0.0), 100.0) == std::vector<consens::TaskID>{"store_near"});
+    }
+
+    SUBCASE("Non-owning access points into the store") {
+        index.insert(near);
+
+        const consens::Task *task = index.find_task(near);
+        REQUIRE(task != nullptr);
+        CHECK(task == store.get(near));
+        CHECK(index.find_task("store_near") == task);
+        CHECK(index.find_task(far) == nullptr);
+    }
+
+    SUBCASE("Removing from index keeps task data") {
+        index.insert(near);
+        index.remove(near);
+
+        CHECK(index.empty());
+        CHECK(store.contains(near));
+    }
+
+    SUBCASE("Inserting a task object updates the store in place") {
+        index.insert(consens::Task("store_far", consens::Point(2.0, 0.0), 1.0));
+
+        CHECK(store.size() == 2);
+        CHECK(store.get(far)->get_position().x == 2.0);
+        CHECK(index.query_nearest(consens::Point(0.0, 0.0), 1) == std::vector<consens::TaskID>{"store_far"});
+    }
+}
+
+TEST_CASE("SpatialIndex - Batch Insert") {
+    consens::cbba::SpatialIndex index;
+
+    std::vector<consens::Task> tasks;
+    for (int i = 0; i < 100; i++) {
+        tasks.emplace_back("batch_" + std::to_string(i), consens::Point(i * 20.0, 0.0), 1.0);
+    }
+
+    index.insert(tasks);
+
+    CHECK(index.size() == 100);
+    CHECK(index.has_task("batch_42"));
+    CHECK(index.query_nearest(consens::Point(842.0, 0.0), 1) == std::vector<consens::TaskID>{"batch_42"});
+    CHECK(index.query_radius(consens::Point(0.0, 0.0), 190.0).size() == 10);
+
+    SUBCASE("Small batch after bulk load") {
+        std::vector<consens::Task> extra = {consens::Task("batch_extra", consens::Point(5000.0, 0.0), 1.0),
+                                            consens::Task("batch_0", consens::Point(-100.0, 0.0), 1.0)};
+        index.insert(extra);
+
+        CHECK(index.size() == 101);
+        CHECK(index.query_nearest(consens::Point(4990.0, 0.0), 1) == std::vector<consens::TaskID>{"batch_extra"});
+        CHECK(index.query_radius(consens::Point(0.0, 0.0), 0.5).empty());
+        CHECK(index.query_nearest(consens::Point(-90.0, 0.0), 1) == std::vector<consens::TaskID>{"batch_0"});
+    }
+
+    SUBCASE("Removal after bulk load") {
+        index.remove("batch_42");
+        CHECK(index.size() == 99);
+        CHECK(index.query_nearest(consens::Point(840.0, 0.0), 1) != std::vector<consens::TaskID>{"batch_42"});
+    }
+}
+
+TEST_CASE("SpatialIndex - Backends Agree") {
+    using consens::cbba::SpatialIndexType;
+
+    // The default node size runs on compile-time R-tree parameters, any other on run-time ones
+    for (size_t node_size : {size_t{8}, size_t{16}}) {
+        for (SpatialIndexType type :
+             {SpatialIndexType::QUADRATIC, SpatialIndexType::LINEAR, SpatialIndexType::RSTAR, SpatialIndexType::GRID}) {
+            consens::cbba::SpatialIndexConfig config;
+            config.type = type;
+            config.node_size = node_size;
+            config.grid_cell_size = 7.0;
+            consens::cbba::SpatialIndex index(config);
+
+            // Point tasks on a 20 m lattice plus long rows spanning several grid cells
+            for (int x = 0; x < 10; x++) {
+                for (int y = 0; y < 10; y++) {
+                    std::string id = "backend_" + std::to_string(x) + "_" + std::to_string(y);
+                    index.insert(consens::Task(id, consens::Point(x * 20.0, y * 20.0), 1.0));
+                }
+            }
+            index.insert(consens::Task("backend_row", consens::Point(-30.0, 0.0), consens::Point(-30.0, 150.0), 1.0));
+            CHECK(index.size() == 101);
+
+            auto near = index.query_radius(consens::Point(40.0, 40.0), 25.0);
+            std::sort(near.begin(), near.end());
+            CHECK(near == std::vector<consens::TaskID>{"backend_1_2", "backend_2_1", "backend_2_2", "backend_2_3",
+                                                       "backend_3_2"});
+
+            auto nearest = index.query_nearest(consens::Point(61.0, 79.0), 1);
+            CHECK(nearest == std::vector<consens::TaskID>{"backend_3_4"});
+
+            // Row box spans many cells but must be reported once
+            auto row_hits = index.query_box(consens::BoundingBox(-40.0, -10.0, -20.0, 160.0));
+            CHECK(row_hits == std::vector<consens::TaskID>{"backend_row"});
+            CHECK(index.query_nearest(consens::Point(-100.0, 70.0), 1) == std::vector<consens::TaskID>{"backend_row"});
+
+            index.remove("backend_row");
+            CHECK(index.query_box(consens::BoundingBox(-40.0, -10.0, -20.0, 160.0)).empty());
+            CHECK(index.size() == 100);
+
+            // Far from the data, and after removing the lattice's top row so its bounds shrink
+            CHECK(index.query_nearest(consens::Point(5000.0, -3000.0), 1) ==
+                  std::vector<consens::TaskID>{"backend_9_0"});
+            for (int x = 0; x < 10; x++) {
+                index.remove("backend_" + std::to_string(x) + "_9");
+            }
+            auto top = index.query_nearest(consens::Point(95.0, 400.0), 2);
+            std::sort(top.begin(), top.end());
+            CHECK(top == std::vector<consens::TaskID>{"backend_4_8", "backend_5_8"});
+        }
+    }
+}
+
+TEST_CASE("SpatialIndex - Segment-Aware Radius Query") {
+    consens::cbba::SpatialIndex index;
+
+    // Long row whose head is near the origin but whose centre is 100 m away
+    index.insert(consens::Task("seg_row", consens::Point(0.0, 5.0), consens::Point(0.0, 205.0), 10.0));
+    index.insert(consens::Task("seg_point", consens::Point(8.0, 0.0), 1.0));
+
+    std::vector<consens::cbba::TaskDistance> found;
+    index.query_radius(consens::Point(0.0, 0.0), 10.0, found);
+    std::sort(found.begin(), found.end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+
+    REQUIRE(found.size() == 2);
+    CHECK(found[0].first == consens::cbba::task_ids().find("seg_row"));
+    CHECK(found[0].second == doctest::Approx(5.0));
+    CHECK(found[1].first == consens::cbba::task_ids().find("seg_point"));
+    CHECK(found[1].second == doctest::Approx(8.0));
+
+    SUBCASE("Distance to the side of a row") {
+        index.query_radius(consens::Point(3.0, 100.0), 4.0, found);
+        REQUIRE(found.size() == 1);
+        CHECK(found[0].second == doctest::Approx(3.0));
+    }
+
+    SUBCASE("Buffer is cleared between queries") {
+        index.query_radius(consens::Point(500.0, 500.0), 10.0, found);
+        CHECK(found.empty());
+    }
+}
@@ -0,0 +1,366 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <consens/cbba/bundle_builder.hpp>
+#include <consens/cbba/cbba_agent.hpp>
+#include <consens/cbba/scorer.hpp>
+#include <consens/cbba/spatial_index.hpp>
+#include <consens/cbba/travel_cost.hpp>
+#include <consens/task.hpp>
+
+#include <cmath>
+#include <memory>
+
+namespace {
+
+    constexpr consens::Direction FWD = consens::Direction::FORWARD;
+
+    /**
+     * Straight-line distance that counts how often it is asked
+     */
+    class CountingModel : public consens::cbba::TravelCostModel {
+      public:
+        mutable size_t calls = 0;
+
+        double distance(const consens::Point &from, const consens::Point &to) const override {
+            calls++;
+            return from.distance_to(to);
+        }
+    };
+
+    /**
+     * City-block distance (never shorter than the straight line)
+     */
+    class ManhattanModel : public consens::cbba::TravelCostModel {
+      public:
+        double distance(const consens::Point &from, const consens::Point &to) const override {
+            return std::abs(to.x - from.x) + std::abs(to.y - from.y);
+        }
+    };
+
+    /**
+     * Straight line, ten times as long for legs that cross the river at y = 50
+     * Tasks that span the river (a bridge) are work, so going through them can beat the direct leg
+     */
+    class RiverModel : public consens::cbba::TravelCostModel {
+      public:
+        double distance(const consens::Point &from, const consens::Point &to) const override {
+            bool crosses = (from.y - 50.0) * (to.y - 50.0) < 0.0;
+            return from.distance_to(to) * (crosses ? 10.0 : 1.0);
+        }
+    };
+
+    /**
+     * Compare a scorer using the cache against the plain straight-line scorer
+     */
+    template <typename Policy>
+    void check_matches_plain(Policy policy, const consens::cbba::CBBAAgent &agent, const consens::cbba::Path &path,
+                             const consens::cbba::SpatialIndex &spatial_index,
+                             const std::vector<consens::cbba::TaskIndex> &candidates) {
+        using namespace consens::cbba;
+
+        BasicTaskScorer<Policy> plain(policy);
+        BasicTaskScorer<Policy> cached(policy);
+        TravelCostCache cache(std::make_shared<EuclideanCostModel>(), spatial_index);
+        cached.set_travel_costs(&cache);
+
+        // Run twice: once filling the cache, once from it
+        for (int pass = 0; pass < 2; pass++) {
+            CHECK(cached.evaluate_path(agent, path, spatial_index) == plain.evaluate_path(agent, path, spatial_index));
+
+            PathProfile plain_profile;
+            PathProfile cached_profile;
+            plain.compute_path_profile(agent, path, spatial_index, plain_profile);
+            cached.compute_path_profile(agent, path, spatial_index, cached_profile);
+
+            InsertionBatch batch;
+            for (TaskIndex task : candidates) {
+                batch.add(task, *spatial_index.find_task(task));
+
+                Insertion plain_best = plain.find_optimal_insertion(agent, task, path, spatial_index);
+                Insertion cached_best = cached.find_optimal_insertion(agent, task, path, spatial_index);
+                CHECK(cached_best.score == doctest::Approx(plain_best.score));
+                CHECK(cached_best.position == plain_best.position);
+                CHECK(cached_best.direction == plain_best.direction);
+            }
+
+            std::vector<Insertion> plain_out;
+            std::vector<Insertion> cached_out;
+            plain.find_optimal_insertions(plain_profile, batch, plain_out);
+            cached.find_optimal_insertions(cached_profile, batch, cached_out);
+            REQUIRE(cached_out.size() == plain_out.size());
+            for (size_t i = 0; i < plain_out.size(); i++) {
+                CHECK(cached_out[i].score == doctest::Approx(plain_out[i].score));
+                CHECK(cached_out[i].position == plain_out[i].position);
+                CHECK(cached_out[i].direction == plain_out[i].direction);
+            }
+        }
+
+        CHECK(cache.hits() > 0);
+    }
+
+} // namespace
+
+TEST_CASE("TravelCostCache - Hits And LRU Eviction") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    spatial_index.insert(consens::Task("tc_a", consens::Point(0.0, 0.0), 1.0));
+    spatial_index.insert(consens::Task("tc_b", consens::Point(3.0, 4.0), 1.0));
+    spatial_index.insert(consens::Task("tc_c", consens::Point(6.0, 8.0), 1.0));
+    TaskIndex a = task_ids().find("tc_a");
+    TaskIndex b = task_ids().find("tc_b");
+    TaskIndex c = task_ids().find("tc_c");
+    consens::Point pa(0.0, 0.0), pb(3.0, 4.0), pc(6.0, 8.0);
+
+    auto model = std::make_shared<CountingModel>();
+    TravelCostCache cache(model, spatial_index, 2);
+    CHECK(cache.capacity() == 2);
+
+    CHECK(cache.distance(a, FWD, pa, b, FWD, pb) == doctest::Approx(5.0));
+    CHECK(cache.distance(a, FWD, pa, b, FWD, pb) == doctest::Approx(5.0));
+    CHECK(model->calls == 1);
+    CHECK(cache.hits() == 1);
+    CHECK(cache.misses() == 1);
+
+    // Legs are directed
+    CHECK(cache.distance(b, FWD, pb, a, FWD, pa) == doctest::Approx(5.0));
+    CHECK(model->calls == 2);
+
+    // Third leg evicts the least recently used one (a -> b)
+    CHECK(cache.distance(b, FWD, pb, c, FWD, pc) == doctest::Approx(5.0));
+    CHECK(cache.size() == 2);
+    CHECK(model->calls == 3);
+
+    cache.distance(b, FWD, pb, a, FWD, pa);
+    CHECK(model->calls == 3);
+    cache.distance(a, FWD, pa, b, FWD, pb);
+    CHECK(model->calls == 4);
+
+    // Legs to the other end of a task are separate entries
+    CHECK(cache.distance(a, FWD, pa, b, consens::Direction::REVERSE, pc) == doctest::Approx(10.0));
+    CHECK(model->calls == 5);
+    cache.distance(a, FWD, pa, b, FWD, pb);
+    CHECK(model->calls == 5);
+
+    SUBCASE("Legs from the agent are kept while it stands still") {
+        consens::Point origin(3.0, 0.0);
+        CHECK(cache.distance(NO_TASK, FWD, origin, b, FWD, pb) == doctest::Approx(4.0));
+        CHECK(cache.distance(NO_TASK, FWD, origin, b, FWD, pb) == doctest::Approx(4.0));
+        CHECK(model->calls == 6);
+
+        CHECK(cache.distance(NO_TASK, FWD, consens::Point(0.0, 4.0), b, FWD, pb) == doctest::Approx(3.0));
+        CHECK(model->calls == 7);
+        CHECK(cache.size() == 2); // Not part of the LRU table
+    }
+
+    SUBCASE("Handles too large for the leg key bypass the table") {
+        TaskIndex high = a + (TaskIndex{1} << 31);
+        CHECK(cache.distance(high, FWD, pc, b, FWD, pb) == doctest::Approx(5.0));
+        CHECK(cache.distance(b, FWD, pb, high, FWD, pa) == doctest::Approx(5.0));
+        CHECK(model->calls == 7);
+        CHECK(cache.size() == 2);
+
+        // Still cached under its own key, not aliased by the large handle
+        cache.distance(a, FWD, pa, b, FWD, pb);
+        CHECK(model->calls == 7);
+    }
+
+    SUBCASE("Clear drops everything") {
+        cache.clear();
+        CHECK(cache.size() == 0);
+        cache.distance(a, FWD, pa, b, FWD, pb);
+        CHECK(model->calls == 6);
+    }
+}
+
+TEST_CASE("TravelCostCache - Reindexing Invalidates Only Touching Legs") {
+    using namespace consens::cbba;
+
+    SpatialIndex spatial_index;
+    spatial_index.insert(consens::Task("tci_a", consens::Point(0.0, 0.0), 1.0));
+    spatial_index.insert(consens::Task("tci_b", consens::Point(10.0, 0.0), 1.0));
+    spatial_index.insert(consens::Task("tci_c", consens::Point(20.0, 0.0), 1.0));
+    TaskIndex a = task_ids().find("tci_a");
+    TaskIndex b = task_ids().find("tci_b");
+    TaskIndex c = task_ids().find("tci_c");
+    consens::Point pa(0.0, 0.0), pc(20.0, 0.0), origin(-5.0, 0.0);
+
+    auto model = std::make_shared<CountingModel>();
+    TravelCostCache cache(model, spatial_index);
+
+    cache.distance(NO_TASK, FWD, origin, a, FWD, pa);
+    cache.distance(a, FWD, pa, b, FWD, consens::Point(10.0, 0.0));
+    cache.distance(b, FWD, consens::Point(10.0, 0.0), c, FWD, pc);
+    cache.distance(a, FWD, pa, c, FWD, pc);
+    CHECK(model->calls == 4);
+
+    // Move task b
+    consens::Point moved(10.0, 30.0);
+    spatial_index.remove(b);
+    spatial_index.insert(consens::Task("tci_b", moved, 1.0));
+
+    CHECK(cache.distance(NO_TASK, FWD, origin, a, FWD, pa) == doctest::Approx(5.0));
+    CHECK(cache.distance(a, FWD, pa, c, FWD, pc) == doctest::Approx(20.0));
+    CHECK(model->calls == 4);
+
+    CHECK(cache.distance(a, FWD, pa, b, FWD, moved) == doctest::Approx(std::hypot(10.0, 30.0)));
+    CHECK(cache.distance(b, FWD, moved, c, FWD, pc) == doctest::Approx(std::hypot(10.0, 30.0)));
+    CHECK(model->calls == 6);
+}
+
+TEST_CASE("TravelCostCache - Straight Line Model Matches Plain Scorer") {
+    using namespace consens::cbba;
+
+    CBBAAgent agent("robot_tc", 10);
+    SpatialIndex spatial_index;
+    agent.update_pose(consens::Pose(3.0, -4.0, 0.0));
+    agent.update_velocity(1.5);
+
+    spatial_index.insert(consens::Task("tcs_a", consens::Point(10.0, 0.0), 4.0));
+    spatial_index.insert(consens::Task("tcs_b", consens::Point(20.0, 5.0), consens::Point(20.0, 25.0), 12.0));
+    spatial_index.insert(consens::Task("tcs_c", consens::Point(-5.0, 30.0), 2.0));
+    spatial_index.insert(consens::Task("tcs_near", consens::Point(15.0, 2.0), 3.0));
+    spatial_index.insert(consens::Task("tcs_row", consens::Point(-5.0, 28.0), consens::Point(10.0, 28.0), 6.0));
+    spatial_index.insert(consens::Task("tcs_far", consens::Point(80.0, -60.0), 1.0));
+
+    Path path;
+    path.insert("tcs_a", 0);
+    path.insert("tcs_missing", 1);
+    path.insert("tcs_b", 2);
+    path.insert("tcs_c", 3);
+
+    std::vector<TaskIndex> candidates = {task_ids().find("tcs_near"), task_ids().find("tcs_row"),
+                                         task_ids().find("tcs_far")};
+
+    check_matches_plain(RptPolicy{}, agent, path, spatial_index, candidates);
+    check_matches_plain(TdrPolicy{0.97}, agent, path, spatial_index, candidates);
+}
+
+TEST_CASE("TravelCostCache - Custom Model Through The Bundle Builder") {
+    using namespace consens::cbba;
+
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        std::string prefix = "tcm_" + std::to_string(static_cast<int>(metric)) + "_";
+
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 60; i++) {
+            double x = std::fmod(i * 37.0, 200.0) - 100.0;
+            double y = std::fmod(i * 53.0, 200.0) - 100.0;
+            std::string id = prefix + std::to_string(i);
+            if (i % 4 == 0) {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), consens::Point(x + 20.0, y), 5.0));
+            } else {
+                spatial_index.insert(consens::Task(id, consens::Point(x, y), 2.0));
+            }
+            available.push_back(task_ids().find(id));
+        }
+
+        CBBAAgent full("robot_tcm_full", 10);
+        CBBAAgent incremental("robot_tcm_add", 10);
+        for (CBBAAgent *agent : {&full, &incremental}) {
+            agent->update_pose(consens::Pose(5.0, -3.0, 0.0));
+            agent->update_velocity(1.0);
+        }
+
+        auto model = std::make_shared<ManhattanModel>();
+        BundleBuilder lazy(&spatial_index, metric, 120.0f, BundleMode::FULLBUNDLE);
+        lazy.set_travel_cost_model(model);
+        lazy.build_bundle(full, available);
+
+        // Switching the metric keeps the model
+        BundleBuilder greedy(&spatial_index, metric == Metric::RPT ? Metric::TDR : Metric::RPT, 120.0f,
+                             BundleMode::ADD);
+        greedy.set_travel_cost_model(model, 64);
+        greedy.set_metric(metric);
+        REQUIRE(greedy.get_travel_costs() != nullptr);
+        CHECK(greedy.get_travel_costs()->capacity() == 64);
+        for (size_t step = 0; step < 10; step++) {
+            greedy.build_bundle(incremental, available);
+        }
+
+        CHECK(full.get_bundle().size() == 10);
+        CHECK(full.get_path().indices() == incremental.get_path().indices());
+        for (TaskIndex task : full.get_path().indices()) {
+            CHECK(full.get_local_bid(task) == doctest::Approx(incremental.get_local_bid(task)));
+        }
+        CHECK(lazy.get_travel_costs()->hits() > 0);
+
+        // Bids are priced with the model: the path score matches a Manhattan evaluation
+        TravelCostCache cache(model, spatial_index);
+        Score score = 0.0;
+        if (metric == Metric::RPT) {
+            BasicTaskScorer<RptPolicy> scorer;
+            scorer.set_travel_costs(&cache);
+            score = scorer.evaluate_path(full, full.get_path(), spatial_index);
+        } else {
+            BasicTaskScorer<TdrPolicy> scorer;
+            scorer.set_travel_costs(&cache);
+            score = scorer.evaluate_path(full, full.get_path(), spatial_index);
+        }
+        Score bids = 0.0;
+        for (TaskIndex task : full.get_path().indices()) {
+            bids += full.get_local_bid(task);
+        }
+        CHECK(bids == doctest::Approx(score));
+
+        // Dropping the model goes back to straight lines
+        lazy.set_travel_cost_model(nullptr);
+        CHECK(lazy.get_travel_costs() == nullptr);
+    }
+}
+
+TEST_CASE("TravelCostCache - Early Exit Keeps Tasks That Bypass A Costly Leg") {
+    using namespace consens::cbba;
+
+    // The direct leg to the goal crosses the river; a row from one bank to the other turns that
+    // leg into two short ones, a detour far below minus the row's length
+    for (Metric metric : {Metric::RPT, Metric::TDR}) {
+        SpatialIndex spatial_index;
+        std::string prefix = "river_" + std::to_string(static_cast<int>(metric)) + "_";
+        spatial_index.insert(consens::Task(prefix + "goal", consens::Point(0.0, 100.0), 0.0));
+
+        std::vector<TaskIndex> available;
+        for (int i = 0; i < 40; i++) {
+            std::string id = prefix + std::to_string(i);
+            spatial_index.insert(consens::Task(id, consens::Point(0.1 * (i % 8), -0.1 * (i / 8)), 0.0));
+            available.push_back(task_ids().find(id));
+        }
+        std::string row = prefix + "row";
+        spatial_index.insert(consens::Task(row, consens::Point(0.0, 40.0), consens::Point(0.0, 60.0), 30.0));
+        available.push_back(task_ids().find(row));
+
+        CBBAAgent agent("robot_river", 5);
+        agent.update_pose(consens::Pose(0.0, 0.0, 0.0));
+        agent.update_velocity(2.0);
+        agent.add_to_bundle(prefix + "goal", 1.0, SIZE_MAX);
+
+        // Reference: score every available task with the model
+        auto model = std::make_shared<RiverModel>();
+        TravelCostCache cache(model, spatial_index);
+        auto exhaustive = [&](auto scorer) {
+            scorer.set_travel_costs(&cache);
+            TaskIndex best = NO_TASK;
+            Score best_score = MIN_SCORE;
+            for (TaskIndex task : available) {
+                Score score = scorer.find_optimal_insertion(agent, task, agent.get_path(), spatial_index).score;
+                if (score > best_score || (score == best_score && task < best)) {
+                    best_score = score;
+                    best = task;
+                }
+            }
+            return best;
+        };
+        TaskIndex expected = metric == Metric::RPT ? exhaustive(BasicTaskScorer<RptPolicy>())
+                                                   : exhaustive(BasicTaskScorer<TdrPolicy>());
+        if (metric == Metric::RPT) {
+            CHECK(expected == task_ids().find(row));
+        }
+
+        BundleBuilder builder(&spatial_index, metric, 500.0f, BundleMode::ADD);
+        builder.set_travel_cost_model(model);
+        builder.build_bundle(agent, available);
+        CHECK(agent.get_bundle().contains(expected));
+    }
+}